@@ -0,0 +1,1311 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file analysis.hpp
+ *
+ * This header contains compile-time analysis of rules. The results are
+ * used by searching and prefilters to skip parts of input that cannot
+ * be matched.
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <cstddef>
+#include <type_traits>
+
+// Library
+#include "rules.hpp"
+#include "automaton.hpp"
+
+/* ************************************************************************ */
+
+namespace template_regex {
+namespace rules {
+
+/* ************************************************************************ */
+
+/**
+ * @brief Common prefix of two `int_seq`.
+ *
+ * @tparam Seq1 The first sequence.
+ * @tparam Seq2 The second sequence.
+ */
+template<typename Seq1, typename Seq2>
+struct int_seq_common
+{
+    using type = int_seq<>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Common prefix of two `int_seq` with same first value.
+ */
+template<int I, int... I1, int... I2>
+struct int_seq_common<int_seq<I, I1...>, int_seq<I, I2...>>
+{
+    using type = typename int_seq_concat<
+        int_seq<I>,
+        typename int_seq_common<int_seq<I1...>, int_seq<I2...>>::type
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Literal that must be at the beginning of each match.
+ *
+ * `type` is an `int_seq` with literal values. `complete` is true when the
+ * rule matches only the literal so following rules can extend it.
+ *
+ * @tparam Rule Analyzed rule.
+ */
+template<typename Rule>
+struct literal_prefix
+{
+    /// Literal values.
+    using type = int_seq<>;
+
+    /// If rule is the literal.
+    static constexpr bool complete = false;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `val`.
+ */
+template<int Value>
+struct literal_prefix<val<Value>>
+{
+    using type = int_seq<Value>;
+    static constexpr bool complete = true;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence`.
+ */
+template<typename Rule, typename... Rules>
+struct literal_prefix<sequence<Rule, Rules...>>
+{
+    using _first = literal_prefix<Rule>;
+    using _rest = literal_prefix<sequence<Rules...>>;
+
+    using type = typename std::conditional<_first::complete,
+        int_seq_concat<typename _first::type, typename _rest::type>,
+        std::conditional<true, typename _first::type, void>
+    >::type::type;
+
+    static constexpr bool complete = _first::complete && _rest::complete;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` with single rule.
+ */
+template<typename Rule>
+struct literal_prefix<sequence<Rule>> : literal_prefix<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative` - common prefix of branches.
+ */
+template<typename Rule, typename... Rules>
+struct literal_prefix<alternative<Rule, Rules...>>
+{
+    using type = typename int_seq_common<
+        typename literal_prefix<Rule>::type,
+        typename literal_prefix<alternative<Rules...>>::type
+    >::type;
+
+    static constexpr bool complete = false;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative` with single rule.
+ */
+template<typename Rule>
+struct literal_prefix<alternative<Rule>> : literal_prefix<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat` - at least one occurrence.
+ */
+template<typename Rule>
+struct literal_prefix<repeat<Rule>>
+{
+    using type = typename literal_prefix<Rule>::type;
+    static constexpr bool complete = false;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n` - nothing without required occurrence.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct literal_prefix<repeat_n<Rule, Min, Max>>
+{
+    using type = typename std::conditional<(Min > 0),
+        typename literal_prefix<Rule>::type,
+        int_seq<>
+    >::type;
+
+    static constexpr bool complete = false;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `capture`.
+ */
+template<typename Rule>
+struct literal_prefix<capture<Rule>> : literal_prefix<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule>
+struct literal_prefix<group<Index, Rule>> : literal_prefix<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store`.
+ */
+template<typename Rule, typename Value>
+struct literal_prefix<store<Rule, Value>> : literal_prefix<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin`.
+ */
+template<typename Rule>
+struct literal_prefix<begin<Rule>> : literal_prefix<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `end`.
+ */
+template<typename Rule>
+struct literal_prefix<end<Rule>> : literal_prefix<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin_end`.
+ */
+template<typename Rule>
+struct literal_prefix<begin_end<Rule>> : literal_prefix<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `automaton`.
+ */
+template<typename Rule, bool Full, typename Backend>
+struct literal_prefix<automaton<Rule, Full, Backend>> : literal_prefix<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Set of literals.
+ *
+ * @tparam Literals A list of `int_seq`.
+ */
+template<typename... Literals>
+struct literal_set
+{
+    /// A number of literals.
+    static constexpr std::size_t size = sizeof...(Literals);
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Maximum number of literals created by `literal_set_product`.
+ */
+constexpr std::size_t literal_set_limit = 16;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Merge multiple `literal_set`.
+ *
+ * @tparam Sets Merged sets.
+ */
+template<typename... Sets>
+struct literal_set_merge;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Merge of no sets.
+ */
+template<>
+struct literal_set_merge<>
+{
+    using type = literal_set<>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Merge of single set.
+ */
+template<typename... Literals>
+struct literal_set_merge<literal_set<Literals...>>
+{
+    using type = literal_set<Literals...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Merge of multiple sets.
+ */
+template<typename... Literals1, typename... Literals2, typename... Sets>
+struct literal_set_merge<literal_set<Literals1...>, literal_set<Literals2...>, Sets...>
+    : literal_set_merge<literal_set<Literals1..., Literals2...>, Sets...>
+{
+    // Nothing
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Append each literal from set to literal.
+ *
+ * @tparam Literal The first part.
+ * @tparam Set     Set of the second parts.
+ */
+template<typename Literal, typename Set>
+struct literal_set_append;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Append each literal from set to literal.
+ */
+template<typename Literal, typename... Literals>
+struct literal_set_append<Literal, literal_set<Literals...>>
+{
+    using type = literal_set<typename int_seq_concat<Literal, Literals>::type...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief All concatenations of literals from two sets.
+ *
+ * @tparam Set1 The first parts.
+ * @tparam Set2 The second parts.
+ */
+template<typename Set1, typename Set2>
+struct literal_set_product;
+
+/* ************************************************************************ */
+
+/**
+ * @brief All concatenations of literals from two sets.
+ */
+template<typename... Literals, typename Set2>
+struct literal_set_product<literal_set<Literals...>, Set2>
+{
+    using type = typename literal_set_merge<
+        typename literal_set_append<Literals, Set2>::type...
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Literals from which one must be at the beginning of each match.
+ *
+ * `type` is a `literal_set`, empty when there is a match that doesn't
+ * start with a literal. `complete` is true when the rule matches only
+ * the literals so following rules can extend them.
+ *
+ * @tparam Rule Analyzed rule.
+ */
+template<typename Rule>
+struct literal_prefixes
+{
+    /// Literals.
+    using type = literal_set<>;
+
+    /// If rule matches only literals.
+    static constexpr bool complete = false;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `val`.
+ */
+template<int Value>
+struct literal_prefixes<val<Value>>
+{
+    using type = literal_set<int_seq<Value>>;
+    static constexpr bool complete = true;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Maximum number of values of `range` taken as single value literals.
+ *
+ * `simplify` merges alternatives of values (e.g. `a|b`) into ranges.
+ */
+constexpr int literal_range_limit = 4;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Single value literals of values.
+ *
+ * @tparam Values Sequence of values.
+ */
+template<typename Values>
+struct literal_values;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Single value literals of values.
+ */
+template<int... Values>
+struct literal_values<int_seq<Values...>>
+{
+    using type = literal_set<int_seq<Values>...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `range` of a few values.
+ */
+template<int Low, int High>
+struct literal_prefixes<range<Low, High>>
+{
+    static constexpr bool complete = High - Low < literal_range_limit;
+
+    using type = typename std::conditional<complete,
+        literal_values<make_int_seq<Low, complete ? High + 1 : Low>>,
+        std::conditional<true, literal_set<>, void>
+    >::type::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence`.
+ */
+template<typename Rule, typename... Rules>
+struct literal_prefixes<sequence<Rule, Rules...>>
+{
+    using _first = literal_prefixes<Rule>;
+    using _rest = literal_prefixes<sequence<Rules...>>;
+
+    static constexpr bool _extend =
+        _first::complete &&
+        _rest::type::size != 0 &&
+        _first::type::size * _rest::type::size <= literal_set_limit
+    ;
+
+    using type = typename std::conditional<_extend,
+        literal_set_product<typename _first::type, typename _rest::type>,
+        std::conditional<true, typename _first::type, void>
+    >::type::type;
+
+    static constexpr bool complete = _extend && _rest::complete;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` with single rule.
+ */
+template<typename Rule>
+struct literal_prefixes<sequence<Rule>> : literal_prefixes<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative` - union of branches.
+ */
+template<typename Rule, typename... Rules>
+struct literal_prefixes<alternative<Rule, Rules...>>
+{
+    using _first = literal_prefixes<Rule>;
+    using _rest = literal_prefixes<alternative<Rules...>>;
+
+    static constexpr bool _valid =
+        _first::type::size != 0 &&
+        _rest::type::size != 0
+    ;
+
+    using type = typename std::conditional<_valid,
+        literal_set_merge<typename _first::type, typename _rest::type>,
+        std::conditional<true, literal_set<>, void>
+    >::type::type;
+
+    static constexpr bool complete = _valid && _first::complete && _rest::complete;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative` with single rule.
+ */
+template<typename Rule>
+struct literal_prefixes<alternative<Rule>> : literal_prefixes<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat` - at least one occurrence.
+ */
+template<typename Rule>
+struct literal_prefixes<repeat<Rule>>
+{
+    using type = typename literal_prefixes<Rule>::type;
+    static constexpr bool complete = false;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n` - nothing without required occurrence.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct literal_prefixes<repeat_n<Rule, Min, Max>>
+{
+    using type = typename std::conditional<(Min > 0),
+        typename literal_prefixes<Rule>::type,
+        literal_set<>
+    >::type;
+
+    static constexpr bool complete = false;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `capture`.
+ */
+template<typename Rule>
+struct literal_prefixes<capture<Rule>> : literal_prefixes<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule>
+struct literal_prefixes<group<Index, Rule>> : literal_prefixes<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store`.
+ */
+template<typename Rule, typename Value>
+struct literal_prefixes<store<Rule, Value>> : literal_prefixes<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin`.
+ */
+template<typename Rule>
+struct literal_prefixes<begin<Rule>> : literal_prefixes<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `end`.
+ */
+template<typename Rule>
+struct literal_prefixes<end<Rule>> : literal_prefixes<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin_end`.
+ */
+template<typename Rule>
+struct literal_prefixes<begin_end<Rule>> : literal_prefixes<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `automaton`.
+ */
+template<typename Rule, bool Full, typename Backend>
+struct literal_prefixes<automaton<Rule, Full, Backend>> : literal_prefixes<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Length of unbounded matches.
+ */
+constexpr std::size_t length_unbounded = static_cast<std::size_t>(-1);
+
+/* ************************************************************************ */
+
+/**
+ * @brief Sum of two match lengths.
+ */
+constexpr std::size_t length_add(std::size_t first, std::size_t second) noexcept
+{
+    return (first == length_unbounded || second == length_unbounded ||
+            first > length_unbounded - second)
+        ? length_unbounded
+        : first + second
+    ;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match length repeated given times.
+ */
+constexpr std::size_t length_mul(std::size_t length, std::size_t count) noexcept
+{
+    return (length == 0 || count == 0)
+        ? 0
+        : (length == length_unbounded || count == length_unbounded ||
+           length > length_unbounded / count)
+            ? length_unbounded
+            : length * count
+    ;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Minimum and maximum number of values matched by rule.
+ *
+ * The bounds are computed from rule types so the real matches can be
+ * in narrower range. Character classes match single value, other unknown
+ * rules have bounds [0, `length_unbounded`].
+ *
+ * @tparam Rule Analyzed rule.
+ */
+template<typename Rule>
+struct match_length
+{
+    /// Minimum number of values.
+    static constexpr std::size_t min = class_traits<Rule>::is_class ? 1 : 0;
+
+    /// Maximum number of values or `length_unbounded`.
+    static constexpr std::size_t max = class_traits<Rule>::is_class ? 1 : length_unbounded;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for single value rules.
+ */
+struct match_length_value
+{
+    static constexpr std::size_t min = 1;
+    static constexpr std::size_t max = 1;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `val`.
+ */
+template<int Value>
+struct match_length<val<Value>> : match_length_value {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `val_not`.
+ */
+template<int Value>
+struct match_length<val_not<Value>> : match_length_value {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `range`.
+ */
+template<int Low, int High>
+struct match_length<range<Low, High>> : match_length_value {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `any`.
+ */
+template<>
+struct match_length<any> : match_length_value {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative_not`.
+ */
+template<typename... Rules>
+struct match_length<alternative_not<Rules...>> : match_length_value {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `null_rule`.
+ */
+template<>
+struct match_length<null_rule>
+{
+    static constexpr std::size_t min = 0;
+    static constexpr std::size_t max = 0;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence`.
+ */
+template<typename Rule, typename... Rules>
+struct match_length<sequence<Rule, Rules...>>
+{
+    using _first = match_length<Rule>;
+    using _rest = match_length<sequence<Rules...>>;
+
+    static constexpr std::size_t min = length_add(_first::min, _rest::min);
+    static constexpr std::size_t max = length_add(_first::max, _rest::max);
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` with single rule.
+ */
+template<typename Rule>
+struct match_length<sequence<Rule>> : match_length<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative`.
+ */
+template<typename Rule, typename... Rules>
+struct match_length<alternative<Rule, Rules...>>
+{
+    using _first = match_length<Rule>;
+    using _rest = match_length<alternative<Rules...>>;
+
+    static constexpr std::size_t min = _first::min < _rest::min ? _first::min : _rest::min;
+    static constexpr std::size_t max = _first::max > _rest::max ? _first::max : _rest::max;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative` with single rule.
+ */
+template<typename Rule>
+struct match_length<alternative<Rule>> : match_length<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `optional`.
+ */
+template<typename Rule>
+struct match_length<optional<Rule>>
+{
+    static constexpr std::size_t min = 0;
+    static constexpr std::size_t max = match_length<Rule>::max;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_optional`.
+ */
+template<typename Rule>
+struct match_length<repeat_optional<Rule>>
+{
+    static constexpr std::size_t min = 0;
+    static constexpr std::size_t max = length_mul(match_length<Rule>::max, length_unbounded);
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat`.
+ */
+template<typename Rule>
+struct match_length<repeat<Rule>>
+{
+    static constexpr std::size_t min = match_length<Rule>::min;
+    static constexpr std::size_t max = length_mul(match_length<Rule>::max, length_unbounded);
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n`.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct match_length<repeat_n<Rule, Min, Max>>
+{
+    static constexpr std::size_t min = length_mul(match_length<Rule>::min, Min);
+    static constexpr std::size_t max = length_mul(match_length<Rule>::max,
+        Max == repeat_unbounded ? length_unbounded : Max);
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `capture`.
+ */
+template<typename Rule>
+struct match_length<capture<Rule>> : match_length<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule>
+struct match_length<group<Index, Rule>> : match_length<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store`.
+ */
+template<typename Rule, typename Value>
+struct match_length<store<Rule, Value>> : match_length<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin`.
+ */
+template<typename Rule>
+struct match_length<begin<Rule>> : match_length<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `end`.
+ */
+template<typename Rule>
+struct match_length<end<Rule>> : match_length<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin_end`.
+ */
+template<typename Rule>
+struct match_length<begin_end<Rule>> : match_length<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `automaton`.
+ */
+template<typename Rule, bool Full, typename Backend>
+struct match_length<automaton<Rule, Full, Backend>> : match_length<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief If rule can match an empty input.
+ *
+ * @tparam Rule Analyzed rule.
+ */
+template<typename Rule>
+struct nullable : std::integral_constant<bool, match_length<Rule>::min == 0> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Set of bytes that can be the first value of a non-empty match.
+ *
+ * Character classes have their own set and unknown rules can start with
+ * any byte.
+ *
+ * @tparam Rule Analyzed rule.
+ */
+template<typename Rule>
+struct first_set
+{
+    /**
+     * @brief Returns set of the first bytes.
+     */
+    static constexpr charset set() noexcept
+    {
+        return set(std::integral_constant<bool, class_traits<Rule>::is_class>{});
+    }
+
+
+// Private Operations
+private:
+
+
+    static constexpr charset set(std::true_type) noexcept
+    {
+        return class_traits<Rule>::set();
+    }
+
+
+    static constexpr charset set(std::false_type) noexcept
+    {
+        return ~charset{};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `null_rule`.
+ */
+template<>
+struct first_set<null_rule>
+{
+    static constexpr charset set() noexcept
+    {
+        return charset{};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` - following rules after nullable rule.
+ */
+template<typename Rule, typename... Rules>
+struct first_set<sequence<Rule, Rules...>>
+{
+    static constexpr charset set() noexcept
+    {
+        return nullable<Rule>::value
+            ? first_set<Rule>::set() | first_set<sequence<Rules...>>::set()
+            : first_set<Rule>::set()
+        ;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` with single rule.
+ */
+template<typename Rule>
+struct first_set<sequence<Rule>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative`.
+ */
+template<typename Rule, typename... Rules>
+struct first_set<alternative<Rule, Rules...>>
+{
+    static constexpr charset set() noexcept
+    {
+        return first_set<Rule>::set() | first_set<alternative<Rules...>>::set();
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative` with single rule.
+ */
+template<typename Rule>
+struct first_set<alternative<Rule>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `optional`.
+ */
+template<typename Rule>
+struct first_set<optional<Rule>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_optional`.
+ */
+template<typename Rule>
+struct first_set<repeat_optional<Rule>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat`.
+ */
+template<typename Rule>
+struct first_set<repeat<Rule>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n`.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct first_set<repeat_n<Rule, Min, Max>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `capture`.
+ */
+template<typename Rule>
+struct first_set<capture<Rule>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule>
+struct first_set<group<Index, Rule>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store`.
+ */
+template<typename Rule, typename Value>
+struct first_set<store<Rule, Value>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin`.
+ */
+template<typename Rule>
+struct first_set<begin<Rule>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `end`.
+ */
+template<typename Rule>
+struct first_set<end<Rule>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin_end`.
+ */
+template<typename Rule>
+struct first_set<begin_end<Rule>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `automaton`.
+ */
+template<typename Rule, bool Full, typename Backend>
+struct first_set<automaton<Rule, Full, Backend>> : first_set<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Literals that each match must contain.
+ *
+ * `type` is a `literal_set` of literals that are all in each match. Rules
+ * without the sequence structure contribute by their literal prefix.
+ *
+ * @tparam Rule Analyzed rule.
+ */
+template<typename Rule>
+struct required_literals;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Set with single literal or empty set for empty literal.
+ *
+ * @tparam Literal An `int_seq`.
+ */
+template<typename Literal>
+struct required_literal_set
+{
+    using type = literal_set<Literal>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for empty literal.
+ */
+template<>
+struct required_literal_set<int_seq<>>
+{
+    using type = literal_set<>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Required literals of sequence items.
+ *
+ * Adjacent literals are joined into one literal that continues into the
+ * literal prefix of the following rule.
+ *
+ * @tparam Literal  Literal of previous items.
+ * @tparam Set      Literals found so far.
+ * @tparam Complete If the current rule is literal.
+ * @tparam Rules    Remaining items.
+ */
+template<typename Literal, typename Set, bool Complete, typename... Rules>
+struct required_literals_sequence
+{
+    using type = typename literal_set_merge<
+        Set,
+        typename required_literal_set<Literal>::type
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief If the first of sequence items is literal.
+ */
+template<typename... Rules>
+struct required_literals_next : std::false_type {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief If the first of sequence items is literal.
+ */
+template<typename Rule, typename... Rules>
+struct required_literals_next<Rule, Rules...>
+    : std::integral_constant<bool, literal_prefix<Rule>::complete> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Literal item extends the literal.
+ */
+template<typename Literal, typename Set, typename Rule, typename... Rules>
+struct required_literals_sequence<Literal, Set, true, Rule, Rules...>
+    : required_literals_sequence<
+        typename int_seq_concat<Literal, typename literal_prefix<Rule>::type>::type,
+        Set,
+        required_literals_next<Rules...>::value,
+        Rules...
+    >
+{
+    // Nothing
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Other item ends the literal and adds its required literals.
+ */
+template<typename Literal, typename Set, typename Rule, typename... Rules>
+struct required_literals_sequence<Literal, Set, false, Rule, Rules...>
+    : required_literals_sequence<
+        int_seq<>,
+        typename literal_set_merge<
+            Set,
+            typename required_literal_set<typename int_seq_concat<
+                Literal, typename literal_prefix<Rule>::type
+            >::type>::type,
+            typename required_literals<Rule>::type
+        >::type,
+        required_literals_next<Rules...>::value,
+        Rules...
+    >
+{
+    // Nothing
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Literals that each match must contain.
+ */
+template<typename Rule>
+struct required_literals
+{
+    /// Required literals.
+    using type = typename required_literal_set<typename literal_prefix<Rule>::type>::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence`.
+ */
+template<typename Rule, typename... Rules>
+struct required_literals<sequence<Rule, Rules...>>
+    : required_literals_sequence<int_seq<>, literal_set<>, literal_prefix<Rule>::complete, Rule, Rules...>
+{
+    // Nothing
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat`.
+ */
+template<typename Rule>
+struct required_literals<repeat<Rule>> : required_literals<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n`.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct required_literals<repeat_n<Rule, Min, Max>>
+{
+    using type = typename std::conditional<(Min > 0),
+        typename required_literals<Rule>::type,
+        literal_set<>
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `capture`.
+ */
+template<typename Rule>
+struct required_literals<capture<Rule>> : required_literals<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule>
+struct required_literals<group<Index, Rule>> : required_literals<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store`.
+ */
+template<typename Rule, typename Value>
+struct required_literals<store<Rule, Value>> : required_literals<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin`.
+ */
+template<typename Rule>
+struct required_literals<begin<Rule>> : required_literals<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `end`.
+ */
+template<typename Rule>
+struct required_literals<end<Rule>> : required_literals<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin_end`.
+ */
+template<typename Rule>
+struct required_literals<begin_end<Rule>> : required_literals<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `automaton`.
+ */
+template<typename Rule, bool Full, typename Backend>
+struct required_literals<automaton<Rule, Full, Backend>> : required_literals<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief The longest literal of `literal_set`.
+ *
+ * @tparam Set Set of literals.
+ */
+template<typename Set>
+struct literal_set_longest;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Empty set.
+ */
+template<>
+struct literal_set_longest<literal_set<>>
+{
+    using type = int_seq<>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Non-empty set, the first one wins for same lengths.
+ */
+template<typename Literal, typename... Literals>
+struct literal_set_longest<literal_set<Literal, Literals...>>
+{
+    using _rest = typename literal_set_longest<literal_set<Literals...>>::type;
+
+    using type = typename std::conditional<
+        (int_seq_size(Literal{}) >= int_seq_size(_rest{})),
+        Literal,
+        _rest
+    >::type;
+};
+
+/* ************************************************************************ */
+
+}
+}
+
+/* ************************************************************************ */
@@ -0,0 +1,2957 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file automaton.hpp
+ *
+ * This header contains compile-time conversion of rules into a finite
+ * automaton. The rule tree is translated into a Thompson NFA and the NFA
+ * is converted into a DFA by subset construction. Everything is done
+ * by `constexpr` functions so the result is stored in read-only data
+ * and the matching code is generated from it.
+ *
+ * The automaton works over bytes (values 0 - 255) so it can be used only
+ * for single byte character types.
+ *
+ * Unlike the nested rules, the automaton tries all alternatives at once
+ * and it never needs to re-scan the input, e.g. `a*ab` matches "aab".
+ * Rules with too many DFA states are matched by simulation of the NFA
+ * that also reads the input once.
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+// Library
+#include "rules.hpp"
+
+/* ************************************************************************ */
+
+#ifndef TEMPLATE_REGEX_AUTOMATON_MAX_STATES
+/// Maximum number of DFA states created by subset construction.
+#define TEMPLATE_REGEX_AUTOMATON_MAX_STATES 512
+#endif
+
+/* ************************************************************************ */
+
+namespace template_regex {
+namespace rules {
+
+/* ************************************************************************ */
+
+/**
+ * @brief A part of NFA created from a rule.
+ */
+struct nfa_fragment
+{
+    /// Starting state.
+    int start;
+
+    /// Accepting state.
+    int accept;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Test if value is matched by character class.
+ *
+ * Used for values wider than byte that aren't in the transition bytes.
+ *
+ * @tparam Rule Character class.
+ *
+ * @param value Tested value.
+ */
+template<typename Rule>
+bool nfa_class_test(int value)
+{
+    const int* it = &value;
+    return Rule::match_ref(it, it + 1);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief NFA transition.
+ */
+struct nfa_edge
+{
+    /// Source state.
+    int from = 0;
+
+    /// Target state.
+    int to = 0;
+
+    /// If transition doesn't consume any byte.
+    bool epsilon = true;
+
+    /// Submatch slot stored by epsilon transition or -1.
+    int slot = -1;
+
+    /// Bytes that allows the transition.
+    charset set;
+
+    /// Test of any value that allows the transition.
+    bool (*test)(int) = nullptr;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Thompson NFA with fixed capacity.
+ *
+ * Accepting states are marked by non-zero tag mask. Single rule uses tag 1
+ * but NFAs can be merged and each part can have its own tag.
+ *
+ * @tparam States Maximum number of states.
+ * @tparam Edges  Maximum number of transitions.
+ */
+template<std::size_t States, std::size_t Edges>
+struct nfa
+{
+
+    /// Number of states.
+    int state_count = 0;
+
+    /// Number of transitions.
+    int edge_count = 0;
+
+    /// Starting state.
+    int start = 0;
+
+    /// Transitions.
+    nfa_edge edges[Edges > 0 ? Edges : 1];
+
+    /// Accepting tags of states.
+    unsigned long long accept[States > 0 ? States : 1] = {};
+
+
+    /**
+     * @brief Create a new state.
+     *
+     * @return State number.
+     */
+    constexpr int add_state() noexcept
+    {
+        return state_count++;
+    }
+
+
+    /**
+     * @brief Add epsilon transition.
+     *
+     * @param from Source state.
+     * @param to   Target state.
+     */
+    constexpr void add_edge(int from, int to) noexcept
+    {
+        edges[edge_count].from = from;
+        edges[edge_count].to = to;
+        edges[edge_count].epsilon = true;
+        ++edge_count;
+    }
+
+
+    /**
+     * @brief Add epsilon transition that stores position into slot.
+     *
+     * @param from Source state.
+     * @param to   Target state.
+     * @param slot Submatch slot.
+     */
+    constexpr void add_slot_edge(int from, int to, int slot) noexcept
+    {
+        add_edge(from, to);
+        edges[edge_count - 1].slot = slot;
+    }
+
+
+    /**
+     * @brief Add byte transition.
+     *
+     * @param from Source state.
+     * @param to   Target state.
+     * @param set  Bytes that allows the transition.
+     * @param test Test of any value that allows the transition.
+     */
+    constexpr void add_edge(int from, int to, const charset& set, bool (*test)(int) = nullptr) noexcept
+    {
+        edges[edge_count].from = from;
+        edges[edge_count].to = to;
+        edges[edge_count].epsilon = false;
+        edges[edge_count].set = set;
+        edges[edge_count].test = test;
+        ++edge_count;
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief NFA construction traits.
+ *
+ * Each supported rule defines number of required states and transitions
+ * and a function that creates a fragment of NFA for the rule.
+ *
+ * The primary template handles character classes.
+ *
+ * @tparam Rule Rule type.
+ */
+template<typename Rule, typename Enable = void>
+struct nfa_traits
+{
+    /// If rule can be converted into NFA.
+    static constexpr bool supported = class_traits<Rule>::is_class;
+
+    /// Number of required states.
+    static constexpr std::size_t states = 2;
+
+    /// Number of required transitions.
+    static constexpr std::size_t edges = 1;
+
+
+    template<typename Nfa>
+    static constexpr nfa_fragment build(Nfa& nfa) noexcept
+    {
+        const int start = nfa.add_state();
+        const int accept = nfa.add_state();
+        nfa.add_edge(start, accept, class_traits<Rule>::set(), &nfa_class_test<Rule>);
+
+        return {start, accept};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `null_rule`.
+ */
+template<>
+struct nfa_traits<null_rule>
+{
+    static constexpr bool supported = true;
+    static constexpr std::size_t states = 2;
+    static constexpr std::size_t edges = 1;
+
+
+    template<typename Nfa>
+    static constexpr nfa_fragment build(Nfa& nfa) noexcept
+    {
+        const int start = nfa.add_state();
+        const int accept = nfa.add_state();
+        nfa.add_edge(start, accept);
+
+        return {start, accept};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence`.
+ */
+template<typename Rule, typename... Rules>
+struct nfa_traits<sequence<Rule, Rules...>,
+    typename std::enable_if<(sizeof...(Rules) > 0)>::type>
+{
+    using _first = nfa_traits<Rule>;
+    using _rest = nfa_traits<sequence<Rules...>>;
+
+    static constexpr bool supported = _first::supported && _rest::supported;
+    static constexpr std::size_t states = _first::states + _rest::states;
+    static constexpr std::size_t edges = _first::edges + _rest::edges + 1;
+
+
+    template<typename Nfa>
+    static constexpr nfa_fragment build(Nfa& nfa) noexcept
+    {
+        const nfa_fragment first = _first::build(nfa);
+        const nfa_fragment rest = _rest::build(nfa);
+        nfa.add_edge(first.accept, rest.start);
+
+        return {first.start, rest.accept};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` with single rule.
+ */
+template<typename Rule>
+struct nfa_traits<sequence<Rule>> : nfa_traits<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Helper for building `alternative` branches.
+ */
+template<typename... Rules>
+struct nfa_alternative_builder;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Helper for building `alternative` branches.
+ */
+template<typename Rule, typename... Rules>
+struct nfa_alternative_builder<Rule, Rules...>
+{
+    using _first = nfa_traits<Rule>;
+    using _rest = nfa_alternative_builder<Rules...>;
+
+    static constexpr bool supported = _first::supported && _rest::supported;
+    static constexpr std::size_t states = _first::states + _rest::states;
+    static constexpr std::size_t edges = _first::edges + _rest::edges + 2;
+
+
+    template<typename Nfa>
+    static constexpr void build(Nfa& nfa, int start, int accept) noexcept
+    {
+        const nfa_fragment first = _first::build(nfa);
+        nfa.add_edge(start, first.start);
+        nfa.add_edge(first.accept, accept);
+        _rest::build(nfa, start, accept);
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Helper for building `alternative` branches.
+ */
+template<>
+struct nfa_alternative_builder<>
+{
+    static constexpr bool supported = true;
+    static constexpr std::size_t states = 0;
+    static constexpr std::size_t edges = 0;
+
+
+    template<typename Nfa>
+    static constexpr void build(Nfa& nfa, int start, int accept) noexcept
+    {
+        // Nothing
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative` that is not a character class.
+ */
+template<typename... Rules>
+struct nfa_traits<alternative<Rules...>,
+    typename std::enable_if<!class_traits<alternative<Rules...>>::is_class>::type>
+{
+    using _branches = nfa_alternative_builder<Rules...>;
+
+    static constexpr bool supported = _branches::supported;
+    static constexpr std::size_t states = _branches::states + 2;
+    static constexpr std::size_t edges = _branches::edges;
+
+
+    template<typename Nfa>
+    static constexpr nfa_fragment build(Nfa& nfa) noexcept
+    {
+        const int start = nfa.add_state();
+        const int accept = nfa.add_state();
+        _branches::build(nfa, start, accept);
+
+        return {start, accept};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_optional`: {Rule}*
+ */
+template<typename Rule>
+struct nfa_traits<repeat_optional<Rule>>
+{
+    using _inner = nfa_traits<Rule>;
+
+    static constexpr bool supported = _inner::supported;
+    static constexpr std::size_t states = _inner::states + 2;
+    static constexpr std::size_t edges = _inner::edges + 4;
+
+
+    template<typename Nfa>
+    static constexpr nfa_fragment build(Nfa& nfa) noexcept
+    {
+        const int start = nfa.add_state();
+        const int accept = nfa.add_state();
+        const nfa_fragment inner = _inner::build(nfa);
+        nfa.add_edge(start, inner.start);
+        nfa.add_edge(start, accept);
+        nfa.add_edge(inner.accept, inner.start);
+        nfa.add_edge(inner.accept, accept);
+
+        return {start, accept};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat`: {Rule}+
+ */
+template<typename Rule>
+struct nfa_traits<repeat<Rule>>
+{
+    using _inner = nfa_traits<Rule>;
+
+    static constexpr bool supported = _inner::supported;
+    static constexpr std::size_t states = _inner::states + 2;
+    static constexpr std::size_t edges = _inner::edges + 3;
+
+
+    template<typename Nfa>
+    static constexpr nfa_fragment build(Nfa& nfa) noexcept
+    {
+        const int start = nfa.add_state();
+        const int accept = nfa.add_state();
+        const nfa_fragment inner = _inner::build(nfa);
+        nfa.add_edge(start, inner.start);
+        nfa.add_edge(inner.accept, inner.start);
+        nfa.add_edge(inner.accept, accept);
+
+        return {start, accept};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `optional`: {Rule}?
+ */
+template<typename Rule>
+struct nfa_traits<optional<Rule>>
+{
+    using _inner = nfa_traits<Rule>;
+
+    static constexpr bool supported = _inner::supported;
+    static constexpr std::size_t states = _inner::states + 2;
+    static constexpr std::size_t edges = _inner::edges + 3;
+
+
+    template<typename Nfa>
+    static constexpr nfa_fragment build(Nfa& nfa) noexcept
+    {
+        const int start = nfa.add_state();
+        const int accept = nfa.add_state();
+        const nfa_fragment inner = _inner::build(nfa);
+        nfa.add_edge(start, inner.start);
+        nfa.add_edge(start, accept);
+        nfa.add_edge(inner.accept, accept);
+
+        return {start, accept};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Maximum number of copies of `repeat_n` inner rule in NFA.
+ */
+constexpr unsigned nfa_repeat_limit = 256;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n`: {Rule}{Min,Max}
+ *
+ * The inner rule is copied `Min` times followed by `Max - Min` nested
+ * optional copies (or single `repeat_optional` copy for unbounded
+ * repetition), so the DFA states count repetitions. Larger counts are
+ * not supported and they are matched by counted loop of `repeat_n`.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct nfa_traits<repeat_n<Rule, Min, Max>>
+{
+    using _inner = nfa_traits<Rule>;
+
+    /// If repetition is unbounded.
+    static constexpr bool _unbounded = Max == repeat_unbounded;
+
+    /// Number of optional copies.
+    static constexpr std::size_t _optional = _unbounded ? 1 : Max - Min;
+
+    /// Number of copies.
+    static constexpr std::size_t _copies = Min + _optional;
+
+    static constexpr bool supported = _inner::supported && _copies <= nfa_repeat_limit;
+    static constexpr std::size_t states = _inner::states * _copies + 2;
+    static constexpr std::size_t edges = _inner::edges * _copies + Min + (_unbounded ? 4 : 2 * _optional) + 1;
+
+
+    template<typename Nfa>
+    static constexpr nfa_fragment build(Nfa& nfa) noexcept
+    {
+        const int start = nfa.add_state();
+        const int accept = nfa.add_state();
+        int current = start;
+
+        for (unsigned i = 0; i < Min; ++i)
+        {
+            const nfa_fragment inner = _inner::build(nfa);
+            nfa.add_edge(current, inner.start);
+            current = inner.accept;
+        }
+
+        if (_unbounded)
+        {
+            const nfa_fragment inner = _inner::build(nfa);
+            nfa.add_edge(current, inner.start);
+            nfa.add_edge(current, accept);
+            nfa.add_edge(inner.accept, inner.start);
+            nfa.add_edge(inner.accept, accept);
+
+            return {start, accept};
+        }
+
+        // Next copy is preferred, as in greedy repetition
+        for (std::size_t i = 0; i < _optional; ++i)
+        {
+            const nfa_fragment inner = _inner::build(nfa);
+            nfa.add_edge(current, inner.start);
+            nfa.add_edge(current, accept);
+            current = inner.accept;
+        }
+
+        nfa.add_edge(current, accept);
+
+        return {start, accept};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `capture` - the automaton doesn't capture.
+ */
+template<typename Rule>
+struct nfa_traits<capture<Rule>> : nfa_traits<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ *
+ * Group beginning and end are epsilon transitions that store slots
+ * `2 * Index` and `2 * Index + 1`. DFA ignores the slots.
+ */
+template<unsigned Index, typename Rule>
+struct nfa_traits<group<Index, Rule>>
+{
+    using _inner = nfa_traits<Rule>;
+
+    static constexpr bool supported = _inner::supported;
+    static constexpr std::size_t states = _inner::states + 2;
+    static constexpr std::size_t edges = _inner::edges + 2;
+
+
+    template<typename Nfa>
+    static constexpr nfa_fragment build(Nfa& nfa) noexcept
+    {
+        const int start = nfa.add_state();
+        const int accept = nfa.add_state();
+        const nfa_fragment inner = _inner::build(nfa);
+        nfa.add_slot_edge(start, inner.start, 2 * Index);
+        nfa.add_slot_edge(inner.accept, accept, 2 * Index + 1);
+
+        return {start, accept};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store` - the automaton doesn't store.
+ */
+template<typename Rule, typename Value>
+struct nfa_traits<store<Rule, Value>> : nfa_traits<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Alternative of rules where each rule has its own accepting tag.
+ *
+ * The rule cannot be matched, it's used only for building an automaton
+ * of multiple rules. Accepting states of the n-th rule are tagged by
+ * `1 << n` so at most 64 rules can be merged.
+ *
+ * @tparam Rules Merged rules.
+ */
+template<typename... Rules>
+struct tagged_alternative {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Helper for building `tagged_alternative` branches.
+ *
+ * @tparam Index Index of the first rule.
+ */
+template<unsigned Index, typename... Rules>
+struct nfa_tagged_builder;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Helper for building `tagged_alternative` branches.
+ */
+template<unsigned Index, typename Rule, typename... Rules>
+struct nfa_tagged_builder<Index, Rule, Rules...>
+{
+    using _first = nfa_traits<Rule>;
+    using _rest = nfa_tagged_builder<Index + 1, Rules...>;
+
+    static constexpr bool supported = Index < 64 && _first::supported && _rest::supported;
+    static constexpr std::size_t states = _first::states + _rest::states;
+    static constexpr std::size_t edges = _first::edges + _rest::edges + 1;
+
+
+    template<typename Nfa>
+    static constexpr void build(Nfa& nfa, int start) noexcept
+    {
+        const nfa_fragment first = _first::build(nfa);
+        nfa.add_edge(start, first.start);
+        nfa.accept[first.accept] |= 1ull << Index;
+        _rest::build(nfa, start);
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Helper for building `tagged_alternative` branches.
+ */
+template<unsigned Index>
+struct nfa_tagged_builder<Index>
+{
+    static constexpr bool supported = true;
+    static constexpr std::size_t states = 0;
+    static constexpr std::size_t edges = 0;
+
+
+    template<typename Nfa>
+    static constexpr void build(Nfa& nfa, int start) noexcept
+    {
+        // Nothing
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `tagged_alternative`.
+ *
+ * The fragment has no accepting state (-1) because the branches are
+ * tagged during building.
+ */
+template<typename... Rules>
+struct nfa_traits<tagged_alternative<Rules...>>
+{
+    using _branches = nfa_tagged_builder<0, Rules...>;
+
+    static constexpr bool supported = sizeof...(Rules) > 0 && _branches::supported;
+    static constexpr std::size_t states = _branches::states + 1;
+    static constexpr std::size_t edges = _branches::edges;
+
+
+    template<typename Nfa>
+    static constexpr nfa_fragment build(Nfa& nfa) noexcept
+    {
+        const int start = nfa.add_state();
+        _branches::build(nfa, start);
+
+        return {start, -1};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief NFA type for given rule.
+ *
+ * @tparam Rule Source rule.
+ */
+template<typename Rule>
+using nfa_type = nfa<nfa_traits<Rule>::states, nfa_traits<Rule>::edges>;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Create NFA from rule.
+ *
+ * @tparam Rule Source rule.
+ * @tparam Tag  Accepting tag.
+ *
+ * @return NFA.
+ */
+template<typename Rule, unsigned long long Tag = 1>
+constexpr nfa_type<Rule> make_nfa() noexcept
+{
+    nfa_type<Rule> res;
+    const nfa_fragment fragment = nfa_traits<Rule>::build(res);
+    res.start = fragment.start;
+
+    if (fragment.accept >= 0)
+        res.accept[fragment.accept] = Tag;
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Partition of bytes into equivalence classes.
+ *
+ * Two bytes are in the same class if there is no transition that
+ * distinguishes them.
+ */
+struct byte_classes
+{
+
+    /// Class of each byte.
+    unsigned char class_of[256] = {};
+
+    /// Representative byte of each class.
+    unsigned char representative[256] = {};
+
+    /// Number of classes.
+    int count = 1;
+
+
+    /**
+     * @brief Split classes by given set.
+     *
+     * @param set Set of bytes.
+     */
+    constexpr void split(const charset& set) noexcept
+    {
+        // New class for each (class, in set) pair
+        int mapping[512] = {};
+
+        for (int i = 0; i < 512; ++i)
+            mapping[i] = -1;
+
+        int next = 0;
+
+        for (int c = 0; c < 256; ++c)
+        {
+            const int key = class_of[c] * 2 + (set.test(c) ? 1 : 0);
+
+            if (mapping[key] < 0)
+            {
+                representative[next] = static_cast<unsigned char>(c);
+                mapping[key] = next++;
+            }
+
+            class_of[c] = static_cast<unsigned char>(mapping[key]);
+        }
+
+        count = next;
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Compute byte classes from NFA transitions.
+ *
+ * @param nfa Source NFA.
+ *
+ * @return Byte classes.
+ */
+template<typename Nfa>
+constexpr byte_classes make_byte_classes(const Nfa& nfa) noexcept
+{
+    byte_classes res;
+
+    for (int i = 0; i < nfa.edge_count; ++i)
+    {
+        if (!nfa.edges[i].epsilon)
+            res.split(nfa.edges[i].set);
+    }
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Set of NFA states.
+ *
+ * @tparam States Maximum number of NFA states.
+ */
+template<std::size_t States>
+struct nfa_state_set
+{
+
+    /// Number of words.
+    static constexpr std::size_t words = (States + 63) / 64 > 0 ? (States + 63) / 64 : 1;
+
+    /// Set bits.
+    unsigned long long bits[words] = {};
+
+
+    constexpr bool test(int state) const noexcept
+    {
+        return (bits[state >> 6] >> (state & 63)) & 1;
+    }
+
+
+    constexpr void set(int state) noexcept
+    {
+        bits[state >> 6] |= 1ull << (state & 63);
+    }
+
+
+    constexpr bool empty() const noexcept
+    {
+        for (std::size_t i = 0; i < words; ++i)
+        {
+            if (bits[i])
+                return false;
+        }
+
+        return true;
+    }
+
+
+    constexpr void merge(const nfa_state_set& rhs) noexcept
+    {
+        for (std::size_t i = 0; i < words; ++i)
+            bits[i] |= rhs.bits[i];
+    }
+
+
+    constexpr bool operator==(const nfa_state_set& rhs) const noexcept
+    {
+        for (std::size_t i = 0; i < words; ++i)
+        {
+            if (bits[i] != rhs.bits[i])
+                return false;
+        }
+
+        return true;
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Epsilon closures of all NFA states.
+ *
+ * Byte transitions are grouped by source state so moving a set of states
+ * doesn't have to test all transitions.
+ *
+ * @tparam States Maximum number of NFA states.
+ * @tparam Edges  Maximum number of NFA transitions.
+ */
+template<std::size_t States, std::size_t Edges>
+struct nfa_closures
+{
+    using set_type = nfa_state_set<States>;
+
+    /// Closure for each state.
+    set_type closure[States > 0 ? States : 1];
+
+    /// Index of the first byte transition of each state in `edges`.
+    int first[States + 1] = {};
+
+    /// Byte transitions grouped by source state.
+    int edges[Edges > 0 ? Edges : 1] = {};
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Compute epsilon closures of all NFA states.
+ *
+ * @param nfa Source NFA.
+ *
+ * @return Closures.
+ */
+template<std::size_t States, std::size_t Edges>
+constexpr nfa_closures<States, Edges> make_nfa_closures(const nfa<States, Edges>& nfa) noexcept
+{
+    nfa_closures<States, Edges> res;
+
+    // Epsilon transitions grouped by source state
+    int first[States + 1] = {};
+    int targets[Edges > 0 ? Edges : 1] = {};
+
+    for (int i = 0; i < nfa.edge_count; ++i)
+    {
+        if (nfa.edges[i].epsilon)
+            ++first[nfa.edges[i].from + 1];
+    }
+
+    for (std::size_t state = 0; state < States; ++state)
+        first[state + 1] += first[state];
+
+    int fill[States > 0 ? States : 1] = {};
+
+    for (int i = 0; i < nfa.edge_count; ++i)
+    {
+        const nfa_edge& edge = nfa.edges[i];
+
+        if (edge.epsilon)
+            targets[first[edge.from] + fill[edge.from]++] = edge.to;
+        else
+            ++res.first[edge.from + 1];
+    }
+
+    // Byte transitions grouped by source state
+    for (std::size_t state = 0; state < States; ++state)
+    {
+        res.first[state + 1] += res.first[state];
+        fill[state] = 0;
+    }
+
+    for (int i = 0; i < nfa.edge_count; ++i)
+    {
+        const nfa_edge& edge = nfa.edges[i];
+
+        if (!edge.epsilon)
+            res.edges[res.first[edge.from] + fill[edge.from]++] = i;
+    }
+
+    for (int state = 0; state < nfa.state_count; ++state)
+    {
+        int stack[States > 0 ? States : 1] = {};
+        int top = 0;
+
+        res.closure[state].set(state);
+        stack[top++] = state;
+
+        while (top > 0)
+        {
+            const int current = stack[--top];
+
+            for (int i = first[current]; i < first[current + 1]; ++i)
+            {
+                if (!res.closure[state].test(targets[i]))
+                {
+                    res.closure[state].set(targets[i]);
+                    stack[top++] = targets[i];
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Deterministic finite automaton.
+ *
+ * Transitions are indexed by byte class. The starting state is always 0
+ * and missing transition is stored as -1.
+ *
+ * @tparam States  Number of states.
+ * @tparam Classes Number of byte classes.
+ */
+template<std::size_t States, std::size_t Classes>
+struct dfa
+{
+
+    /// Number of states.
+    static constexpr std::size_t state_count = States;
+
+    /// Number of byte classes.
+    static constexpr std::size_t class_count = Classes;
+
+    /// Byte classes.
+    byte_classes classes;
+
+    /// Transitions.
+    short next[States > 0 ? States : 1][Classes > 0 ? Classes : 1] = {};
+
+    /// Accepting tags of states.
+    unsigned long long accept[States > 0 ? States : 1] = {};
+
+
+    /**
+     * @brief Returns next state.
+     *
+     * @param state Current state.
+     * @param c     Input byte.
+     *
+     * @return Next state or -1.
+     */
+    constexpr int transition(int state, unsigned c) const noexcept
+    {
+        return next[state][classes.class_of[c & 0xFF]];
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Subset construction result without transitions.
+ *
+ * @tparam States Maximum number of NFA states.
+ */
+template<std::size_t States>
+struct subset_states
+{
+    using set_type = nfa_state_set<States>;
+
+    /// Number of DFA states.
+    int count = 0;
+
+    /// Sets of NFA states for each DFA state.
+    set_type sets[TEMPLATE_REGEX_AUTOMATON_MAX_STATES];
+
+
+    /**
+     * @brief Find a set.
+     *
+     * @param set NFA states set.
+     *
+     * @return DFA state or -1.
+     */
+    constexpr int find(const set_type& set) const noexcept
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (sets[i] == set)
+                return i;
+        }
+
+        return -1;
+    }
+
+
+    /**
+     * @brief Find or insert a set.
+     *
+     * @param set NFA states set.
+     *
+     * @return DFA state.
+     */
+    constexpr int find_or_add(const set_type& set) noexcept
+    {
+        const int found = find(set);
+
+        if (found >= 0)
+            return found;
+
+        if (count == TEMPLATE_REGEX_AUTOMATON_MAX_STATES)
+            return -1;
+
+        sets[count] = set;
+        return count++;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Compute the state reached from a set by byte.
+ *
+ * @param nfa      Source NFA.
+ * @param closures Epsilon closures.
+ * @param set      Source set.
+ * @param c        Input byte.
+ *
+ * @return Target set.
+ */
+template<std::size_t States, std::size_t Edges>
+constexpr nfa_state_set<States> subset_move(const nfa<States, Edges>& nfa,
+    const nfa_closures<States, Edges>& closures, const nfa_state_set<States>& set,
+    unsigned c) noexcept
+{
+    nfa_state_set<States> res;
+
+    for (int state = 0; state < nfa.state_count; ++state)
+    {
+        // Skip empty words
+        if (!set.bits[state >> 6])
+        {
+            state |= 63;
+            continue;
+        }
+
+        if (!set.test(state))
+            continue;
+
+        for (int i = closures.first[state]; i < closures.first[state + 1]; ++i)
+        {
+            const nfa_edge& edge = nfa.edges[closures.edges[i]];
+
+            if (edge.set.test(c))
+                res.merge(closures.closure[edge.to]);
+        }
+    }
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Perform subset construction.
+ *
+ * If the number of states exceeds the limit the result contains
+ * exactly TEMPLATE_REGEX_AUTOMATON_MAX_STATES states.
+ *
+ * @param nfa      Source NFA.
+ * @param closures Epsilon closures.
+ * @param classes  Byte classes.
+ *
+ * @return DFA states.
+ */
+template<std::size_t States, std::size_t Edges>
+constexpr subset_states<States> make_subset_states(const nfa<States, Edges>& nfa,
+    const nfa_closures<States, Edges>& closures, const byte_classes& classes) noexcept
+{
+    subset_states<States> res;
+    res.find_or_add(closures.closure[nfa.start]);
+
+    // Newly added states are processed in order
+    for (int state = 0; state < res.count; ++state)
+    {
+        for (int cls = 0; cls < classes.count; ++cls)
+        {
+            const auto target = subset_move(nfa, closures, res.sets[state],
+                classes.representative[cls]);
+
+            if (!target.empty() && res.find_or_add(target) < 0)
+                return res;
+        }
+    }
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Create DFA from NFA.
+ *
+ * @tparam Dfa Result DFA type.
+ *
+ * @param nfa     Source NFA.
+ * @param classes Byte classes.
+ *
+ * @return DFA.
+ */
+template<typename Dfa, std::size_t States, std::size_t Edges>
+constexpr Dfa make_dfa(const nfa<States, Edges>& nfa, const byte_classes& classes) noexcept
+{
+    const nfa_closures<States, Edges> closures = make_nfa_closures(nfa);
+
+    // Same construction as `make_subset_states` with stored transitions
+    subset_states<States> subsets;
+    subsets.find_or_add(closures.closure[nfa.start]);
+
+    Dfa res;
+    res.classes = classes;
+
+    for (int state = 0; state < subsets.count && state < static_cast<int>(Dfa::state_count); ++state)
+    {
+        for (int i = 0; i < nfa.state_count; ++i)
+        {
+            if (subsets.sets[state].test(i))
+                res.accept[state] |= nfa.accept[i];
+        }
+
+        for (int cls = 0; cls < classes.count; ++cls)
+        {
+            const auto target = subset_move(nfa, closures, subsets.sets[state],
+                classes.representative[cls]);
+
+            res.next[state][cls] = static_cast<short>(
+                target.empty() ? -1 : subsets.find_or_add(target)
+            );
+        }
+    }
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Count DFA states created from NFA.
+ *
+ * @param nfa     Source NFA.
+ * @param classes Byte classes.
+ *
+ * @return Number of states.
+ */
+template<std::size_t States, std::size_t Edges>
+constexpr std::size_t count_dfa_states(const nfa<States, Edges>& nfa,
+    const byte_classes& classes) noexcept
+{
+    return static_cast<std::size_t>(
+        make_subset_states(nfa, make_nfa_closures(nfa), classes).count
+    );
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Count DFA states created from rule.
+ *
+ * Unlike `automaton_data` the result can reach
+ * TEMPLATE_REGEX_AUTOMATON_MAX_STATES so it can be used for selecting
+ * another implementation when the automaton would be too large.
+ *
+ * @tparam Rule Source rule.
+ *
+ * @return Number of states.
+ */
+template<typename Rule>
+constexpr std::size_t count_rule_dfa_states() noexcept
+{
+    const nfa_type<Rule> nfa = make_nfa<Rule>();
+
+    return count_dfa_states(nfa, make_byte_classes(nfa));
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Partition of DFA states into equivalence classes.
+ *
+ * The DFA is completed by an extra dead state (number `state_count`).
+ *
+ * @tparam States Number of DFA states.
+ */
+template<std::size_t States>
+struct dfa_partition
+{
+
+    /// Block of each state (including dead state).
+    int block_of[States + 1] = {};
+
+    /// Number of blocks.
+    int count = 0;
+
+    /// Block of the dead state.
+    int dead = 0;
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Returns transition of DFA completed by dead state.
+ *
+ * @param dfa   Source DFA.
+ * @param state Source state.
+ * @param cls   Byte class.
+ *
+ * @return Target state.
+ */
+template<std::size_t States, std::size_t Classes>
+constexpr int dfa_complete_next(const dfa<States, Classes>& dfa, int state, int cls) noexcept
+{
+    if (state == static_cast<int>(States))
+        return state;
+
+    const int next = dfa.next[state][cls];
+
+    return next < 0 ? static_cast<int>(States) : next;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Hopcroft's DFA minimization.
+ *
+ * States are split by accepting tags at the beginning and each block
+ * is then used as a splitter for all byte classes. After a block split
+ * only the smaller part is added into the worklist (unless the split
+ * block is already there).
+ *
+ * @param dfa Source DFA.
+ *
+ * @return Partition of equivalent states.
+ */
+template<std::size_t States, std::size_t Classes>
+constexpr dfa_partition<States> make_dfa_partition(const dfa<States, Classes>& dfa) noexcept
+{
+    constexpr int count = static_cast<int>(States) + 1;
+
+    dfa_partition<States> res;
+
+    // Initial partition by accepting tags (dead state is not accepting)
+    unsigned long long tags[States + 1] = {};
+
+    for (int state = 0; state < count; ++state)
+    {
+        const unsigned long long tag = state < count - 1 ? dfa.accept[state] : 0;
+
+        int block = 0;
+
+        while (block < res.count && tags[block] != tag)
+            ++block;
+
+        if (block == res.count)
+            tags[res.count++] = tag;
+
+        res.block_of[state] = block;
+    }
+
+    // All blocks are splitters
+    int worklist[States + 1] = {};
+    bool waiting[States + 1] = {};
+    int top = 0;
+
+    for (int block = 0; block < res.count; ++block)
+    {
+        worklist[top++] = block;
+        waiting[block] = true;
+    }
+
+    while (top > 0)
+    {
+        const int splitter = worklist[--top];
+        waiting[splitter] = false;
+
+        // Splitter content can be changed by splitting
+        bool in_splitter[States + 1] = {};
+
+        for (int state = 0; state < count; ++state)
+            in_splitter[state] = res.block_of[state] == splitter;
+
+        for (std::size_t cls = 0; cls < Classes; ++cls)
+        {
+            // States that goes into splitter
+            bool marked[States + 1] = {};
+            int marked_count[States + 1] = {};
+            int size[States + 1] = {};
+
+            for (int state = 0; state < count; ++state)
+            {
+                ++size[res.block_of[state]];
+
+                if (in_splitter[dfa_complete_next(dfa, state, static_cast<int>(cls))])
+                {
+                    marked[state] = true;
+                    ++marked_count[res.block_of[state]];
+                }
+            }
+
+            // Split blocks
+            const int blocks = res.count;
+            int split[States + 1] = {};
+
+            for (int block = 0; block < blocks; ++block)
+            {
+                split[block] = -1;
+
+                if (marked_count[block] == 0 || marked_count[block] == size[block])
+                    continue;
+
+                split[block] = res.count++;
+
+                const int smaller = 2 * marked_count[block] <= size[block] ? split[block] : block;
+
+                if (waiting[block])
+                {
+                    worklist[top++] = split[block];
+                    waiting[split[block]] = true;
+                }
+                else
+                {
+                    worklist[top++] = smaller;
+                    waiting[smaller] = true;
+                }
+            }
+
+            // Marked states are moved into new block
+            for (int state = 0; state < count; ++state)
+            {
+                if (marked[state] && split[res.block_of[state]] >= 0)
+                    res.block_of[state] = split[res.block_of[state]];
+            }
+        }
+    }
+
+    res.dead = res.block_of[count - 1];
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Creates minimal DFA from DFA.
+ *
+ * Blocks are numbered in order of the first state so the starting state
+ * stays 0. States equivalent to the dead state are removed.
+ *
+ * @tparam Result Result DFA type, `void` for counting only.
+ *
+ * @param dfa Source DFA.
+ * @param res Output DFA.
+ *
+ * @return Number of states.
+ */
+template<std::size_t States, std::size_t Classes, typename Result>
+constexpr std::size_t fill_minimal_dfa(const dfa<States, Classes>& dfa, Result* res) noexcept
+{
+    const dfa_partition<States> partition = make_dfa_partition(dfa);
+
+    // Block number to state number
+    int number[States + 1] = {};
+
+    for (int block = 0; block < partition.count; ++block)
+        number[block] = -1;
+
+    int count = 0;
+
+    for (std::size_t state = 0; state < States; ++state)
+    {
+        const int block = partition.block_of[state];
+
+        if (block != partition.dead && number[block] < 0)
+            number[block] = count++;
+    }
+
+    if (res)
+    {
+        res->classes = dfa.classes;
+
+        for (std::size_t state = 0; state < States; ++state)
+        {
+            const int block = partition.block_of[state];
+
+            if (block == partition.dead)
+                continue;
+
+            const int target = number[block];
+            res->accept[target] = dfa.accept[state];
+
+            for (std::size_t cls = 0; cls < Classes; ++cls)
+            {
+                const int next = dfa.next[state][cls];
+
+                res->next[target][cls] = static_cast<short>(
+                    (next < 0 || partition.block_of[next] == partition.dead)
+                        ? -1
+                        : number[partition.block_of[next]]
+                );
+            }
+        }
+    }
+
+    return static_cast<std::size_t>(count);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Count states of minimal DFA.
+ *
+ * @param dfa Source DFA.
+ *
+ * @return Number of states.
+ */
+template<typename Dfa>
+constexpr std::size_t count_minimal_states(const Dfa& dfa) noexcept
+{
+    return fill_minimal_dfa(dfa, static_cast<::template_regex::rules::dfa<0, 0>*>(nullptr));
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Creates minimal DFA.
+ *
+ * @tparam Result Result DFA type.
+ *
+ * @param dfa Source DFA.
+ *
+ * @return Minimal DFA.
+ */
+template<typename Result, typename Dfa>
+constexpr Result make_minimal_dfa(const Dfa& dfa) noexcept
+{
+    Result res;
+    fill_minimal_dfa(dfa, &res);
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Returns length of the shortest accepted input.
+ *
+ * States are visited by breadth-first search from the starting state.
+ *
+ * @param dfa Source DFA.
+ *
+ * @return Number of values or 0 if no input is accepted.
+ */
+template<std::size_t States, std::size_t Classes>
+constexpr std::size_t dfa_min_length(const dfa<States, Classes>& dfa) noexcept
+{
+    int queue[States > 0 ? States : 1] = {};
+    std::size_t distance[States > 0 ? States : 1] = {};
+    bool visited[States > 0 ? States : 1] = {};
+    std::size_t head = 0;
+    std::size_t tail = 0;
+
+    if (States == 0)
+        return 0;
+
+    queue[tail++] = 0;
+    visited[0] = true;
+
+    while (head < tail)
+    {
+        const int state = queue[head++];
+
+        if (dfa.accept[state])
+            return distance[state];
+
+        for (std::size_t cls = 0; cls < Classes; ++cls)
+        {
+            const int next = dfa.next[state][cls];
+
+            if (next < 0 || visited[next])
+                continue;
+
+            visited[next] = true;
+            distance[next] = distance[state] + 1;
+            queue[tail++] = next;
+        }
+    }
+
+    return 0;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Range of bytes with same transition.
+ */
+struct dfa_range
+{
+    /// The first byte.
+    int low = 0;
+
+    /// The last byte.
+    int high = 0;
+
+    /// Target state.
+    int target = 0;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief DFA transitions stored as byte ranges.
+ *
+ * Ranges of state `S` are stored in [first[S], first[S + 1]).
+ *
+ * @tparam States Number of states.
+ * @tparam Ranges Number of ranges.
+ */
+template<std::size_t States, std::size_t Ranges>
+struct dfa_ranges
+{
+    /// Index of the first range of each state.
+    int first[States + 1] = {};
+
+    /// Ranges.
+    dfa_range ranges[Ranges > 0 ? Ranges : 1];
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Create transition ranges from DFA.
+ *
+ * @tparam Ranges Result type, `void` for counting only.
+ *
+ * @param dfa   Source DFA.
+ * @param res   Output ranges.
+ *
+ * @return Number of ranges.
+ */
+template<typename Dfa, typename Ranges>
+constexpr std::size_t fill_dfa_ranges(const Dfa& dfa, Ranges* res) noexcept
+{
+    std::size_t count = 0;
+
+    for (std::size_t state = 0; state < Dfa::state_count; ++state)
+    {
+        if (res)
+            res->first[state] = static_cast<int>(count);
+
+        int target = -1;
+
+        for (int c = 0; c < 256; ++c)
+        {
+            const int next = dfa.transition(static_cast<int>(state), static_cast<unsigned>(c));
+
+            // Extend current range
+            if (next >= 0 && next == target)
+            {
+                if (res)
+                    res->ranges[count - 1].high = c;
+
+                continue;
+            }
+
+            target = next;
+
+            if (next < 0)
+                continue;
+
+            if (res)
+            {
+                res->ranges[count].low = c;
+                res->ranges[count].high = c;
+                res->ranges[count].target = next;
+            }
+
+            ++count;
+        }
+    }
+
+    if (res)
+        res->first[Dfa::state_count] = static_cast<int>(count);
+
+    return count;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Count transition ranges.
+ *
+ * @param dfa Source DFA.
+ *
+ * @return Number of ranges.
+ */
+template<typename Dfa>
+constexpr std::size_t count_dfa_ranges(const Dfa& dfa) noexcept
+{
+    return fill_dfa_ranges(dfa, static_cast<dfa_ranges<0, 0>*>(nullptr));
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Create transition ranges from DFA.
+ *
+ * @tparam Ranges Result type.
+ *
+ * @param dfa Source DFA.
+ *
+ * @return Ranges.
+ */
+template<typename Ranges, typename Dfa>
+constexpr Ranges make_dfa_ranges(const Dfa& dfa) noexcept
+{
+    Ranges res;
+    fill_dfa_ranges(dfa, &res);
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Compile-time automaton data for given rule.
+ *
+ * @tparam Rule Source rule.
+ */
+template<typename Rule>
+struct automaton_data
+{
+    static_assert(nfa_traits<Rule>::supported, "Rule cannot be converted into automaton");
+
+
+    /// Thompson NFA.
+    static constexpr nfa_type<Rule> nfa_value = make_nfa<Rule>();
+
+    /// Byte classes.
+    static constexpr byte_classes classes = make_byte_classes(nfa_value);
+
+    /// Number of DFA states created by subset construction.
+    static constexpr std::size_t states_before = count_dfa_states(nfa_value, classes);
+
+    static_assert(states_before < TEMPLATE_REGEX_AUTOMATON_MAX_STATES, "Too many DFA states");
+
+    /// DFA created by subset construction.
+    static constexpr dfa<states_before, static_cast<std::size_t>(classes.count)> subset_value =
+        make_dfa<dfa<states_before, static_cast<std::size_t>(classes.count)>>(nfa_value, classes);
+
+    /// Number of minimal DFA states.
+    static constexpr std::size_t states = count_minimal_states(subset_value);
+
+    /// DFA type.
+    using dfa_type = dfa<states, static_cast<std::size_t>(classes.count)>;
+
+    /// Minimal DFA.
+    static constexpr dfa_type value = make_minimal_dfa<dfa_type>(subset_value);
+
+    /// Length of the shortest accepted input.
+    static constexpr std::size_t min_length = dfa_min_length(value);
+
+    /// Transition ranges type.
+    using ranges_type = dfa_ranges<states, count_dfa_ranges(value)>;
+
+    /// Transition ranges.
+    static constexpr ranges_type ranges = make_dfa_ranges<ranges_type>(value);
+};
+
+/* ************************************************************************ */
+
+template<typename Rule>
+constexpr nfa_type<Rule> automaton_data<Rule>::nfa_value;
+
+template<typename Rule>
+constexpr byte_classes automaton_data<Rule>::classes;
+
+template<typename Rule>
+constexpr typename automaton_data<Rule>::dfa_type automaton_data<Rule>::value;
+
+template<typename Rule>
+constexpr typename automaton_data<Rule>::ranges_type automaton_data<Rule>::ranges;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Generated code for transitions of one state.
+ *
+ * Ranges are tested in order and the first matching one is used.
+ *
+ * @tparam Data  Automaton data.
+ * @tparam Range Current range.
+ * @tparam Last  Range after the last range of the state.
+ */
+template<typename Data, int Range, int Last>
+struct automaton_transition
+{
+    /**
+     * @brief Returns next state.
+     *
+     * @param c Input byte.
+     *
+     * @return Next state or -1.
+     */
+    static int next(unsigned c) noexcept
+    {
+        constexpr int low = Data::ranges.ranges[Range].low;
+        constexpr int high = Data::ranges.ranges[Range].high;
+
+        return (c - low <= static_cast<unsigned>(high - low))
+            ? Data::ranges.ranges[Range].target
+            : automaton_transition<Data, Range + 1, Last>::next(c)
+        ;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Stop specialization - no transition.
+ */
+template<typename Data, int Last>
+struct automaton_transition<Data, Last, Last>
+{
+    static int next(unsigned c) noexcept
+    {
+        return -1;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Generated code for state dispatching.
+ *
+ * @tparam Data  Automaton data.
+ * @tparam State Current state.
+ * @tparam Count Number of states.
+ */
+template<typename Data, int State, int Count>
+struct automaton_state
+{
+    /**
+     * @brief Returns next state.
+     *
+     * @param state Current state.
+     * @param c     Input byte.
+     *
+     * @return Next state or -1.
+     */
+    static int next(int state, unsigned c) noexcept
+    {
+        return (state == State)
+            ? automaton_transition<Data,
+                Data::ranges.first[State],
+                Data::ranges.first[State + 1]
+              >::next(c)
+            : automaton_state<Data, State + 1, Count>::next(state, c)
+        ;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Stop specialization - invalid state.
+ */
+template<typename Data, int Count>
+struct automaton_state<Data, Count, Count>
+{
+    static int next(int state, unsigned c) noexcept
+    {
+        return -1;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Maximum number of states dispatched by single comparison chain.
+ */
+constexpr int automaton_chain_states = 8;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Generated code for dispatching of many states.
+ *
+ * Large automatons (e.g. counted repetitions where states count the
+ * repetitions) are split into halves by state number until parts are
+ * small enough for comparison chain.
+ *
+ * @tparam Data  Automaton data.
+ * @tparam First The first state.
+ * @tparam Last  State after the last state.
+ * @tparam Chain If states are dispatched by comparison chain.
+ */
+template<typename Data, int First, int Last,
+    bool Chain = (Last - First <= automaton_chain_states)>
+struct automaton_dispatch
+{
+    /**
+     * @brief Returns next state.
+     *
+     * @param state Current state.
+     * @param c     Input byte.
+     *
+     * @return Next state or -1.
+     */
+    static int next(int state, unsigned c) noexcept
+    {
+        constexpr int middle = (First + Last) / 2;
+
+        return (state < middle)
+            ? automaton_dispatch<Data, First, middle>::next(state, c)
+            : automaton_dispatch<Data, middle, Last>::next(state, c)
+        ;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for comparison chain.
+ */
+template<typename Data, int First, int Last>
+struct automaton_dispatch<Data, First, Last, true> : automaton_state<Data, First, Last> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Automaton backend that generates code for transitions.
+ *
+ * Transitions of each state are tested as a chain of range comparisons
+ * and the states are dispatched by comparison chain that compilers
+ * usually turn into a jump table. Automatons with more than
+ * `automaton_chain_states` states are dispatched by binary search.
+ */
+struct code_backend
+{
+
+    /**
+     * @brief State machine for given rule.
+     *
+     * @tparam Rule Source rule.
+     */
+    template<typename Rule>
+    struct machine
+    {
+        /// Automaton data.
+        using data = automaton_data<Rule>;
+
+        /// State type.
+        using state_type = int;
+
+
+        /// Starting state.
+        static constexpr state_type start = 0;
+
+
+        /**
+         * @brief Returns next state.
+         *
+         * @param state Current state.
+         * @param c     Input byte.
+         *
+         * @return Next state.
+         */
+        static state_type next(state_type state, unsigned c) noexcept
+        {
+            return automaton_dispatch<data, 0, static_cast<int>(data::states)>::next(state, c);
+        }
+
+
+        /**
+         * @brief Returns if state is the dead state.
+         *
+         * @param state Tested state.
+         */
+        static constexpr bool dead(state_type state) noexcept
+        {
+            return state < 0;
+        }
+
+
+        /**
+         * @brief Returns if state is accepting.
+         *
+         * @param state Tested state (cannot be the dead state).
+         */
+        static bool accepting(state_type state) noexcept
+        {
+            return data::value.accept[state] != 0;
+        }
+    };
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief DFA transition table.
+ *
+ * Transitions are indexed by byte class and the dead state is stored
+ * as the last state with all transitions into itself.
+ *
+ * @tparam State   State type.
+ * @tparam States  Number of states including the dead state.
+ * @tparam Classes Number of byte classes.
+ */
+template<typename State, std::size_t States, std::size_t Classes>
+struct dfa_table
+{
+
+    /// State type.
+    using state_type = State;
+
+    /// Class of each byte.
+    unsigned char class_of[256] = {};
+
+    /// Transitions.
+    State next[States][Classes] = {};
+
+    /// Accepting states.
+    bool accept[States] = {};
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Merge byte classes that have same transitions in all states.
+ *
+ * Minimization can make some byte classes equivalent.
+ *
+ * @param dfa     Source DFA.
+ * @param mapping Output mapping from DFA class to table class, can be
+ *                nullptr.
+ *
+ * @return Number of classes.
+ */
+template<std::size_t States, std::size_t Classes>
+constexpr std::size_t merge_dfa_classes(const dfa<States, Classes>& dfa, int* mapping) noexcept
+{
+    int first[Classes > 0 ? Classes : 1] = {};
+    std::size_t count = 0;
+
+    for (std::size_t cls = 0; cls < Classes; ++cls)
+    {
+        std::size_t found = count;
+
+        for (std::size_t other = 0; other < count && found == count; ++other)
+        {
+            bool same = true;
+
+            for (std::size_t state = 0; state < States && same; ++state)
+                same = dfa.next[state][cls] == dfa.next[state][first[other]];
+
+            if (same)
+                found = other;
+        }
+
+        if (found == count)
+            first[count++] = static_cast<int>(cls);
+
+        if (mapping)
+            mapping[cls] = static_cast<int>(found);
+    }
+
+    return count;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Create transition table from DFA.
+ *
+ * @tparam Table Result table type.
+ *
+ * @param dfa Source DFA.
+ *
+ * @return Transition table.
+ */
+template<typename Table, std::size_t States, std::size_t Classes>
+constexpr Table make_dfa_table(const dfa<States, Classes>& dfa) noexcept
+{
+    int mapping[Classes > 0 ? Classes : 1] = {};
+    merge_dfa_classes(dfa, mapping);
+
+    Table res;
+
+    for (int c = 0; c < 256; ++c)
+        res.class_of[c] = static_cast<unsigned char>(mapping[dfa.classes.class_of[c]]);
+
+    for (std::size_t state = 0; state <= States; ++state)
+    {
+        res.accept[state] = state < States && dfa.accept[state] != 0;
+
+        for (std::size_t cls = 0; cls < Classes; ++cls)
+        {
+            const int next = state < States ? dfa.next[state][cls] : -1;
+
+            res.next[state][mapping[cls]] = static_cast<typename Table::state_type>(
+                next < 0 ? States : static_cast<std::size_t>(next)
+            );
+        }
+    }
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Compile-time transition table for given rule.
+ *
+ * @tparam Rule Source rule.
+ */
+template<typename Rule>
+struct automaton_table
+{
+    /// Automaton data.
+    using data = automaton_data<Rule>;
+
+    /// Number of states including the dead state.
+    static constexpr std::size_t states = data::states + 1;
+
+    /// Number of byte classes.
+    static constexpr std::size_t classes = merge_dfa_classes(data::value, nullptr);
+
+    /// State type.
+    using state_type = typename std::conditional<(states <= 256),
+        unsigned char,
+        unsigned short
+    >::type;
+
+    /// Table type.
+    using table_type = dfa_table<state_type, states, classes>;
+
+    /// Transition table.
+    static constexpr table_type value = make_dfa_table<table_type>(data::value);
+};
+
+/* ************************************************************************ */
+
+template<typename Rule>
+constexpr typename automaton_table<Rule>::table_type automaton_table<Rule>::value;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Automaton backend that uses transition tables.
+ *
+ * Each input byte costs two loads: byte class and transition.
+ */
+struct table_backend
+{
+
+    /**
+     * @brief State machine for given rule.
+     *
+     * @tparam Rule Source rule.
+     */
+    template<typename Rule>
+    struct machine
+    {
+        /// Transition table.
+        using table = automaton_table<Rule>;
+
+        /// State type.
+        using state_type = typename table::state_type;
+
+
+        /// Starting state.
+        static constexpr state_type start = 0;
+
+
+        /**
+         * @brief Returns next state.
+         *
+         * @param state Current state.
+         * @param c     Input byte.
+         *
+         * @return Next state.
+         */
+        static state_type next(state_type state, unsigned c) noexcept
+        {
+            return table::value.next[state][table::value.class_of[c]];
+        }
+
+
+        /**
+         * @brief Returns if state is the dead state.
+         *
+         * @param state Tested state.
+         */
+        static constexpr bool dead(state_type state) noexcept
+        {
+            return state == table::states - 1;
+        }
+
+
+        /**
+         * @brief Returns if state is accepting.
+         *
+         * @param state Tested state.
+         */
+        static bool accepting(state_type state) noexcept
+        {
+            return table::value.accept[state];
+        }
+    };
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rule that matches input by DFA created from inner rule.
+ *
+ * The automaton matches the longest possible input. Outputs of the inner
+ * rule are not supported.
+ *
+ * @tparam Rule    Inner rule.
+ * @tparam Full    If the whole input must be matched.
+ * @tparam Backend Automaton backend.
+ */
+template<typename Rule, bool Full = false, typename Backend = code_backend>
+struct automaton : matcher<automaton<Rule, Full, Backend>>
+{
+
+    /// A number of outputs in the rule.
+    static const unsigned output_count = 0;
+
+    /// State machine.
+    using machine = typename Backend::template machine<Rule>;
+
+    /// State type.
+    using state_type = typename machine::state_type;
+
+    /// Length of the shortest match.
+    static constexpr std::size_t min_length = automaton_data<Rule>::min_length;
+
+
+    /**
+     * @brief Returns next state.
+     *
+     * @param state Current state.
+     * @param value Input value.
+     *
+     * @return Next state.
+     */
+    template<typename Value>
+    static state_type next(state_type state, Value value) noexcept
+    {
+        static_assert(sizeof(Value) == 1, "Automaton requires single byte values");
+
+        return machine::next(state, static_cast<unsigned char>(value));
+    }
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    {
+        return match_impl(it, end, std::integral_constant<bool, Full>{});
+    }
+
+
+    /**
+     * @brief Returns if any prefix of the input is matched.
+     *
+     * Matching stops at the first accepting state.
+     *
+     * @param it  An iterator to the first value.
+     * @param end An iterator to the value following the last valid value.
+     *
+     * @return If a prefix was matched.
+     */
+    template<typename Iterator>
+    static bool match_any(Iterator it, const Iterator end)
+    {
+        return match_shortest(it, end);
+    }
+
+
+    /**
+     * @brief Match the shortest prefix.
+     *
+     * Matching stops at the first accepting state.
+     *
+     * @param it  An iterator to the first value. At the end it refers to
+     *            the value following the match.
+     * @param end An iterator to the value following the last valid value.
+     *
+     * @return If a prefix was matched.
+     */
+    template<typename Iterator>
+    static bool match_shortest(Iterator& it, const Iterator end)
+    {
+        state_type state = machine::start;
+
+        if (machine::accepting(state))
+            return true;
+
+        for (; it != end; )
+        {
+            state = next(state, *it);
+
+            if (machine::dead(state))
+                return false;
+
+            ++it;
+
+            if (machine::accepting(state))
+                return true;
+        }
+
+        return false;
+    }
+
+
+    /**
+     * @brief Match the whole input.
+     */
+    template<typename Iterator>
+    static bool match_impl(Iterator& it, const Iterator end, std::true_type)
+    {
+        state_type state = machine::start;
+
+        if (!match_required(state, it, end, _random_access<Iterator>{}))
+            return false;
+
+        for (; it != end; ++it)
+        {
+            state = next(state, *it);
+
+            if (machine::dead(state))
+                return false;
+        }
+
+        return machine::accepting(state);
+    }
+
+
+    /**
+     * @brief Match the longest prefix.
+     */
+    template<typename Iterator>
+    static bool match_impl(Iterator& it, const Iterator end, std::false_type)
+    {
+        static_assert(!std::is_same<
+            typename std::iterator_traits<Iterator>::iterator_category,
+            std::input_iterator_tag
+        >::value, "automaton rule require forward_iterator at least");
+
+        state_type state = machine::start;
+        Iterator cur = it;
+
+        if (!match_required(state, cur, end, _random_access<Iterator>{}))
+            return false;
+
+        bool matched = machine::accepting(state);
+        Iterator last = cur;
+
+        while (cur != end)
+        {
+            state = next(state, *cur);
+
+            if (machine::dead(state))
+                break;
+
+            ++cur;
+
+            if (machine::accepting(state))
+            {
+                matched = true;
+                last = cur;
+            }
+        }
+
+        if (matched)
+            it = last;
+
+        return matched;
+    }
+
+
+// Private Types
+private:
+
+
+    /// If input length is known without reading the input.
+    template<typename Iterator>
+    using _random_access = std::integral_constant<bool, std::is_same<
+        typename std::iterator_traits<Iterator>::iterator_category,
+        std::random_access_iterator_tag
+    >::value>;
+
+
+// Private Operations
+private:
+
+
+    /**
+     * @brief Read values required by the shortest match.
+     *
+     * The input length is checked once so the values are read without
+     * end checks. No state before the shortest match can be accepting.
+     *
+     * @param state Current state.
+     * @param it    Input iterator.
+     * @param end   An iterator to the value following the last valid value.
+     *
+     * @return If the input can be matched.
+     */
+    template<typename Iterator>
+    static bool match_required(state_type& state, Iterator& it, const Iterator end, std::true_type)
+    {
+        if (end - it < static_cast<typename std::iterator_traits<Iterator>::difference_type>(min_length))
+            return false;
+
+        for (std::size_t i = 0; i < min_length; ++i, ++it)
+        {
+            state = next(state, *it);
+
+            if (machine::dead(state))
+                return false;
+        }
+
+        return true;
+    }
+
+
+    /**
+     * @brief Input length is unknown, values are read by main loop.
+     */
+    template<typename Iterator>
+    static bool match_required(state_type& state, Iterator& it, const Iterator end, std::false_type)
+    {
+        return true;
+    }
+
+};
+
+/* ************************************************************************ */
+
+template<typename Rule, bool Full, typename Backend>
+constexpr std::size_t automaton<Rule, Full, Backend>::min_length;
+
+/* ************************************************************************ */
+
+/**
+ * @brief NFA transitions grouped by source state.
+ *
+ * Transitions of each state keep the building order, so the first one has
+ * the highest priority: repetition before skipping it, alternatives from
+ * the first one.
+ *
+ * @tparam States Maximum number of NFA states.
+ * @tparam Edges  Maximum number of NFA transitions.
+ */
+template<std::size_t States, std::size_t Edges>
+struct nfa_order
+{
+    /// Index of the first transition of each state in `edges`.
+    int first[States + 1] = {};
+
+    /// Transitions grouped by source state.
+    int edges[Edges > 0 ? Edges : 1] = {};
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Group NFA transitions by source state.
+ *
+ * @param nfa Source NFA.
+ *
+ * @return Grouped transitions.
+ */
+template<std::size_t States, std::size_t Edges>
+constexpr nfa_order<States, Edges> make_nfa_order(const nfa<States, Edges>& nfa) noexcept
+{
+    nfa_order<States, Edges> res;
+
+    for (int i = 0; i < nfa.edge_count; ++i)
+        ++res.first[nfa.edges[i].from + 1];
+
+    for (std::size_t state = 0; state < States; ++state)
+        res.first[state + 1] += res.first[state];
+
+    int fill[States > 0 ? States : 1] = {};
+
+    for (int i = 0; i < nfa.edge_count; ++i)
+        res.edges[res.first[nfa.edges[i].from] + fill[nfa.edges[i].from]++] = i;
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Simulation of NFA over input.
+ *
+ * Threads of all NFA paths are moved by each input value at once, so the
+ * input is read once and each value costs at most one step of each NFA
+ * state. No DFA is created, so it works for rules with too many DFA states.
+ *
+ * Threads are kept in order of priority and they can carry submatch
+ * slots, so the same simulation finds group positions (Pike VM).
+ *
+ * @tparam Rule Source rule.
+ */
+template<typename Rule>
+struct nfa_simulation
+{
+    static_assert(nfa_traits<Rule>::supported, "Rule cannot be converted into automaton");
+
+
+    /// Maximum number of NFA states.
+    static constexpr std::size_t states = nfa_traits<Rule>::states;
+
+    /// Maximum number of NFA transitions.
+    static constexpr std::size_t edges = nfa_traits<Rule>::edges;
+
+    /// Closure stack size, each transition pushes its state and restored slot.
+    static constexpr std::size_t stack_size = 2 * edges + 1;
+
+    /// Thompson NFA.
+    static constexpr nfa_type<Rule> nfa_value = make_nfa<Rule>();
+
+    /// Transitions grouped by source state.
+    static constexpr nfa_order<states, edges> order = make_nfa_order(nfa_value);
+
+
+    /**
+     * @brief Ordered set of threads.
+     *
+     * The set is sparse so it's cleared and tested in constant time.
+     *
+     * @tparam Iterator Input iterator.
+     * @tparam Slots    Number of submatch slots of each thread.
+     */
+    template<typename Iterator, std::size_t Slots>
+    struct threads
+    {
+        /// Number of threads.
+        int count = 0;
+
+        /// If any thread is in accepting state.
+        bool accept = false;
+
+        /// States of threads in order of priority.
+        int state[states] = {};
+
+        /// Index of each state in `state`.
+        int index[states] = {};
+
+        /// Slots of threads, `Slots` items for each thread.
+        Iterator* slots = nullptr;
+
+
+        /**
+         * @brief Returns if state has a thread.
+         */
+        bool contains(int value) const noexcept
+        {
+            return index[value] < count && state[index[value]] == value;
+        }
+
+
+        /**
+         * @brief Remove all threads.
+         */
+        void clear() noexcept
+        {
+            count = 0;
+            accept = false;
+        }
+    };
+
+
+    /**
+     * @brief Closure stack item.
+     *
+     * @tparam Iterator Input iterator.
+     */
+    template<typename Iterator>
+    struct frame
+    {
+        /// Followed state or -1 when slot is restored.
+        int state;
+
+        /// Slot stored by transition into the state or restored slot.
+        int slot;
+
+        /// Restored slot value.
+        Iterator value;
+    };
+
+
+    /**
+     * @brief Add thread and threads reachable by epsilon transitions.
+     *
+     * Transitions are followed depth-first in order of priority by explicit
+     * stack and states that already have a thread are skipped. Slot of
+     * transition is stored when its state is followed and restored when
+     * all states reachable from it are added.
+     *
+     * @param list  Threads.
+     * @param state Added state.
+     * @param pos   Current input position.
+     * @param slots Slots of the added thread, unchanged at the end.
+     * @param stack Closure stack with `stack_size` items.
+     */
+    template<typename Iterator, std::size_t Slots>
+    static void add(threads<Iterator, Slots>& list, int state, const Iterator pos,
+        Iterator* slots, frame<Iterator>* stack)
+    {
+        int top = 0;
+        stack[top++] = {state, -1, pos};
+
+        while (top > 0)
+        {
+            const frame<Iterator> current = stack[--top];
+
+            if (current.state < 0)
+            {
+                slots[current.slot] = current.value;
+                continue;
+            }
+
+            if (list.contains(current.state))
+                continue;
+
+            if (current.slot >= 0 && static_cast<std::size_t>(current.slot) < Slots)
+            {
+                stack[top++] = {-1, current.slot, slots[current.slot]};
+                slots[current.slot] = pos;
+            }
+
+            list.index[current.state] = list.count;
+            list.state[list.count] = current.state;
+            std::copy(slots, slots + Slots, list.slots + list.count * Slots);
+            list.accept = list.accept || nfa_value.accept[current.state] != 0;
+            ++list.count;
+
+            // Pushed backwards so the first transition is followed first
+            for (int i = order.first[current.state + 1]; i-- > order.first[current.state]; )
+            {
+                const nfa_edge& edge = nfa_value.edges[order.edges[i]];
+
+                if (edge.epsilon)
+                    stack[top++] = {edge.to, edge.slot, pos};
+            }
+        }
+    }
+
+
+    /**
+     * @brief Move thread by input value.
+     *
+     * @param from  Current threads.
+     * @param index Index of moved thread.
+     * @param to    Threads after the value.
+     * @param value Input value.
+     * @param pos   Position after the value.
+     * @param slots Scratch slots.
+     * @param stack Closure stack with `stack_size` items.
+     */
+    template<typename Iterator, std::size_t Slots, typename Value>
+    static void step(const threads<Iterator, Slots>& from, int index, threads<Iterator, Slots>& to,
+        Value value, const Iterator pos, Iterator* slots, frame<Iterator>* stack)
+    {
+        const int state = from.state[index];
+
+        for (int i = order.first[state]; i < order.first[state + 1]; ++i)
+        {
+            const nfa_edge& edge = nfa_value.edges[order.edges[i]];
+
+            if (edge.epsilon || !allows(edge, value))
+                continue;
+
+            std::copy(from.slots + index * Slots, from.slots + (index + 1) * Slots, slots);
+            add(to, edge.to, pos, slots, stack);
+        }
+    }
+
+
+    /**
+     * @brief Returns if byte transition allows value.
+     *
+     * Bytes are tested by transition bytes, wider values by class rule.
+     */
+    template<typename Value>
+    static bool allows(const nfa_edge& edge, Value value)
+    {
+        return sizeof(Value) == 1
+            ? edge.set.test(static_cast<unsigned char>(value))
+            : edge.test(static_cast<int>(value))
+        ;
+    }
+
+};
+
+/* ************************************************************************ */
+
+template<typename Rule>
+constexpr std::size_t nfa_simulation<Rule>::stack_size;
+
+template<typename Rule>
+constexpr nfa_type<Rule> nfa_simulation<Rule>::nfa_value;
+
+template<typename Rule>
+constexpr nfa_order<nfa_simulation<Rule>::states, nfa_simulation<Rule>::edges> nfa_simulation<Rule>::order;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rule that matches input by NFA simulation.
+ *
+ * It's used instead of `automaton` when the DFA would have too many states.
+ * It matches the same inputs as the automaton would (the longest possible
+ * input) in a single scan, but each value moves all NFA threads.
+ *
+ * @tparam Rule Inner rule.
+ * @tparam Full If the whole input must be matched.
+ */
+template<typename Rule, bool Full = false>
+struct nfa_automaton : matcher<nfa_automaton<Rule, Full>>
+{
+
+    /// A number of outputs in the rule.
+    static const unsigned output_count = 0;
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    {
+        Iterator last = it;
+
+        if (!run(it, end, last, false) || (Full && last != end))
+            return false;
+
+        it = last;
+
+        return true;
+    }
+
+
+    /**
+     * @brief Returns if any prefix of the input is matched.
+     *
+     * @param it  An iterator to the first value.
+     * @param end An iterator to the value following the last valid value.
+     *
+     * @return If a prefix was matched.
+     */
+    template<typename Iterator>
+    static bool match_any(Iterator it, const Iterator end)
+    {
+        return match_shortest(it, end);
+    }
+
+
+    /**
+     * @brief Match the shortest prefix.
+     *
+     * @param it  An iterator to the first value. At the end it refers to
+     *            the value following the match.
+     * @param end An iterator to the value following the last valid value.
+     *
+     * @return If a prefix was matched.
+     */
+    template<typename Iterator>
+    static bool match_shortest(Iterator& it, const Iterator end)
+    {
+        Iterator last = it;
+
+        if (!run(it, end, last, true))
+            return false;
+
+        it = last;
+
+        return true;
+    }
+
+
+// Private Types
+private:
+
+
+    /// NFA simulation.
+    using _simulation = nfa_simulation<Rule>;
+
+
+// Private Operations
+private:
+
+
+    /**
+     * @brief Run simulation until all threads are finished.
+     *
+     * @param it       An iterator to the first value.
+     * @param end      An iterator to the value following the last valid value.
+     * @param last     Position after the match.
+     * @param shortest If simulation stops at the first match.
+     *
+     * @return If a prefix was matched.
+     */
+    template<typename Iterator>
+    static bool run(Iterator it, const Iterator end, Iterator& last, bool shortest)
+    {
+        using threads = typename _simulation::template threads<Iterator, 0>;
+        using frame = typename _simulation::template frame<Iterator>;
+
+        threads lists[2];
+        threads* current = &lists[0];
+        threads* next = &lists[1];
+        frame stack[_simulation::stack_size];
+
+        _simulation::add(*current, _simulation::nfa_value.start, it, static_cast<Iterator*>(nullptr), stack);
+
+        bool matched = false;
+
+        for (;;)
+        {
+            if (current->accept)
+            {
+                matched = true;
+                last = it;
+
+                if (shortest)
+                    break;
+            }
+
+            if (it == end || current->count == 0)
+                break;
+
+            const auto value = *it;
+            ++it;
+
+            next->clear();
+
+            for (int i = 0; i < current->count; ++i)
+                _simulation::step(*current, i, *next, value, it, static_cast<Iterator*>(nullptr), stack);
+
+            std::swap(current, next);
+        }
+
+        return matched;
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Number of automaton states used by rule.
+ *
+ * Rules that are not automatons doesn't have any states.
+ *
+ * @tparam Rule Tested rule.
+ */
+template<typename Rule>
+struct automaton_states
+{
+    /// Number of states after subset construction.
+    static constexpr std::size_t before = 0;
+
+    /// Number of states after minimization.
+    static constexpr std::size_t after = 0;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `automaton`.
+ */
+template<typename Rule, bool Full, typename Backend>
+struct automaton_states<automaton<Rule, Full, Backend>>
+{
+    static constexpr std::size_t before = automaton_data<Rule>::states_before;
+    static constexpr std::size_t after = automaton_data<Rule>::states;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief If rule can be compiled into automaton.
+ *
+ * The rule must be supported by NFA and its DFA must have less than
+ * TEMPLATE_REGEX_AUTOMATON_MAX_STATES states.
+ *
+ * @tparam Rule      Source rule.
+ * @tparam Supported If rule is supported by NFA.
+ */
+template<typename Rule, bool Supported = nfa_traits<Rule>::supported>
+struct automaton_fits : std::false_type {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for rules supported by NFA.
+ */
+template<typename Rule>
+struct automaton_fits<Rule, true> : std::integral_constant<bool,
+    count_rule_dfa_states<Rule>() < TEMPLATE_REGEX_AUTOMATON_MAX_STATES
+> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Automaton of rule without anchors.
+ *
+ * Rule with too large DFA is matched by NFA simulation when it's allowed,
+ * otherwise the automaton fails with "Too many DFA states".
+ *
+ * @tparam Rule     Source rule.
+ * @tparam Full     If the whole input must be matched.
+ * @tparam Backend  Automaton backend.
+ * @tparam Simulate If NFA simulation can be used.
+ * @tparam Nested   Rule used when rule cannot be converted into NFA.
+ */
+template<typename Rule, bool Full, typename Backend, bool Simulate, typename Nested>
+struct automaton_rule
+{
+    using type = typename std::conditional<!nfa_traits<Rule>::supported,
+        Nested,
+        typename std::conditional<!Simulate || automaton_fits<Rule>::value,
+            automaton<Rule, Full, Backend>,
+            nfa_automaton<Rule, Full>
+        >::type
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Replaces rule by automaton if it's possible.
+ *
+ * Anchors are moved outside of the automaton. Rules with too large DFA
+ * are matched by NFA simulation if `Simulate` is set.
+ *
+ * @tparam Rule     Source rule.
+ * @tparam Backend  Automaton backend.
+ * @tparam Simulate If NFA simulation can be used.
+ */
+template<typename Rule, typename Backend = code_backend, bool Simulate = true>
+struct make_automaton : automaton_rule<Rule, false, Backend, Simulate, Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin`.
+ */
+template<typename Rule, typename Backend, bool Simulate>
+struct make_automaton<begin<Rule>, Backend, Simulate>
+    : automaton_rule<Rule, false, Backend, Simulate, begin<Rule>> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `end`.
+ */
+template<typename Rule, typename Backend, bool Simulate>
+struct make_automaton<end<Rule>, Backend, Simulate>
+    : automaton_rule<Rule, true, Backend, Simulate, end<Rule>> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin_end`.
+ */
+template<typename Rule, typename Backend, bool Simulate>
+struct make_automaton<begin_end<Rule>, Backend, Simulate>
+    : automaton_rule<Rule, true, Backend, Simulate, begin_end<Rule>> {};
+
+/* ************************************************************************ */
+
+}
+}
+
+/* ************************************************************************ */
@@ -0,0 +1,372 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file lexer.hpp
+ *
+ * This header contains lexer that matches the longest token from list
+ * of items by single automaton.
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+// Library
+#include "rules.hpp"
+#include "automaton.hpp"
+#include "simd.hpp"
+
+/* ************************************************************************ */
+
+namespace template_regex {
+namespace rules {
+
+/* ************************************************************************ */
+
+/**
+ * @brief Transition table of lexer automaton.
+ *
+ * Transitions are stored by byte class so the column offset doesn't
+ * depend on the current state and the state is just added to it. States
+ * are ordered so accepting states are just before the dead state and the
+ * matching loop tests only state number.
+ *
+ * @tparam State   State type.
+ * @tparam States  Number of states including the dead state.
+ * @tparam Classes Number of byte classes.
+ */
+template<typename State, std::size_t States, std::size_t Classes>
+struct lexer_table
+{
+    /// State type.
+    using state_type = State;
+
+    /// Offset of transitions column for each byte.
+    unsigned short column[256] = {};
+
+    /// Transitions by byte class and state.
+    State next[Classes * States] = {};
+
+    /// Starting state.
+    State start = 0;
+
+    /// The first accepting state.
+    State accepting = 0;
+
+    /// Index of matched item + 1 for each state, 0 for not accepting.
+    unsigned char token[States] = {};
+
+    /// Bytes of transition into itself for each state.
+    simd::byte_class loop_class[States];
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Create lexer transition table from DFA.
+ *
+ * Accepting state of multiple items returns the first of them.
+ *
+ * @tparam Table  Result table type.
+ * @tparam Merged Transition table with the dead state.
+ *
+ * @param dfa   Source DFA.
+ * @param table Transition table of DFA.
+ *
+ * @return Lexer transition table.
+ */
+template<typename Table, typename Merged, std::size_t States, std::size_t Classes>
+constexpr Table make_lexer_table(const dfa<States, Classes>& dfa, const Merged& table) noexcept
+{
+    using state_type = typename Table::state_type;
+
+    // Not accepting states first
+    std::size_t order[States + 1] = {};
+    std::size_t count = 0;
+
+    for (std::size_t state = 0; state < States; ++state)
+    {
+        if (!dfa.accept[state])
+            order[state] = count++;
+    }
+
+    Table res;
+    res.accepting = static_cast<state_type>(count);
+
+    for (std::size_t state = 0; state < States; ++state)
+    {
+        if (dfa.accept[state])
+            order[state] = count++;
+    }
+
+    order[States] = States;
+    res.start = static_cast<state_type>(order[0]);
+
+    for (int c = 0; c < 256; ++c)
+        res.column[c] = static_cast<unsigned short>(table.class_of[c] * (States + 1));
+
+    for (std::size_t state = 0; state <= States; ++state)
+    {
+        const std::size_t target = order[state];
+
+        for (std::size_t cls = 0; cls * (States + 1) < sizeof(res.next) / sizeof(state_type); ++cls)
+        {
+            res.next[cls * (States + 1) + target] =
+                static_cast<state_type>(order[table.next[state][cls]]);
+        }
+
+        unsigned long long bits[4] = {};
+
+        for (unsigned c = 0; state < States && c < 256; ++c)
+        {
+            if (table.next[state][table.class_of[c]] == state)
+                bits[c >> 6] |= 1ull << (c & 63);
+        }
+
+        res.loop_class[target] = simd::byte_class(bits[0], bits[1], bits[2], bits[3]);
+
+        for (unsigned index = 0; state < States && index < 64; ++index)
+        {
+            if ((dfa.accept[state] >> index) & 1)
+            {
+                res.token[target] = static_cast<unsigned char>(index + 1);
+                break;
+            }
+        }
+    }
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Lexer automaton of items.
+ *
+ * @tparam Items List items.
+ */
+template<typename... Items>
+struct lexer_automaton
+{
+    /// Automaton data.
+    using data = automaton_data<tagged_alternative<typename Items::rule...>>;
+
+    /// Number of states including the dead state.
+    static constexpr std::size_t states = data::states + 1;
+
+    /// Number of byte classes.
+    static constexpr std::size_t classes = merge_dfa_classes(data::value, nullptr);
+
+    /// State type.
+    using state_type = typename std::conditional<(states <= 256),
+        unsigned char,
+        unsigned short
+    >::type;
+
+    /// Table type.
+    using table_type = lexer_table<state_type, states, classes>;
+
+    /// Transition table.
+    static constexpr table_type value = make_lexer_table<table_type>(data::value,
+        make_dfa_table<dfa_table<state_type, states, classes>>(data::value));
+};
+
+/* ************************************************************************ */
+
+template<typename... Items>
+constexpr typename lexer_automaton<Items...>::table_type lexer_automaton<Items...>::value;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Lexer that returns the longest token.
+ *
+ * Unlike `list` that returns the first matched item, the lexer returns
+ * the item that matches the longest part of the input. If multiple items
+ * match the same length, the first of them is returned. All item rules are
+ * merged into single automaton with accepting states tagged by items so
+ * the input is read only once. The merged automaton must have less than
+ * TEMPLATE_REGEX_AUTOMATON_MAX_STATES states.
+ *
+ * @tparam Items List items (`item`), at most 64.
+ */
+template<typename... Items>
+struct lexer
+{
+
+// Pre-conditions
+private:
+
+
+    static_assert(sizeof...(Items) > 0, "Lexer requires at least one item");
+    static_assert(sizeof...(Items) <= 64, "Lexer supports at most 64 items");
+    static_assert(automaton_fits<tagged_alternative<typename Items::rule...>>::value,
+        "Lexer automaton has too many states (TEMPLATE_REGEX_AUTOMATON_MAX_STATES)");
+
+
+// Private Types
+private:
+
+
+    /// Automaton.
+    using _automaton = lexer_automaton<Items...>;
+
+    /// State type.
+    using state_type = typename _automaton::state_type;
+
+    /// The dead state.
+    static constexpr state_type dead = _automaton::states - 1;
+
+    /// The first accepting state.
+    static constexpr state_type accepting = _automaton::value.accepting;
+
+
+// Public Operations
+public:
+
+
+    /**
+     * @brief Match the longest token.
+     *
+     * @param it  An iterator to the first value.
+     * @param end An iterator to the value following the last valid value.
+     * @param def Value returned when there is no token.
+     *
+     * @return Pair of token value (or `def`) and token length.
+     */
+    template<typename Out, typename Iterator>
+    static std::pair<Out, std::size_t> match(Iterator it, const Iterator end, Out def)
+    {
+        static_assert(sizeof(typename std::iterator_traits<Iterator>::value_type) == 1,
+            "Lexer requires single byte values");
+
+        static constexpr int values[] = {0, Items::value...};
+
+        state_type last = _automaton::value.start;
+        const std::size_t length = scan(it, end, last, simd::contiguous<Iterator>{});
+        const unsigned token = _automaton::value.token[last];
+
+        if (!token)
+            return {def, 0};
+
+        return {static_cast<Out>(values[token]), length};
+    }
+
+
+// Private Operations
+private:
+
+
+    /**
+     * @brief Find the longest accepted prefix.
+     *
+     * @param it   An iterator to the first value.
+     * @param end  An iterator to the value following the last valid value.
+     * @param last The last accepting state.
+     *
+     * @return Length of the prefix.
+     */
+    template<typename Iterator>
+    static std::size_t scan(Iterator it, const Iterator end, state_type& last, std::false_type) noexcept
+    {
+        const auto& table = _automaton::value;
+        state_type state = table.start;
+        std::size_t length = 0;
+
+        for (std::size_t pos = 1; it != end; ++it, ++pos)
+        {
+            state = table.next[table.column[static_cast<unsigned char>(*it)] + state];
+
+            if (state == dead)
+                break;
+
+            // Without branch, it's not predictable at the end of token
+            const bool accept = state >= accepting;
+            last = accept ? state : last;
+            length = accept ? pos : length;
+        }
+
+        return length;
+    }
+
+
+    /**
+     * @brief Find the longest accepted prefix in contiguous bytes.
+     *
+     * Bytes that keep the automaton in the same state are skipped by
+     * vectorized class scan.
+     */
+    template<typename Iterator>
+    static std::size_t scan(Iterator it, const Iterator end, state_type& last, std::true_type) noexcept
+    {
+        if (it == end)
+            return 0;
+
+        const auto& table = _automaton::value;
+        state_type state = table.start;
+
+        const char* const first = simd::address(it);
+        const char* const stop = first + (end - it);
+        const char* accepted = first;
+        state_type previous = dead;
+
+        for (const char* pos = first; pos != stop; )
+        {
+            state = table.next[table.column[static_cast<unsigned char>(*pos)] + state];
+
+            if (state == dead)
+                break;
+
+            ++pos;
+
+            // Repeated transition into same state, skip the rest of the loop.
+            // Short loops are faster without the vectorized scan.
+            if (state == previous && pos != stop &&
+                table.loop_class[state].test(static_cast<unsigned char>(*pos)))
+            {
+                pos = simd::span_class(pos + 1, stop, table.loop_class[state]);
+            }
+
+            previous = state;
+
+            const bool accept = state >= accepting;
+            last = accept ? state : last;
+            accepted = accept ? pos : accepted;
+        }
+
+        return static_cast<std::size_t>(accepted - first);
+    }
+
+};
+
+/* ************************************************************************ */
+
+}
+}
+
+/* ************************************************************************ */
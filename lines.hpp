@@ -0,0 +1,288 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file lines.hpp
+ *
+ * This header contains matching of lines in a memory buffer without
+ * copying them and memory mapped files.
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Memory mapped files are available.
+#define TEMPLATE_REGEX_MAPPED_FILE 1
+#endif
+
+// Library
+#include "regex.hpp"
+#include "simd.hpp"
+
+/* ************************************************************************ */
+
+namespace template_regex {
+
+/* ************************************************************************ */
+
+/**
+ * @brief Call functor for each line in buffer.
+ *
+ * Lines are separated by '\n' that is not part of the line. Text after
+ * the last '\n' is a line only if it's not empty.
+ *
+ * @param begin    Buffer beginning.
+ * @param end      Buffer end.
+ * @param callback Functor called with line beginning and end.
+ */
+template<typename Callback>
+void for_each_line(const char* begin, const char* const end, Callback callback)
+{
+    while (begin != end)
+    {
+        const char* const eol = simd::find_byte(begin, end, '\n');
+
+        callback(begin, eol);
+
+        if (eol == end)
+            break;
+
+        begin = eol + 1;
+    }
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match each line in buffer by regex.
+ *
+ * Lines are matched in place, the buffer is not copied.
+ *
+ * @param regex    Regular expression.
+ * @param begin    Buffer beginning.
+ * @param end      Buffer end.
+ * @param callback Functor called with beginning and end of each matched
+ *                 line.
+ *
+ * @return A number of matched lines.
+ */
+template<typename Regex, typename Callback>
+std::size_t regex_scan_lines(const Regex& regex, const char* begin, const char* end,
+    Callback callback)
+{
+    std::size_t count = 0;
+
+    for_each_line(begin, end, [&](const char* first, const char* last) {
+        if (regex_match(regex, first, last))
+        {
+            callback(first, last);
+            ++count;
+        }
+    });
+
+    return count;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Count lines in buffer matched by regex.
+ *
+ * @param regex Regular expression.
+ * @param begin Buffer beginning.
+ * @param end   Buffer end.
+ *
+ * @return A number of matched lines.
+ */
+template<typename Regex>
+std::size_t regex_scan_lines(const Regex& regex, const char* begin, const char* end)
+{
+    return regex_scan_lines(regex, begin, end, [](const char*, const char*) {});
+}
+
+/* ************************************************************************ */
+
+#ifdef TEMPLATE_REGEX_MAPPED_FILE
+
+/* ************************************************************************ */
+
+/**
+ * @brief Read-only memory mapped file.
+ *
+ * The file is mapped for sequential reading.
+ */
+struct mapped_file
+{
+
+// Public Ctors & Dtors
+public:
+
+
+    /**
+     * @brief Map file into memory.
+     *
+     * @param filename Path to file.
+     *
+     * @throw std::system_error File cannot be mapped.
+     */
+    explicit mapped_file(const std::string& filename)
+    {
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), filename);
+
+        struct stat info;
+
+        if (::fstat(fd, &info) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), filename);
+        }
+
+        size_ = static_cast<std::size_t>(info.st_size);
+
+        // Empty file cannot be mapped
+        if (size_ > 0)
+        {
+            void* const data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (data == MAP_FAILED)
+            {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), filename);
+            }
+
+            ::madvise(data, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(data);
+        }
+
+        ::close(fd);
+    }
+
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+
+    mapped_file(mapped_file&& rhs) noexcept
+        : data_(rhs.data_), size_(rhs.size_)
+    {
+        rhs.data_ = nullptr;
+        rhs.size_ = 0;
+    }
+
+
+    mapped_file& operator=(mapped_file&& rhs) noexcept
+    {
+        std::swap(data_, rhs.data_);
+        std::swap(size_, rhs.size_);
+        return *this;
+    }
+
+
+    /**
+     * @brief Unmap file.
+     */
+    ~mapped_file()
+    {
+        if (data_)
+            ::munmap(const_cast<char*>(data_), size_);
+    }
+
+
+// Public Accessors
+public:
+
+
+    /**
+     * @brief Returns file data.
+     */
+    const char* data() const noexcept
+    {
+        return data_;
+    }
+
+
+    /**
+     * @brief Returns file size.
+     */
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+
+    /**
+     * @brief Returns pointer to the first byte.
+     */
+    const char* begin() const noexcept
+    {
+        return data_;
+    }
+
+
+    /**
+     * @brief Returns pointer after the last byte.
+     */
+    const char* end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+
+// Private Data Members
+private:
+
+    /// Mapped data.
+    const char* data_ = nullptr;
+
+    /// Data size.
+    std::size_t size_ = 0;
+
+};
+
+/* ************************************************************************ */
+
+#endif
+
+/* ************************************************************************ */
+
+}
+
+/* ************************************************************************ */
@@ -0,0 +1,575 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file onepass.hpp
+ *
+ * This header contains one-pass automaton that matches input with groups
+ * in a single scan.
+ *
+ * Rule is one-pass when at most one NFA thread is alive after reading any
+ * input byte. Group positions are then known immediately and they are
+ * stored by the transitions, without any backtracking.
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+// Library
+#include "rules.hpp"
+#include "automaton.hpp"
+
+/* ************************************************************************ */
+
+namespace template_regex {
+namespace rules {
+
+/* ************************************************************************ */
+
+/**
+ * @brief Maximum number of slots stored by transition without branching.
+ *
+ * Group boundaries usually share a position only with a few other
+ * boundaries, e.g. `([-+]?)([0-9]*)` stores 3 slots before the first digit.
+ */
+constexpr std::size_t onepass_stores = 8;
+
+/* ************************************************************************ */
+
+/**
+ * @brief One-pass automaton.
+ *
+ * States are NFA states entered by byte transitions (and the starting
+ * state). Each transition stores a mask of submatch slots that are set
+ * to the position before the byte. The starting state is always 0 and
+ * missing transition is stored as -1.
+ *
+ * @tparam States  Number of states.
+ * @tparam Classes Number of byte classes.
+ */
+template<std::size_t States, std::size_t Classes>
+struct onepass_table
+{
+
+    /// Number of states.
+    static constexpr std::size_t state_count = States;
+
+    /// Number of byte classes.
+    static constexpr std::size_t class_count = Classes;
+
+    /// If the rule is one-pass, otherwise the table is not complete.
+    bool onepass = true;
+
+    /// Byte classes.
+    byte_classes classes;
+
+    /// Transitions.
+    short next[States > 0 ? States : 1][Classes > 0 ? Classes : 1] = {};
+
+    /// Maximum number of slots stored by transition.
+    std::size_t stores = 0;
+
+    /// Slots stored by transitions.
+    unsigned long long action[States > 0 ? States : 1][Classes > 0 ? Classes : 1] = {};
+
+    /// The first `onepass_stores` slots stored by transitions, unused items are slot 0.
+    unsigned char slot[States > 0 ? States : 1][Classes > 0 ? Classes : 1][onepass_stores] = {};
+
+    /// If state is accepting.
+    bool accept[States > 0 ? States : 1] = {};
+
+    /// Slots stored when input ends in accepting state.
+    unsigned long long accept_action[States > 0 ? States : 1] = {};
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Numbering of NFA states used by one-pass automaton.
+ *
+ * @tparam States Maximum number of NFA states.
+ */
+template<std::size_t States>
+struct onepass_states
+{
+    /// Automaton state of each NFA state or -1.
+    int number[States > 0 ? States : 1] = {};
+
+    /// Number of automaton states.
+    int count = 0;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Number NFA states used by one-pass automaton.
+ *
+ * @param nfa Source NFA.
+ *
+ * @return Numbering.
+ */
+template<std::size_t States, std::size_t Edges>
+constexpr onepass_states<States> make_onepass_states(const nfa<States, Edges>& nfa) noexcept
+{
+    onepass_states<States> res;
+
+    for (int state = 0; state < nfa.state_count; ++state)
+        res.number[state] = -1;
+
+    res.number[nfa.start] = res.count++;
+
+    for (int i = 0; i < nfa.edge_count; ++i)
+    {
+        const nfa_edge& edge = nfa.edges[i];
+
+        if (!edge.epsilon && res.number[edge.to] < 0)
+            res.number[edge.to] = res.count++;
+    }
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Create one-pass automaton from NFA.
+ *
+ * Epsilon closure of each state is walked with slots stored on the way.
+ * The rule is not one-pass if a state is reached with different slots or
+ * if a byte leads to different states or with different slots.
+ *
+ * @tparam Table Result table type.
+ *
+ * @param nfa     Source NFA.
+ * @param classes Byte classes.
+ *
+ * @return One-pass automaton.
+ */
+template<typename Table, std::size_t States, std::size_t Edges>
+constexpr Table make_onepass_table(const nfa<States, Edges>& nfa, const byte_classes& classes) noexcept
+{
+    Table res;
+    res.classes = classes;
+
+    const onepass_states<States> numbers = make_onepass_states(nfa);
+
+    // Transitions grouped by source state
+    int first[States + 1] = {};
+    int edges[Edges > 0 ? Edges : 1] = {};
+
+    for (int i = 0; i < nfa.edge_count; ++i)
+        ++first[nfa.edges[i].from + 1];
+
+    for (std::size_t state = 0; state < States; ++state)
+        first[state + 1] += first[state];
+
+    int fill[States > 0 ? States : 1] = {};
+
+    for (int i = 0; i < nfa.edge_count; ++i)
+        edges[first[nfa.edges[i].from] + fill[nfa.edges[i].from]++] = i;
+
+    for (int origin = 0; origin < nfa.state_count; ++origin)
+    {
+        const int state = numbers.number[origin];
+
+        if (state < 0)
+            continue;
+
+        for (std::size_t cls = 0; cls < Table::class_count; ++cls)
+            res.next[state][cls] = -1;
+
+        // Epsilon closure with stored slots
+        bool reached[States > 0 ? States : 1] = {};
+        unsigned long long slots[States > 0 ? States : 1] = {};
+        int stack[States > 0 ? States : 1] = {};
+        int top = 0;
+
+        reached[origin] = true;
+        stack[top++] = origin;
+
+        while (top > 0)
+        {
+            const int current = stack[--top];
+
+            for (int i = first[current]; i < first[current + 1]; ++i)
+            {
+                const nfa_edge& edge = nfa.edges[edges[i]];
+
+                if (!edge.epsilon)
+                    continue;
+
+                if (edge.slot >= 64)
+                {
+                    res.onepass = false;
+                    return res;
+                }
+
+                const unsigned long long mask = slots[current] |
+                    (edge.slot >= 0 ? 1ull << edge.slot : 0);
+
+                if (!reached[edge.to])
+                {
+                    reached[edge.to] = true;
+                    slots[edge.to] = mask;
+                    stack[top++] = edge.to;
+                }
+                else if (slots[edge.to] != mask)
+                {
+                    res.onepass = false;
+                    return res;
+                }
+            }
+        }
+
+        for (int current = 0; current < nfa.state_count; ++current)
+        {
+            if (!reached[current])
+                continue;
+
+            if (nfa.accept[current])
+            {
+                if (res.accept[state] && res.accept_action[state] != slots[current])
+                {
+                    res.onepass = false;
+                    return res;
+                }
+
+                res.accept[state] = true;
+                res.accept_action[state] = slots[current];
+            }
+
+            for (int i = first[current]; i < first[current + 1]; ++i)
+            {
+                const nfa_edge& edge = nfa.edges[edges[i]];
+
+                if (edge.epsilon)
+                    continue;
+
+                const int target = numbers.number[edge.to];
+
+                for (std::size_t cls = 0; cls < Table::class_count; ++cls)
+                {
+                    if (!edge.set.test(classes.representative[cls]))
+                        continue;
+
+                    if (res.next[state][cls] >= 0 &&
+                        (res.next[state][cls] != target || res.action[state][cls] != slots[current]))
+                    {
+                        res.onepass = false;
+                        return res;
+                    }
+
+                    res.next[state][cls] = static_cast<short>(target);
+                    res.action[state][cls] = slots[current];
+                }
+            }
+        }
+    }
+
+    // Slot 0 of the whole match is not stored by transitions
+    for (std::size_t state = 0; state < Table::state_count; ++state)
+    {
+        for (std::size_t cls = 0; cls < Table::class_count; ++cls)
+        {
+            std::size_t count = 0;
+
+            for (int slot = 2; slot < 64; ++slot)
+            {
+                if (!((res.action[state][cls] >> slot) & 1))
+                    continue;
+
+                if (count < onepass_stores)
+                    res.slot[state][cls][count] = static_cast<unsigned char>(slot);
+
+                ++count;
+            }
+
+            res.stores = count > res.stores ? count : res.stores;
+        }
+    }
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Compile-time one-pass automaton data for given rule.
+ *
+ * @tparam Rule Source rule.
+ */
+template<typename Rule>
+struct onepass_data
+{
+    static_assert(nfa_traits<Rule>::supported, "Rule cannot be converted into automaton");
+
+
+    /// Thompson NFA with group slots.
+    static constexpr nfa_type<Rule> nfa_value = make_nfa<Rule>();
+
+    /// Byte classes.
+    static constexpr byte_classes classes = make_byte_classes(nfa_value);
+
+    /// Number of states.
+    static constexpr std::size_t states = static_cast<std::size_t>(make_onepass_states(nfa_value).count);
+
+    /// Automaton type.
+    using table_type = onepass_table<states, static_cast<std::size_t>(classes.count)>;
+
+    /// Automaton.
+    static constexpr table_type value = make_onepass_table<table_type>(nfa_value, classes);
+};
+
+/* ************************************************************************ */
+
+template<typename Rule>
+constexpr nfa_type<Rule> onepass_data<Rule>::nfa_value;
+
+template<typename Rule>
+constexpr byte_classes onepass_data<Rule>::classes;
+
+template<typename Rule>
+constexpr typename onepass_data<Rule>::table_type onepass_data<Rule>::value;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Tests if rule is one-pass.
+ *
+ * @tparam Rule      Tested rule.
+ * @tparam Supported If rule can be converted into automaton.
+ */
+template<typename Rule, bool Supported = nfa_traits<Rule>::supported>
+struct is_onepass : std::integral_constant<bool, onepass_data<Rule>::value.onepass> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for rules without automaton.
+ */
+template<typename Rule>
+struct is_onepass<Rule, false> : std::false_type {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Matcher of one-pass rule with submatch results.
+ *
+ * Input is read once, slots are stored into local array and copied into
+ * results only at the end (or at each accepting state when the longest
+ * prefix is matched). When transitions store at most `onepass_stores`
+ * slots (the usual case) each transition does the same number of stores,
+ * unused stores go to slot 0, so there is no branch on group boundaries.
+ *
+ * @tparam Rule One-pass rule without anchors.
+ * @tparam Full If the whole input must be matched.
+ */
+template<typename Rule, bool Full>
+struct onepass
+{
+    static_assert(is_onepass<Rule>::value, "Rule is not one-pass");
+
+
+    /// Automaton data.
+    using data = onepass_data<Rule>;
+
+    /// Number of slots stored by each transition, 0 for stores by mask.
+    static constexpr std::size_t stores = data::value.stores <= onepass_stores ? data::value.stores : 0;
+
+
+    /**
+     * @brief Match the input.
+     *
+     * Results are changed even if the input is not matched.
+     *
+     * @param first   An iterator to the first value.
+     * @param last    An iterator to the value following the last value.
+     * @param results Positions of the whole match and each group.
+     *
+     * @return If the input was matched.
+     */
+    template<typename Iterator, std::size_t Size>
+    static bool match(const Iterator first, const Iterator last,
+        std::array<std::pair<Iterator, Iterator>, Size>& results)
+    {
+        static_assert(sizeof(typename std::iterator_traits<Iterator>::value_type) == 1,
+            "Automaton requires single byte values");
+
+        static_assert(Size <= 32, "Too many groups");
+
+        std::array<Iterator, 2 * Size> slots;
+        slots.fill(last);
+
+        return match(first, last, slots, results, std::integral_constant<bool, Full>{});
+    }
+
+
+// Private Operations
+private:
+
+
+    /**
+     * @brief Store position into slots.
+     */
+    template<typename Iterator, std::size_t Slots>
+    static void store(std::array<Iterator, Slots>& slots, unsigned long long mask, const Iterator& it) noexcept
+    {
+        for (; mask; mask &= mask - 1)
+            slots[__builtin_ctzll(mask)] = it;
+    }
+
+
+    /**
+     * @brief Store position into slots of transition.
+     */
+    template<typename Iterator, std::size_t Slots>
+    static void store(std::array<Iterator, Slots>& slots, int state, int cls, const Iterator& it) noexcept
+    {
+        store(slots, state, cls, it, std::integral_constant<bool, (stores > 0)>{});
+    }
+
+
+    /**
+     * @brief Store position into fixed number of slots of transition.
+     */
+    template<typename Iterator, std::size_t Slots>
+    static void store(std::array<Iterator, Slots>& slots, int state, int cls, const Iterator& it,
+        std::true_type) noexcept
+    {
+        for (std::size_t i = 0; i < stores; ++i)
+            slots[data::value.slot[state][cls][i]] = it;
+    }
+
+
+    /**
+     * @brief Store position into any slots of transition.
+     */
+    template<typename Iterator, std::size_t Slots>
+    static void store(std::array<Iterator, Slots>& slots, int state, int cls, const Iterator& it,
+        std::false_type) noexcept
+    {
+        if (data::value.action[state][cls])
+            store(slots, data::value.action[state][cls], it);
+    }
+
+
+    /**
+     * @brief Copy slots into results.
+     */
+    template<typename Iterator, std::size_t Slots, std::size_t Size>
+    static void copy(const std::array<Iterator, Slots>& slots,
+        std::array<std::pair<Iterator, Iterator>, Size>& results) noexcept
+    {
+        for (std::size_t i = 1; i < Size; ++i)
+            results[i] = {slots[2 * i], slots[2 * i + 1]};
+    }
+
+
+    /**
+     * @brief Match the whole input.
+     */
+    template<typename Iterator, std::size_t Slots, std::size_t Size>
+    static bool match(const Iterator first, const Iterator last, std::array<Iterator, Slots>& slots,
+        std::array<std::pair<Iterator, Iterator>, Size>& results, std::true_type)
+    {
+        int state = 0;
+
+        for (Iterator it = first; it != last; ++it)
+        {
+            const int cls = data::value.classes.class_of[static_cast<unsigned char>(*it)];
+
+            store(slots, state, cls, it);
+            state = data::value.next[state][cls];
+
+            if (state < 0)
+                return false;
+        }
+
+        if (!data::value.accept[state])
+            return false;
+
+        store(slots, data::value.accept_action[state], last);
+        copy(slots, results);
+        results[0] = {first, last};
+
+        return true;
+    }
+
+
+    /**
+     * @brief Match the longest prefix.
+     */
+    template<typename Iterator, std::size_t Slots, std::size_t Size>
+    static bool match(const Iterator first, const Iterator last, std::array<Iterator, Slots>& slots,
+        std::array<std::pair<Iterator, Iterator>, Size>& results, std::false_type)
+    {
+        int state = 0;
+        bool matched = false;
+
+        for (Iterator it = first; ; ++it)
+        {
+            if (data::value.accept[state])
+            {
+                // Slots of accepting state are not part of the path
+                std::array<Iterator, Slots> accepted = slots;
+                store(accepted, data::value.accept_action[state], it);
+                copy(accepted, results);
+                results[0] = {first, it};
+                matched = true;
+            }
+
+            if (it == last)
+                break;
+
+            const int cls = data::value.classes.class_of[static_cast<unsigned char>(*it)];
+
+            store(slots, state, cls, it);
+            state = data::value.next[state][cls];
+
+            if (state < 0)
+                break;
+        }
+
+        return matched;
+    }
+
+};
+
+/* ************************************************************************ */
+
+template<typename Rule, bool Full>
+constexpr std::size_t onepass<Rule, Full>::stores;
+
+/* ************************************************************************ */
+
+}
+}
+
+/* ************************************************************************ */
@@ -0,0 +1,417 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file parallel_lines.hpp
+ *
+ * This header contains matching of lines in a memory buffer by multiple
+ * threads.
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Library
+#include "lines.hpp"
+
+/* ************************************************************************ */
+
+namespace template_regex {
+
+/* ************************************************************************ */
+
+/**
+ * @brief Minimum size of chunk processed by single task.
+ */
+constexpr std::size_t parallel_lines_min_chunk = 64 * 1024;
+
+/* ************************************************************************ */
+
+/**
+ * @brief A number of tasks created for each thread.
+ *
+ * More tasks than threads balance lines of different cost.
+ */
+constexpr std::size_t parallel_lines_tasks = 8;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Split buffer into chunks that end at line end.
+ *
+ * @param begin Buffer beginning.
+ * @param end   Buffer end.
+ * @param count Requested number of chunks.
+ *
+ * @return Chunk boundaries, the first is `begin` and the last is `end`.
+ * Number of chunks can be lower than requested when lines are long.
+ */
+inline std::vector<const char*> split_lines(const char* begin, const char* end, std::size_t count)
+{
+    std::vector<const char*> res{begin};
+
+    const std::size_t size = static_cast<std::size_t>(end - begin);
+
+    // At least a byte in each chunk
+    count = std::min(count, size);
+
+    const std::size_t step = count > 1 ? size / count : size;
+
+    for (std::size_t i = 1; i < count && step > 0; ++i)
+    {
+        const char* const pos = begin + i * step;
+
+        // Previous chunk contains this line
+        if (pos <= res.back())
+            continue;
+
+        const char* const eol = simd::find_byte(pos - 1, end, '\n');
+
+        if (eol == end)
+            break;
+
+        res.push_back(eol + 1);
+    }
+
+    if (res.back() != end)
+        res.push_back(end);
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Work-stealing scheduler of tasks.
+ *
+ * Tasks are evenly distributed into queues of workers. Each worker takes
+ * tasks from the front of its queue and when it's empty, it steals tasks
+ * from the back of other queues. Queue is a single atomic word so workers
+ * are never blocked.
+ */
+struct work_stealing_scheduler
+{
+
+// Public Ctors & Dtors
+public:
+
+
+    /**
+     * @brief Constructor.
+     *
+     * @param tasks   A number of tasks.
+     * @param workers A number of workers.
+     */
+    work_stealing_scheduler(std::size_t tasks, std::size_t workers)
+        : count_(std::max<std::size_t>(workers, 1))
+        , storage_(new char[(count_ + 1) * sizeof(_queue)])
+    {
+        // Allocator of C++14 doesn't align over-aligned types
+        void* data = storage_.get();
+        std::size_t space = (count_ + 1) * sizeof(_queue);
+        queues_ = static_cast<_queue*>(std::align(alignof(_queue), count_ * sizeof(_queue), data, space));
+
+        for (std::size_t i = 0; i < count_; ++i)
+        {
+            new (queues_ + i) _queue;
+            queues_[i].range = pack(tasks * i / count_, tasks * (i + 1) / count_);
+        }
+    }
+
+
+// Public Operations
+public:
+
+
+    /**
+     * @brief Take task for worker.
+     *
+     * @param worker Worker index.
+     * @param task   Task index.
+     *
+     * @return If there is a task.
+     */
+    bool pop(std::size_t worker, std::size_t& task) noexcept
+    {
+        if (take(queues_[worker], true, task))
+            return true;
+
+        for (std::size_t i = 1; i < count_; ++i)
+        {
+            if (take(queues_[(worker + i) % count_], false, task))
+                return true;
+        }
+
+        return false;
+    }
+
+
+// Private Types
+private:
+
+
+    /// Queue as packed range of task indices, queues of different workers
+    /// are not in same cache line.
+    struct alignas(64) _queue
+    {
+        std::atomic<unsigned long long> range;
+    };
+
+
+// Private Operations
+private:
+
+
+    static constexpr unsigned long long pack(std::size_t first, std::size_t last) noexcept
+    {
+        return static_cast<unsigned long long>(first) << 32 | last;
+    }
+
+
+    /**
+     * @brief Take task from the front or the back of queue.
+     */
+    static bool take(_queue& queue, bool front, std::size_t& task) noexcept
+    {
+        unsigned long long range = queue.range.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            const std::size_t first = static_cast<std::size_t>(range >> 32);
+            const std::size_t last = static_cast<std::size_t>(range & 0xFFFFFFFFu);
+
+            if (first == last)
+                return false;
+
+            const unsigned long long next = front ? pack(first + 1, last) : pack(first, last - 1);
+
+            if (queue.range.compare_exchange_weak(range, next, std::memory_order_relaxed))
+            {
+                task = front ? first : last - 1;
+                return true;
+            }
+        }
+    }
+
+
+// Private Data Members
+private:
+
+
+    /// A number of workers.
+    std::size_t count_;
+
+    /// Storage of queues.
+    std::unique_ptr<char[]> storage_;
+
+    /// Queues of workers aligned to cache line.
+    _queue* queues_;
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Run tasks by multiple threads.
+ *
+ * The calling thread is one of the workers. Exception thrown by a task is
+ * rethrown after all threads are finished.
+ *
+ * @param tasks   A number of tasks.
+ * @param threads A number of threads.
+ * @param fn      Functor called with task index.
+ */
+template<typename Fn>
+void parallel_for(std::size_t tasks, std::size_t threads, Fn fn)
+{
+    threads = std::max<std::size_t>(std::min(threads, tasks), 1);
+
+    work_stealing_scheduler scheduler(tasks, threads);
+    std::vector<std::exception_ptr> errors(threads);
+
+    const auto worker = [&](std::size_t index) {
+        try
+        {
+            for (std::size_t task; scheduler.pop(index, task); )
+                fn(task);
+        }
+        catch (...)
+        {
+            errors[index] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+
+    for (std::size_t i = 1; i < threads; ++i)
+        pool.emplace_back(worker, i);
+
+    worker(0);
+
+    for (auto& thread : pool)
+        thread.join();
+
+    for (const auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Returns a number of threads used by parallel matching.
+ *
+ * @param threads Requested number of threads, 0 for all cores.
+ */
+inline std::size_t parallel_lines_threads(std::size_t threads) noexcept
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    return std::max<std::size_t>(threads, 1);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Split buffer into chunks for parallel matching.
+ *
+ * @param begin   Buffer beginning.
+ * @param end     Buffer end.
+ * @param threads A number of threads.
+ *
+ * @return Chunk boundaries.
+ */
+inline std::vector<const char*> parallel_lines_chunks(const char* begin, const char* end,
+    std::size_t threads)
+{
+    const std::size_t size = static_cast<std::size_t>(end - begin);
+    const std::size_t count = std::min(threads * parallel_lines_tasks, size / parallel_lines_min_chunk);
+
+    return split_lines(begin, end, std::max<std::size_t>(count, 1));
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Count lines in buffer matched by regex using multiple threads.
+ *
+ * @param regex   Regular expression.
+ * @param begin   Buffer beginning.
+ * @param end     Buffer end.
+ * @param threads A number of threads, 0 for all cores.
+ *
+ * @return A number of matched lines.
+ */
+template<typename Regex>
+std::size_t parallel_scan_lines(const Regex& regex, const char* begin, const char* end,
+    std::size_t threads = 0)
+{
+    threads = parallel_lines_threads(threads);
+
+    const auto chunks = parallel_lines_chunks(begin, end, threads);
+
+    // Each task writes only its own slot
+    std::vector<std::size_t> counts(chunks.size() - 1);
+
+    parallel_for(counts.size(), threads, [&](std::size_t task) {
+        counts[task] = regex_scan_lines(regex, chunks[task], chunks[task + 1]);
+    });
+
+    std::size_t res = 0;
+
+    for (const auto count : counts)
+        res += count;
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match lines in buffer by regex using multiple threads.
+ *
+ * Lines are matched in parallel but the callback is called by the calling
+ * thread in order of lines in buffer.
+ *
+ * @param regex    Regular expression.
+ * @param begin    Buffer beginning.
+ * @param end      Buffer end.
+ * @param threads  A number of threads, 0 for all cores.
+ * @param callback Functor called with beginning and end of each matched
+ *                 line.
+ *
+ * @return A number of matched lines.
+ */
+template<typename Regex, typename Callback>
+std::size_t parallel_scan_lines(const Regex& regex, const char* begin, const char* end,
+    std::size_t threads, Callback callback)
+{
+    using line = std::pair<const char*, const char*>;
+
+    threads = parallel_lines_threads(threads);
+
+    const auto chunks = parallel_lines_chunks(begin, end, threads);
+
+    // Each task writes only its own slot
+    std::vector<std::vector<line>> lines(chunks.size() - 1);
+
+    parallel_for(lines.size(), threads, [&](std::size_t task) {
+        auto& res = lines[task];
+
+        regex_scan_lines(regex, chunks[task], chunks[task + 1], [&res](const char* first, const char* last) {
+            res.emplace_back(first, last);
+        });
+    });
+
+    std::size_t count = 0;
+
+    for (const auto& chunk : lines)
+    {
+        for (const auto& match : chunk)
+            callback(match.first, match.second);
+
+        count += chunk.size();
+    }
+
+    return count;
+}
+
+/* ************************************************************************ */
+
+}
+
+/* ************************************************************************ */
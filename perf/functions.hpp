@@ -100,3 +100,33 @@ void do_test(const std::string& name, Fun fun, const std::vector<std::string>& d
 }
 
 /* ************************************************************************ */
+
+/**
+ * @brief Perform speed test of function that matches all data at once.
+ *
+ * @tparam Fun Testing function type.
+ *
+ * @param fun  Test function, returns a number of matched inputs.
+ * @param data Test data.
+ */
+template<typename Fun>
+void do_batch_test(const std::string& name, Fun fun, const std::vector<std::string>& data)
+{
+    std::cout << std::setw(20) << name << "... " << std::flush;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    const std::size_t count = fun(data);
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Get elapsed time
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+    // Print result
+    std::cout <<
+        count << "/" << data.size() << ": " <<
+        std::setw(7) << std::right << time.count() << " ms" << std::endl;
+}
+
+/* ************************************************************************ */
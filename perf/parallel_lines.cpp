@@ -0,0 +1,69 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// C++
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Template Regex
+#include "functions.hpp"
+#include "../parallel_lines.hpp"
+
+/* ************************************************************************ */
+
+int main(int argc, char** argv)
+{
+    using namespace template_regex;
+    using namespace std::chrono;
+
+    const std::string dir = (argc > 1) ? (std::string(argv[1]) + "/") : "./";
+    const int repeat = (argc > 2) ? std::stoi(argv[2]) : 16;
+
+    print_header("Template Regex (parallel lines)");
+
+    // Make the input large enough for all cores
+    const mapped_file file(dir + "dates.txt");
+    std::string data;
+    data.reserve(file.size() * repeat);
+
+    for (int i = 0; i < repeat; ++i)
+        data.append(file.begin(), file.end());
+
+    static auto regex = make_regex("^[0-9][0-9]?/[0-9][0-9]?/[0-9][0-9][0-9][0-9]$");
+
+    const std::size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (std::size_t threads = 1; threads <= cores; threads = (threads == cores) ? cores + 1 : std::min(threads * 2, cores))
+    {
+        std::cout << std::setw(12) << threads << " threads... " << std::flush;
+
+        const auto start = high_resolution_clock::now();
+        const auto count = parallel_scan_lines(regex, data.data(), data.data() + data.size(), threads);
+        const auto end = high_resolution_clock::now();
+
+        std::cout << count << ": " <<
+            std::setw(7) << std::right << duration_cast<milliseconds>(end - start).count() << " ms" <<
+            std::endl;
+    }
+}
+
+/* ************************************************************************ */
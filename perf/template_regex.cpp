@@ -23,6 +23,7 @@
 // Template Regex
 #include "functions.hpp"
 #include "../regex.hpp"
+#include "../regex_batch.hpp"
 
 /* ************************************************************************ */
 
@@ -59,6 +60,48 @@ static bool test_float(const std::string& input)
 
 /* ************************************************************************ */
 
+template<std::size_t Lanes, typename Regex>
+static std::size_t test_batch(const Regex&, const std::vector<std::string>& inputs)
+{
+    using namespace template_regex;
+
+    std::vector<bool> results(inputs.size());
+
+    return regex_batch<Regex, Lanes>::match(inputs.begin(), inputs.end(), results.begin());
+}
+
+/* ************************************************************************ */
+
+template<std::size_t Lanes>
+static std::size_t test_batch_identifiers(const std::vector<std::string>& inputs)
+{
+    using namespace template_regex;
+
+    return test_batch<Lanes>(make_regex("^[a-zA-Z_][a-zA-Z0-9_]*$"), inputs);
+}
+
+/* ************************************************************************ */
+
+template<std::size_t Lanes>
+static std::size_t test_batch_date(const std::vector<std::string>& inputs)
+{
+    using namespace template_regex;
+
+    return test_batch<Lanes>(make_regex("^[0-9][0-9]?/[0-9][0-9]?/[0-9][0-9][0-9][0-9]$"), inputs);
+}
+
+/* ************************************************************************ */
+
+template<std::size_t Lanes>
+static std::size_t test_batch_float(const std::vector<std::string>& inputs)
+{
+    using namespace template_regex;
+
+    return test_batch<Lanes>(make_regex("^[-+]?[0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?$"), inputs);
+}
+
+/* ************************************************************************ */
+
 int main(int argc, char** argv)
 {
     const std::string dir = (argc > 1) ? (std::string(argv[1]) + "/") : "./";
@@ -72,6 +115,14 @@ int main(int argc, char** argv)
     do_test("identifier", test_identifiers, identifiers);
     do_test("date",       test_date,        dates);
     do_test("float",      test_float,       floats);
+
+    do_batch_test("batch identifier", test_batch_identifiers<template_regex::regex_batch_lanes>, identifiers);
+    do_batch_test("batch date",       test_batch_date<template_regex::regex_batch_lanes>,        dates);
+    do_batch_test("batch float",      test_batch_float<template_regex::regex_batch_lanes>,       floats);
+
+    do_batch_test("simd identifier",  test_batch_identifiers<template_regex::simd::dfa_lanes>,   identifiers);
+    do_batch_test("simd date",        test_batch_date<template_regex::simd::dfa_lanes>,          dates);
+    do_batch_test("simd float",       test_batch_float<template_regex::simd::dfa_lanes>,         floats);
 }
 
 /* ************************************************************************ */
@@ -0,0 +1,163 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file pike.hpp
+ *
+ * This header contains NFA simulation with group results (Pike VM) for
+ * rules that are not one-pass.
+ *
+ * NFA threads carry positions of groups and they are kept in order of
+ * priority: greedy repetition before skipping it and alternatives from
+ * the first one. Each state keeps only the thread with the highest
+ * priority, so the input is read once and time is linear with its length.
+ * Group positions are from the path with the highest priority (as in
+ * ECMAScript or Perl regexes).
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Library
+#include "rules.hpp"
+#include "automaton.hpp"
+
+/* ************************************************************************ */
+
+namespace template_regex {
+namespace rules {
+
+/* ************************************************************************ */
+
+/**
+ * @brief Matcher of rule with submatch results by NFA simulation.
+ *
+ * Slots of threads are allocated once for each match, memory is linear
+ * with number of NFA states and groups.
+ *
+ * @tparam Rule Rule without anchors.
+ * @tparam Full If the whole input must be matched.
+ */
+template<typename Rule, bool Full>
+struct pike
+{
+    /// NFA simulation.
+    using simulation = nfa_simulation<Rule>;
+
+
+    /**
+     * @brief Match the input.
+     *
+     * Not matched groups have both positions equal to `last`. Without
+     * `Full` the matched prefix is the one of the path with the highest
+     * priority.
+     *
+     * @param first   An iterator to the first value.
+     * @param last    An iterator to the value following the last value.
+     * @param results Positions of the whole match and each group.
+     *
+     * @return If the input was matched.
+     */
+    template<typename Iterator, std::size_t Size>
+    static bool match(const Iterator first, const Iterator last,
+        std::array<std::pair<Iterator, Iterator>, Size>& results)
+    {
+        constexpr std::size_t slots = 2 * Size;
+
+        using threads = typename simulation::template threads<Iterator, slots>;
+        using frame = typename simulation::template frame<Iterator>;
+
+        // Slots of both thread sets, scratch slots and slots of the match
+        std::vector<Iterator> storage((2 * simulation::states + 2) * slots, last);
+        Iterator* const scratch = storage.data() + 2 * simulation::states * slots;
+        Iterator* const matched = scratch + slots;
+
+        threads lists[2];
+        lists[0].slots = storage.data();
+        lists[1].slots = storage.data() + simulation::states * slots;
+
+        threads* current = &lists[0];
+        threads* next = &lists[1];
+        frame stack[simulation::stack_size];
+
+        simulation::add(*current, simulation::nfa_value.start, first, scratch, stack);
+
+        bool found = false;
+        Iterator end = last;
+
+        for (Iterator it = first; ; )
+        {
+            const bool at_end = it == last;
+
+            if (!at_end)
+                next->clear();
+
+            for (int i = 0; i < current->count; ++i)
+            {
+                if (simulation::nfa_value.accept[current->state[i]] && (!Full || at_end))
+                {
+                    found = true;
+                    end = it;
+                    std::copy(current->slots + i * slots, current->slots + (i + 1) * slots, matched);
+
+                    // Threads with lower priority are cut
+                    break;
+                }
+
+                if (!at_end)
+                    simulation::step(*current, i, *next, *it, std::next(it), scratch, stack);
+            }
+
+            if (at_end || next->count == 0)
+                break;
+
+            ++it;
+            std::swap(current, next);
+        }
+
+        if (!found)
+            return false;
+
+        results[0] = {first, end};
+
+        for (std::size_t i = 1; i < Size; ++i)
+            results[i] = {matched[2 * i], matched[2 * i + 1]};
+
+        return true;
+    }
+
+};
+
+/* ************************************************************************ */
+
+}
+}
+
+/* ************************************************************************ */
@@ -28,7 +28,9 @@
  * RE             = [ "^" ] inner-RE [ "$" ]
  * inner-RE       = simple-RE { "|" simple-RE }
  * simple-RE      = basic-RE { basic-RE }
- * basic-RE       = elementary-RE [ "*" | "+" | "?" ]
+ * basic-RE       = elementary-RE [ "*" | "+" | "?" | count ]
+ * count          = "{" number [ "," [ number ] ] "}"
+ * number         = digit { digit }
  * elementary-RE  = group | any | char | set
  * group          = "(" inner-RE ")"
  * any            = "."
@@ -44,8 +46,21 @@
 
 /* ************************************************************************ */
 
+// C++
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
 // Library
 #include "rules.hpp"
+#include "automaton.hpp"
+#include "analysis.hpp"
+#include "onepass.hpp"
+#include "pike.hpp"
+#include "simd.hpp"
 #include "string.hpp"
 
 /* ************************************************************************ */
@@ -124,10 +139,31 @@ public:
 
 /* ************************************************************************ */
 
+/**
+ * @brief Returns class bits of shorthand class escape ("\d", "\w", "\s").
+ *
+ * Upper case escapes ("\D", "\W", "\S") have the same bits.
+ *
+ * @param c Escaped character.
+ *
+ * @return Class bits or 0 if the escape is not a class.
+ */
+constexpr unsigned regex_class_escape(int c) noexcept
+{
+    return
+        (c == 'd' || c == 'D') ? rules::ctype_digit :
+        (c == 'w' || c == 'W') ? rules::ctype_word :
+        (c == 's' || c == 'S') ? rules::ctype_space :
+        0
+    ;
+}
+
+/* ************************************************************************ */
+
 /**
  * @brief Parser for REGEX character.
  *
- * char = any non metacharacter | "\" metacharacter
+ * char = any non metacharacter | "\" metacharacter | "\" class-letter
  *
  * @tparam Str Source string.
  */
@@ -145,13 +181,22 @@ public:
     // Character value
     static constexpr typename Str::value_type value = character_at_str<escaped ? 1 : 0, Str>::value;
 
+    /// Class bits of shorthand class escape.
+    static constexpr unsigned class_mask = escaped ? regex_class_escape(value) : 0;
+
+    /// If character is a shorthand class escape.
+    static constexpr bool is_class = class_mask != 0;
+
 
 // Public Types
 public:
 
 
     /// Regex matching rule.
-    using rule = rules::val<value>;
+    using rule = typename std::conditional<is_class,
+        rules::char_class<class_mask, (value >= 'A' && value <= 'Z')>,
+        rules::val<value>
+    >::type;
 
 
     /// Rest of the source string.
@@ -165,13 +210,136 @@ public:
 /* ************************************************************************ */
 
 /**
- * @brief Parser for REGEX set-item.
+ * @brief Returns class bits of POSIX class name.
+ *
+ * @param str  Name followed by ":]".
+ * @param size Name length.
  *
- * set-item = char [ "-" char ]
+ * @return Class bits or 0 for unknown name.
+ */
+constexpr unsigned regex_class_name(const char* str, std::size_t size) noexcept
+{
+    const char* const names[] = {
+        "alpha", "digit", "alnum", "upper", "lower", "space",
+        "blank", "punct", "print", "graph", "cntrl", "xdigit"
+    };
+    const unsigned masks[] = {
+        rules::ctype_alpha, rules::ctype_digit, rules::ctype_alnum,
+        rules::ctype_upper, rules::ctype_lower, rules::ctype_space,
+        rules::ctype_blank, rules::ctype_punct, rules::ctype_print,
+        rules::ctype_graph, rules::ctype_cntrl, rules::ctype_xdigit
+    };
+
+    for (std::size_t i = 0; i < sizeof(masks) / sizeof(masks[0]); ++i)
+    {
+        std::size_t j = 0;
+
+        while (j < size && names[i][j] == str[j])
+            ++j;
+
+        if (j == size && names[i][j] == '\0')
+            return masks[i];
+    }
+
+    return 0;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Parser for REGEX POSIX class.
+ *
+ * class-name = "[:" name ":]"
  *
  * @tparam Str Source string.
  */
 template<typename Str>
+struct regex_parser_class_name
+{
+    // Pre-conditions
+    static_assert(character_at_str<0, Str>::value == '[', "Missing '[' character");
+    static_assert(character_at_str<1, Str>::value == ':', "Missing ':' character");
+
+
+// Private Constants
+private:
+
+
+    /// Maximum length of the name.
+    static constexpr std::size_t _max_size = 8;
+
+
+// Private Operations
+private:
+
+
+    template<std::size_t... I>
+    static constexpr std::size_t size_impl(std::index_sequence<I...>) noexcept
+    {
+        const char name[] = {static_cast<char>(character_at_str<I + 2, Str>::value)..., ':'};
+        std::size_t size = 0;
+
+        while (name[size] != ':')
+            ++size;
+
+        return size;
+    }
+
+
+    template<std::size_t... I>
+    static constexpr unsigned mask_impl(std::index_sequence<I...>) noexcept
+    {
+        const char name[] = {static_cast<char>(character_at_str<I + 2, Str>::value)..., ':'};
+
+        return regex_class_name(name, size_impl(std::index_sequence<I...>{}));
+    }
+
+
+// Public Constants
+public:
+
+
+    /// Name length.
+    static constexpr std::size_t size = size_impl(std::make_index_sequence<_max_size>{});
+
+    /// Class bits.
+    static constexpr unsigned mask = mask_impl(std::make_index_sequence<_max_size>{});
+
+
+    // Post-conditions
+    static_assert(mask != 0, "Unknown character class name");
+    static_assert(character_at_str<size + 3, Str>::value == ']', "Missing ':]' characters");
+
+
+// Public Types
+public:
+
+
+    /// Regex matching rule.
+    using rule = rules::char_class<mask>;
+
+    /// Rest of the source string.
+    using rest = typename basic_string_builder_rest_str<size + 4,
+        typename Str::value_type,
+        basic_string<typename Str::value_type>, Str
+    >::type;
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Parser for REGEX set-item.
+ *
+ * set-item = class-name | char [ "-" char ]
+ *
+ * Shorthand class escapes are not range bounds and dash before "]" is
+ * a character.
+ *
+ * @tparam Str Source string.
+ */
+template<typename Str, bool Name =
+    character_at_str<0, Str>::value == '[' && character_at_str<1, Str>::value == ':'>
 struct regex_parser_set_item
 {
 
@@ -197,7 +365,8 @@ public:
     static constexpr typename Str::value_type value = _char1::value;
 
     /// If item is a range of characters.
-    static constexpr bool is_range = _dash::match;
+    static constexpr bool is_range = _dash::match && !_char1::is_class && !_char2::is_class &&
+        character_at_str<0, typename _dash::rest>::value != ']';
 
     /// The first value of the range.
     static constexpr typename Str::value_type value1 = is_range ? value : typename Str::value_type();
@@ -227,6 +396,17 @@ public:
 
 /* ************************************************************************ */
 
+/**
+ * @brief Specialization of `regex_parser_set_item` for POSIX class.
+ */
+template<typename Str>
+struct regex_parser_set_item<Str, true> : regex_parser_class_name<Str>
+{
+    // Nothing
+};
+
+/* ************************************************************************ */
+
 /**
  * @brief Parser for REGEX set-items.
  *
@@ -369,8 +549,8 @@ private:
 public:
 
 
-    /// Regex matching rule.
-    using rule = typename _inner::rule;
+    /// Regex matching rule, groups are numbered by `regex_parser_re`.
+    using rule = rules::group<0, typename _inner::rule>;
 
     /// Rest of the source string.
     using rest = typename _close::rest;
@@ -416,10 +596,209 @@ public:
 
 /* ************************************************************************ */
 
+/**
+ * @brief Parser for REGEX number.
+ *
+ * number = digit { digit }
+ *
+ * @tparam Str   Source string.
+ * @tparam Value Value of already parsed digits.
+ */
+template<typename Str, unsigned Value = 0,
+    bool Digit = (character_at_str<0, Str>::value >= '0' && character_at_str<0, Str>::value <= '9')>
+struct regex_parser_number
+{
+
+// Private Types
+private:
+
+
+    /// Parse following digits.
+    using _next = regex_parser_number<
+        typename basic_string_builder_rest_str<1,
+            typename Str::value_type,
+            basic_string<typename Str::value_type>, Str
+        >::type,
+        Value * 10 + static_cast<unsigned>(character_at_str<0, Str>::value - '0')
+    >;
+
+
+// Public Constants
+public:
+
+
+    /// Number value.
+    static constexpr unsigned value = _next::value;
+
+    /// A number of digits.
+    static constexpr std::size_t digits = _next::digits + 1;
+
+
+// Public Types
+public:
+
+
+    /// Rest of the source string.
+    using rest = typename _next::rest;
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief End specialization of `regex_parser_number`.
+ */
+template<typename Str, unsigned Value>
+struct regex_parser_number<Str, Value, false>
+{
+
+// Public Constants
+public:
+
+
+    /// Number value.
+    static constexpr unsigned value = Value;
+
+    /// A number of digits.
+    static constexpr std::size_t digits = 0;
+
+
+// Public Types
+public:
+
+
+    /// Rest of the source string.
+    using rest = Str;
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rule repeated given number of times.
+ *
+ * Counts that can be expressed by other repetition rules use them.
+ *
+ * @tparam Rule Repeated rule.
+ * @tparam Min  Minimum number of repetitions.
+ * @tparam Max  Maximum number of repetitions or `rules::repeat_unbounded`.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct regex_repeat_rule
+{
+    using type = rules::repeat_n<Rule, Min, Max>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for {0,}
+ */
+template<typename Rule>
+struct regex_repeat_rule<Rule, 0, rules::repeat_unbounded>
+{
+    using type = rules::repeat_optional<Rule>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for {1,}
+ */
+template<typename Rule>
+struct regex_repeat_rule<Rule, 1, rules::repeat_unbounded>
+{
+    using type = rules::repeat<Rule>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for {0,1}
+ */
+template<typename Rule>
+struct regex_repeat_rule<Rule, 0, 1>
+{
+    using type = rules::optional<Rule>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for {1}
+ */
+template<typename Rule>
+struct regex_repeat_rule<Rule, 1, 1>
+{
+    using type = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Parser for REGEX count.
+ *
+ * count = "{" number [ "," [ number ] ] "}"
+ *
+ * @tparam Str  Source string.
+ * @tparam Rule Repeated rule.
+ */
+template<typename Str, typename Rule>
+struct regex_parser_count
+{
+
+// Private Types
+private:
+
+
+    using _open  = regex_parser_next_if<Str, typename Str::value_type, '{'>;
+    using _min   = regex_parser_number<typename _open::rest>;
+    using _comma = regex_parser_next_if<typename _min::rest, typename Str::value_type, ','>;
+    using _max   = regex_parser_number<typename _comma::rest>;
+    using _close = regex_parser_next_if<typename _max::rest, typename Str::value_type, '}'>;
+
+
+    // Post-conditions
+    static_assert(_open::match, "Count must begins with '{'");
+    static_assert(_min::digits > 0, "Count must begins with a number");
+    static_assert(_close::match, "Count must ends with '}'");
+
+
+// Public Constants
+public:
+
+
+    /// Minimum number of repetitions.
+    static constexpr unsigned min = _min::value;
+
+    /// Maximum number of repetitions.
+    static constexpr unsigned max = !_comma::match
+        ? min
+        : (_max::digits > 0 ? _max::value : rules::repeat_unbounded)
+    ;
+
+    // Post-conditions
+    static_assert(min <= max, "Count minimum is greater than maximum");
+
+
+// Public Types
+public:
+
+
+    /// Regex matching rule.
+    using rule = typename regex_repeat_rule<Rule, min, max>::type;
+
+    /// Rest of the source string.
+    using rest = typename _close::rest;
+
+};
+
+/* ************************************************************************ */
+
 /**
  * @brief Parser for REGEX basic RE.
  *
- * basic-RE = elementary-RE [ "*" | "+" | "?" ]
+ * basic-RE = elementary-RE [ "*" | "+" | "?" | count ]
  */
 template<typename Str>
 struct regex_parser_basic_re
@@ -431,6 +810,13 @@ struct regex_parser_basic_re
     using _star       = regex_parser_next_if<typename _elementary::rest, typename Str::value_type, '*'>;
     using _plus       = regex_parser_next_if<typename _elementary::rest, typename Str::value_type, '+'>;
     using _question   = regex_parser_next_if<typename _elementary::rest, typename Str::value_type, '?'>;
+    using _brace      = regex_parser_next_if<typename _elementary::rest, typename Str::value_type, '{'>;
+
+    /// Parse count or keep elementary regex.
+    using _count = typename std::conditional<_brace::match,
+        regex_parser_count<typename _elementary::rest, typename _elementary::rule>,
+        _elementary
+    >::type;
 
 
 // Public Types
@@ -448,7 +834,7 @@ public:
             typename std::conditional<
                 _question::match,
                 rules::optional<typename _elementary::rule>,
-                typename _elementary::rule
+                typename _count::rule
             >::type
         >::type
     >::type;
@@ -463,7 +849,7 @@ public:
             typename std::conditional<
                 _question::match,
                 _question,
-                _elementary
+                _count
             >::type
         >::type
     >::type::rest;
@@ -553,22 +939,25 @@ private:
     /// The first parsed item.
     using _item = regex_parser_simple_re<Str>;
 
+    /// Parse alternative separator.
+    using _bar  = regex_parser_next_if<typename _item::rest, typename Str::value_type, '|'>;
+
     /// Following items.
-    using _next = regex_parser_inner_re<typename _item::rest,
-        character_at_str<0, typename _item::rest>::value != '|'
-    >;
+    using _next = regex_parser_inner_re<typename _bar::rest, !_bar::match>;
 
 
 // Public Types
 public:
 
 
-    /// Regex matching rule.
-    // TODO change sequence to optional
-    using rule = typename rules::sequence_remove<
-        typename rules::sequence_merge<rules::sequence<typename _item::rule>, typename _next::rule>::type
+    /// All alternative branches.
+    using branches = typename rules::alternative_merge<
+        rules::alternative<typename _item::rule>, typename _next::branches
     >::type;
 
+    /// Regex matching rule.
+    using rule = typename rules::alternative_remove<branches>::type;
+
     /// Rest of the regex string.
     using rest = typename _next::rest;
 
@@ -588,6 +977,7 @@ struct regex_parser_inner_re<Str, true>
 public:
 
 
+    using branches = void;
     using rule = void;
     using rest = Str;
 
@@ -624,6 +1014,9 @@ private:
     /// Parse end character.
     using _end   = regex_parser_next_if<typename _inner::rest, typename Str::value_type, '$'>;
 
+    /// Groups numbered in order of their beginning.
+    using _numbered = rules::number_groups<typename _inner::rule>;
+
 
 // Post-conditions
 private:
@@ -641,75 +1034,570 @@ public:
         _begin::match,
         typename std::conditional<
             _end::match,
-            rules::begin_end<typename _inner::rule>,
-            rules::begin<typename _inner::rule>
+            rules::begin_end<typename _numbered::type>,
+            rules::begin<typename _numbered::type>
         >::type,
         typename std::conditional<
             _end::match,
-            rules::end<typename _inner::rule>,
-            typename _inner::rule
+            rules::end<typename _numbered::type>,
+            typename _numbered::type
         >::type
     >::type;
 
+    /// A number of groups.
+    static constexpr std::size_t groups = _numbered::next - 1;
+
 };
 
 /* ************************************************************************ */
 
 /**
- * @brief Template regular expression.
- *
- * Structure generates from sequence of characters in template arguments a
- * type constructed from rules.
- *
- * template_regex<'a', '-', 'z'>::type is same as rules::range<'a', 'z'>.
- *
- * @tparam Chars Sequence of regular expression characters.
+ * @brief Matching engines.
  */
-template<typename CharT, CharT... Chars>
-struct basic_regex
-{
-    //using rule = typename make_simple<typename build_seq<Chars...>::type>::type;
-    using rule = typename regex_parser_re<basic_string<CharT, Chars...>>::rule;
-};
+namespace engine {
 
 /* ************************************************************************ */
 
 /**
- * @brief Template regular expression.
- *
- * Structure generates from sequence of characters in template arguments a
- * type constructed from rules.
- *
- * template_regex<'a', '-', 'z'>::type is same as rules::range<'a', 'z'>.
- *
- * @tparam Chars Sequence of regular expression characters.
+ * @brief Nested rules calls.
  */
-template<typename CharT, typename Str>
-struct basic_regex_str;
+struct nested {};
 
 /* ************************************************************************ */
 
 /**
- * @brief Template regular expression.
- *
- * Structure generates from sequence of characters in template arguments a
- * type constructed from rules.
- *
- * template_regex<'a', '-', 'z'>::type is same as rules::range<'a', 'z'>.
- *
- * @tparam Chars Sequence of regular expression characters.
+ * @brief Automaton emitted as code, NFA simulation if DFA has too many states.
  */
-template<typename CharT, CharT... Chars>
+struct automatic {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Automaton emitted as code.
+ */
+using code = rules::code_backend;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Automaton emitted as transition tables.
+ */
+using table = rules::table_backend;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Default engine for character type.
+ *
+ * Single byte regular expressions are compiled into automaton.
+ *
+ * @tparam CharT Character type.
+ */
+template<typename CharT>
+using default_engine = typename std::conditional<sizeof(CharT) == 1, automatic, nested>::type;
+
+/* ************************************************************************ */
+
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Creates matching rule for given engine.
+ *
+ * Explicitly selected automaton engine requires DFA, it fails with
+ * "Too many DFA states" instead of NFA simulation.
+ *
+ * @tparam Rule   Regex rule.
+ * @tparam Engine Matching engine.
+ */
+template<typename Rule, typename Engine>
+struct regex_engine_rule
+{
+    using type = typename rules::make_automaton<Rule, Engine, false>::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for automatic engine.
+ */
+template<typename Rule>
+struct regex_engine_rule<Rule, engine::automatic>
+{
+    using type = typename rules::make_automaton<Rule, engine::code, true>::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for nested rules, literal prefixes are factored.
+ */
+template<typename Rule>
+struct regex_engine_rule<Rule, engine::nested>
+{
+    using type = typename rules::prefix_trie_rule<Rule>::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Regex rule with case sensitivity.
+ *
+ * @tparam Rule  Parsed rule.
+ * @tparam Icase If letters are matched in both cases.
+ */
+template<typename Rule, bool Icase>
+struct regex_case_rule
+{
+    using type = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for case-insensitive regex, folded ranges can repeat.
+ */
+template<typename Rule>
+struct regex_case_rule<Rule, true>
+{
+    using type = typename rules::simplify<typename rules::icase_rule<Rule>::type>::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Template regular expression with selected matching engine.
+ *
+ * @tparam Engine Matching engine.
+ * @tparam Icase  If ASCII letters are matched case-insensitive.
+ * @tparam Chars  Sequence of regular expression characters.
+ */
+template<typename Engine, bool Icase, typename CharT, CharT... Chars>
+struct basic_regex_engine
+{
+    //using rule = typename make_simple<typename build_seq<Chars...>::type>::type;
+    using rule = typename rules::bitmap_rule<typename regex_case_rule<
+        typename rules::simplify<typename regex_parser_re<basic_string<CharT, Chars...>>::rule>::type,
+        Icase
+    >::type>::type;
+
+    /// Rule used for matching.
+    using match_rule = typename regex_engine_rule<rule, Engine>::type;
+
+    /// Number of automaton states before minimization.
+    static constexpr std::size_t states_before = rules::automaton_states<match_rule>::before;
+
+    /// Number of automaton states after minimization.
+    static constexpr std::size_t states_after = rules::automaton_states<match_rule>::after;
+
+    /// Minimum length of a match.
+    static constexpr std::size_t min_length = rules::match_length<rule>::min;
+
+    /// Maximum length of a match or `rules::length_unbounded`.
+    static constexpr std::size_t max_length = rules::match_length<rule>::max;
+
+    /// A number of groups.
+    static constexpr std::size_t groups = regex_parser_re<basic_string<CharT, Chars...>>::groups;
+
+    /// Positions of the whole match and each group.
+    template<typename Iterator>
+    using results_type = std::array<std::pair<Iterator, Iterator>, groups + 1>;
+
+    /// If letters are matched case-insensitive.
+    static constexpr bool icase = Icase;
+
+    /// Same regular expression with different engine.
+    template<typename OtherEngine>
+    using with_engine = basic_regex_engine<OtherEngine, Icase, CharT, Chars...>;
+
+    /// Same regular expression with case-insensitive matching.
+    using with_icase = basic_regex_engine<Engine, true, CharT, Chars...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Template regular expression.
+ *
+ * Structure generates from sequence of characters in template arguments a
+ * type constructed from rules.
+ *
+ * template_regex<'a', '-', 'z'>::type is same as rules::range<'a', 'z'>.
+ *
+ * @tparam Chars Sequence of regular expression characters.
+ */
+template<typename CharT, CharT... Chars>
+struct basic_regex
+    : basic_regex_engine<engine::default_engine<CharT>, false, CharT, Chars...>
+{
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Template regular expression.
+ *
+ * Structure generates from sequence of characters in template arguments a
+ * type constructed from rules.
+ *
+ * template_regex<'a', '-', 'z'>::type is same as rules::range<'a', 'z'>.
+ *
+ * @tparam Chars Sequence of regular expression characters.
+ */
+template<typename CharT, typename Str>
+struct basic_regex_str;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Template regular expression.
+ *
+ * Structure generates from sequence of characters in template arguments a
+ * type constructed from rules.
+ *
+ * template_regex<'a', '-', 'z'>::type is same as rules::range<'a', 'z'>.
+ *
+ * @tparam Chars Sequence of regular expression characters.
+ */
+template<typename CharT, CharT... Chars>
 struct basic_regex_str<CharT, basic_string<CharT, Chars...>>
     : basic_regex<CharT, Chars...>
 {
 
-};
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Anchors of regex rule.
+ *
+ * @tparam Rule Regex rule.
+ */
+template<typename Rule>
+struct regex_anchors
+{
+    /// If regex is anchored at the beginning.
+    static constexpr bool begin = false;
+
+    /// If regex is anchored at the end.
+    static constexpr bool end = false;
+
+    /// Rule without anchors.
+    using inner = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin`.
+ */
+template<typename Rule>
+struct regex_anchors<rules::begin<Rule>>
+{
+    static constexpr bool begin = true;
+    static constexpr bool end = false;
+    using inner = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `end`.
+ */
+template<typename Rule>
+struct regex_anchors<rules::end<Rule>>
+{
+    static constexpr bool begin = false;
+    static constexpr bool end = true;
+    using inner = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin_end`.
+ */
+template<typename Rule>
+struct regex_anchors<rules::begin_end<Rule>>
+{
+    static constexpr bool begin = true;
+    static constexpr bool end = true;
+    using inner = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Reversed automaton of regex matched backwards from the input end.
+ *
+ * Only automatons can be reversed. Reversed automatons that would have
+ * too many states are not used.
+ *
+ * @tparam Rule Matching rule.
+ */
+template<typename Rule>
+struct regex_reverse_rule
+{
+    /// Automaton that matches the longest prefix.
+    using type = void;
+
+    /// Automaton that matches the whole input.
+    using full = void;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for automaton.
+ */
+template<typename Rule, bool Full, typename Backend>
+struct regex_reverse_rule<rules::automaton<Rule, Full, Backend>>
+{
+    using _reversed = typename rules::reverse_rule<Rule>::type;
+
+    static constexpr bool _supported =
+        rules::count_rule_dfa_states<_reversed>() < TEMPLATE_REGEX_AUTOMATON_MAX_STATES;
+
+    using type = typename std::conditional<_supported,
+        rules::automaton<_reversed, false, Backend>,
+        void
+    >::type;
+
+    using full = typename std::conditional<_supported,
+        rules::automaton<_reversed, true, Backend>,
+        void
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for NFA simulation.
+ *
+ * Reversed rule can have much smaller DFA, e.g. `[ab]*a[ab]{9}`, otherwise
+ * it's simulated too.
+ */
+template<typename Rule, bool Full>
+struct regex_reverse_rule<rules::nfa_automaton<Rule, Full>>
+{
+    using _reversed = typename rules::reverse_rule<Rule>::type;
+
+    using type = typename rules::make_automaton<_reversed>::type;
+
+    using full = typename rules::make_automaton<rules::end<_reversed>>::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Reversed automaton of regex anchored only at the end.
+ *
+ * Such regex is matched backwards so inputs with wrong end are rejected
+ * after a few values.
+ *
+ * @tparam Regex   Regular expression.
+ * @tparam Enabled If regex is anchored only at the end.
+ */
+template<typename Regex, bool Enabled =
+    regex_anchors<typename Regex::rule>::end && !regex_anchors<typename Regex::rule>::begin>
+struct regex_reverse : regex_reverse_rule<void> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for regex anchored only at the end.
+ */
+template<typename Regex>
+struct regex_reverse<Regex, true> : regex_reverse_rule<typename Regex::match_rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief If iterator can be used for backward matching.
+ *
+ * @tparam Iterator Input iterator.
+ */
+template<typename Iterator>
+using regex_bidirectional = std::is_base_of<
+    std::bidirectional_iterator_tag,
+    typename std::iterator_traits<Iterator>::iterator_category
+>;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Returns if input length is in range of regex match lengths.
+ *
+ * Regex anchored at the end must match the whole input, otherwise the
+ * input must be at least as long as the shortest match.
+ */
+template<typename Regex, typename Iterator>
+bool regex_match_length(const Iterator first, const Iterator last, std::true_type) noexcept
+{
+    const auto size = static_cast<std::size_t>(last - first);
+
+    return
+        (size >= Regex::min_length) &&
+        (!regex_anchors<typename Regex::rule>::end || size <= Regex::max_length)
+    ;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Input length is unknown without reading the input.
+ */
+template<typename Regex, typename Iterator>
+bool regex_match_length(const Iterator first, const Iterator last, std::false_type) noexcept
+{
+    return true;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Returns if input length can be matched by regex.
+ *
+ * Only random access iterators are tested.
+ */
+template<typename Regex, typename Iterator>
+bool regex_match_length(const Iterator first, const Iterator last) noexcept
+{
+    return regex_match_length<Regex>(first, last, std::integral_constant<bool, std::is_same<
+        typename std::iterator_traits<Iterator>::iterator_category,
+        std::random_access_iterator_tag
+    >::value>{});
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match input forwards.
+ */
+template<typename Regex, typename Iterator>
+bool regex_match_rule(const Iterator first, const Iterator last, std::false_type)
+{
+    return rules::match<typename Regex::match_rule>(first, last);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match input backwards by reversed automaton.
+ */
+template<typename Regex, typename Iterator>
+bool regex_match_rule(const Iterator first, const Iterator last, std::true_type)
+{
+    return rules::match<typename regex_reverse<Regex>::full>(
+        std::reverse_iterator<Iterator>(last),
+        std::reverse_iterator<Iterator>(first)
+    );
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Perform input range matching.
+ *
+ * Inputs with length outside of regex match lengths are rejected without
+ * reading them. Regex anchored only at the end is matched backwards by
+ * reversed automaton over bidirectional iterators.
+ *
+ * @tparam Rule     Matching rule.
+ * @tparam Iterator Source sequence iterator type.
+ *
+ * @param rule
+ * @param first
+ * @param last
+ *
+ * @return If input sequence is matched by rule.
+ */
+template<typename Regex, typename Iterator>
+bool regex_match(const Regex& regex, Iterator first, const Iterator last)
+{
+    using reverse = typename regex_reverse<Regex>::full;
+
+    return
+        regex_match_length<Regex>(first, last) &&
+        regex_match_rule<Regex>(first, last, std::integral_constant<bool,
+            !std::is_void<reverse>::value && regex_bidirectional<Iterator>::value
+        >{})
+    ;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Perform input range matching.
+ *
+ * @tparam Rule   Matching rule.
+ * @tparam Source Source sequence.
+ *
+ * @param rule
+ * @param source
+ *
+ * @return If input sequence is matched by rule.
+ */
+template<typename Regex, typename Source>
+bool regex_match(const Regex& regex, Source&& source)
+{
+    return regex_match(regex, std::begin(source), std::end(source));
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match input with submatch results by NFA simulation.
+ *
+ * Inputs are rejected by DFA first when the regex has one, so NFA threads
+ * with groups are moved only for matched inputs.
+ */
+template<typename Regex, typename Iterator, std::size_t Size>
+bool regex_match_results(const Iterator first, const Iterator last,
+    std::array<std::pair<Iterator, Iterator>, Size>& results, std::false_type)
+{
+    using anchors = regex_anchors<typename Regex::rule>;
+
+    constexpr bool automaton = rules::automaton_states<typename Regex::match_rule>::after != 0;
+
+    if (automaton && !regex_match(Regex{}, first, last))
+        return false;
+
+    return rules::pike<typename anchors::inner, anchors::end>::match(first, last, results);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match input with submatch results by one-pass automaton.
+ */
+template<typename Regex, typename Iterator, std::size_t Size>
+bool regex_match_results(const Iterator first, const Iterator last,
+    std::array<std::pair<Iterator, Iterator>, Size>& results, std::true_type)
+{
+    using anchors = regex_anchors<typename Regex::rule>;
+
+    return rules::onepass<typename anchors::inner, anchors::end>::match(first, last, results);
+}
 
 /* ************************************************************************ */
 
 /**
- * @brief Perform input range matching.
+ * @brief Perform input range matching with submatch results.
+ *
+ * The first result is the whole match, then results of groups in order
+ * of their beginning. Groups that don't take part in the match have
+ * `last` positions.
+ *
+ * One-pass regex is matched by one-pass automaton in a single scan
+ * without allocation, otherwise it's matched by NFA simulation with
+ * groups (`pike.hpp`) that allocates slots of NFA threads. Both read the
+ * input once. They match the same inputs as automaton engines, regex
+ * matched by nested rules (`engine::nested`, wide characters) can reject
+ * inputs matched here because nested rules don't backtrack. Results are
+ * reset when the input is not matched.
  *
  * @tparam Rule     Matching rule.
  * @tparam Iterator Source sequence iterator type.
@@ -717,32 +1605,658 @@ struct basic_regex_str<CharT, basic_string<CharT, Chars...>>
  * @param rule
  * @param first
  * @param last
+ * @param results Match results, `Regex::results_type<Iterator>`.
  *
  * @return If input sequence is matched by rule.
  */
-template<typename Regex, typename Iterator>
-bool regex_match(const Regex& regex, Iterator first, const Iterator last)
+template<typename Regex, typename Iterator, std::size_t Size>
+bool regex_match(const Regex& regex, Iterator first, const Iterator last,
+    std::array<std::pair<Iterator, Iterator>, Size>& results)
 {
-    return rules::match<typename Regex::rule>(first, last);
+    static_assert(Size == Regex::groups + 1, "Results must have an item for the match and each group");
+
+    using anchors = regex_anchors<typename Regex::rule>;
+
+    results.fill({last, last});
+
+    if (!regex_match_length<Regex>(first, last))
+        return false;
+
+    const bool matched = regex_match_results<Regex>(first, last, results, std::integral_constant<bool,
+        sizeof(typename std::iterator_traits<Iterator>::value_type) == 1 &&
+        rules::is_onepass<typename anchors::inner>::value
+    >{});
+
+    if (!matched)
+        results.fill({last, last});
+
+    return matched;
 }
 
 /* ************************************************************************ */
 
 /**
- * @brief Perform input range matching.
+ * @brief Perform input range matching with submatch results.
  *
  * @tparam Rule   Matching rule.
  * @tparam Source Source sequence.
  *
  * @param rule
  * @param source
+ * @param results Match results, `Regex::results_type<Iterator>`.
  *
  * @return If input sequence is matched by rule.
  */
+template<typename Regex, typename Source, typename Iterator, std::size_t Size>
+bool regex_match(const Regex& regex, Source&& source,
+    std::array<std::pair<Iterator, Iterator>, Size>& results)
+{
+    return regex_match(regex, Iterator(std::begin(source)), Iterator(std::end(source)), results);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first occurrence of a literal.
+ *
+ * @param first  An iterator to the first value.
+ * @param last   An iterator to the value following the last value.
+ *
+ * @return Iterator to the literal or `last`.
+ */
+template<typename Iterator, int... Values>
+Iterator regex_find_literal(Iterator first, const Iterator last,
+    rules::int_seq<Values...>, std::false_type)
+{
+    static constexpr int literal[] = {Values...};
+
+    return std::search(first, last, std::begin(literal), std::end(literal),
+        [](typename std::iterator_traits<Iterator>::value_type value, int lit) {
+            return static_cast<int>(value) == lit;
+        }
+    );
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first occurrence of a literal in contiguous bytes.
+ *
+ * @param first  An iterator to the first value.
+ * @param last   An iterator to the value following the last value.
+ *
+ * @return Iterator to the literal or `last`.
+ */
+template<typename Iterator, int... Values>
+Iterator regex_find_literal(Iterator first, const Iterator last,
+    rules::int_seq<Values...>, std::true_type)
+{
+    static constexpr char literal[] = {static_cast<char>(Values)...};
+
+    if (first == last)
+        return last;
+
+    const char* const begin = simd::address(first);
+    const char* const found = simd::find_literal(begin, begin + (last - first),
+        literal, sizeof...(Values));
+
+    return first + (found - begin);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Literal fingerprints of literal set.
+ *
+ * @tparam Set Set of literals.
+ */
+template<typename Set>
+struct regex_literal_filter;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Literal fingerprints of literal set.
+ */
+template<typename... Literals>
+struct regex_literal_filter<rules::literal_set<Literals...>>
+{
+
+    /**
+     * @brief Add literal into filter.
+     */
+    template<int... Values>
+    static constexpr int add(simd::literal_filter& filter, unsigned index,
+        rules::int_seq<Values...>) noexcept
+    {
+        const char literal[] = {static_cast<char>(Values)...};
+
+        filter.add(literal, sizeof...(Values), index);
+
+        return 0;
+    }
+
+
+    /**
+     * @brief Create filter.
+     */
+    static constexpr simd::literal_filter make() noexcept
+    {
+        simd::literal_filter res;
+        unsigned index = 0;
+
+        const int dummy[] = {add(res, index++, Literals{})...};
+        (void) dummy;
+
+        return res;
+    }
+
+
+    /// Literal fingerprints.
+    static constexpr simd::literal_filter value = make();
+
+};
+
+/* ************************************************************************ */
+
+template<typename... Literals>
+constexpr simd::literal_filter regex_literal_filter<rules::literal_set<Literals...>>::value;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first position where one of literals can start.
+ *
+ * @param first  An iterator to the first value.
+ * @param last   An iterator to the value following the last value.
+ *
+ * @return Iterator to the candidate or `last`.
+ */
+template<typename Iterator, typename Set>
+Iterator regex_find_literals(Iterator first, const Iterator last, Set)
+{
+    if (first == last)
+        return last;
+
+    const char* const begin = simd::address(first);
+    const char* const found = simd::find_literals(begin, begin + (last - first),
+        regex_literal_filter<Set>::value);
+
+    return first + (found - begin);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rule for unanchored searching by automaton.
+ *
+ * Other rules cannot be searched in single pass.
+ *
+ * @tparam Rule Matching rule.
+ */
+template<typename Rule>
+struct regex_search_rule
+{
+    using type = void;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for automaton: ".*{Rule}".
+ *
+ * The unanchored DFA can be much larger than the DFA of the rule so it's
+ * not used when it has too many states.
+ */
+template<typename Rule, bool Full, typename Backend>
+struct regex_search_rule<rules::automaton<Rule, Full, Backend>>
+{
+    using _unanchored = rules::sequence<rules::repeat_optional<rules::any>, Rule>;
+
+    using type = typename std::conditional<rules::automaton_fits<_unanchored>::value,
+        rules::automaton<_unanchored, Full, Backend>,
+        void
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for NFA simulation: ".*{Rule}".
+ *
+ * The unanchored NFA has only a few more states so it's simulated in single
+ * pass too.
+ */
+template<typename Rule, bool Full>
+struct regex_search_rule<rules::nfa_automaton<Rule, Full>>
+{
+    using type = rules::nfa_automaton<rules::sequence<rules::repeat_optional<rules::any>, Rule>, Full>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Minimum input size for required literal check.
+ *
+ * Shorter inputs are matched directly.
+ */
+constexpr std::size_t regex_required_size = 256;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Searching implementation.
+ *
+ * The strategy is selected in compile time:
+ *  - Regex anchored only at the end is matched backwards from the end
+ *    by reversed automaton (bidirectional iterators only).
+ *  - Regex anchored at the beginning is matched only at the beginning.
+ *  - If every match starts with a literal, the literal is found by
+ *    vectorized scan and the regex is matched only there.
+ *  - If every match starts with one of few literals, candidates are found
+ *    by vectorized fingerprint filter (contiguous bytes only) and the
+ *    regex is matched only there.
+ *  - Automaton searches in single pass with ".*" prefix.
+ *  - If a match cannot start with some bytes, positions with them are
+ *    skipped by vectorized scan (contiguous bytes only).
+ *  - Otherwise, the regex is matched at each position.
+ *
+ * Long contiguous inputs without the longest required literal (a literal
+ * contained in each match) are rejected by vectorized literal scan before
+ * forward strategies other than literal prefix.
+ *
+ * Match positions are found by automaton: the forward search finds the
+ * end of the match that ends first and the reversed automaton finds the
+ * leftmost start of a match with this end.
+ *
+ * @tparam Regex Regular expression.
+ */
+template<typename Regex>
+struct regex_searcher
+{
+
+// Private Types
+private:
+
+
+    /// Regex anchors.
+    using _anchors = regex_anchors<typename Regex::rule>;
+
+    /// Literal prefix.
+    using _prefix = typename rules::literal_prefix<typename _anchors::inner>::type;
+
+    /// Literal prefixes.
+    using _literals = typename rules::literal_prefixes<typename _anchors::inner>::type;
+
+    /// Unanchored automaton.
+    using _search_rule = typename regex_search_rule<typename Regex::match_rule>::type;
+
+    /// The longest literal contained in each match.
+    using _required = typename rules::literal_set_longest<
+        typename rules::required_literals<typename _anchors::inner>::type
+    >::type;
+
+    /// If match can start with any byte.
+    static constexpr bool _any_first = (~rules::first_set<typename _anchors::inner>::set()).empty();
+
+
+    /// Reversed automaton for regex anchored only at the end.
+    using _reverse_rule = typename regex_reverse<Regex>::type;
+
+
+    /// Searching strategies.
+    enum class strategy { reverse, anchored, prefix, literals, automaton, first, naive };
+
+    template<strategy S>
+    using strategy_tag = std::integral_constant<strategy, S>;
+
+    /// Maximum number of literals for the literals strategy.
+    static constexpr std::size_t max_literals = 4 * simd::literal_filter::buckets;
+
+    /**
+     * @brief Select strategy for iterator.
+     */
+    template<typename Iterator>
+    static constexpr strategy select() noexcept
+    {
+        return
+            !std::is_void<_reverse_rule>::value &&
+                regex_bidirectional<Iterator>::value ? strategy::reverse :
+            _anchors::begin ? strategy::anchored :
+            !std::is_same<_prefix, rules::int_seq<>>::value ? strategy::prefix :
+            simd::contiguous<Iterator>::value &&
+                _literals::size != 0 && _literals::size <= max_literals ? strategy::literals :
+            !std::is_void<_search_rule>::value ? strategy::automaton :
+            simd::contiguous<Iterator>::value &&
+                !rules::nullable<typename _anchors::inner>::value && !_any_first ? strategy::first :
+            strategy::naive
+        ;
+    }
+
+
+    /// Bytes that cannot be the first byte of a match.
+    static constexpr simd::byte_class _not_first{
+        (~rules::first_set<typename _anchors::inner>::set()).bits[0],
+        (~rules::first_set<typename _anchors::inner>::set()).bits[1],
+        (~rules::first_set<typename _anchors::inner>::set()).bits[2],
+        (~rules::first_set<typename _anchors::inner>::set()).bits[3]
+    };
+
+
+// Public Operations
+public:
+
+
+    /**
+     * @brief Search for the first match.
+     *
+     * @param first An iterator to the first value.
+     * @param last  An iterator to the value following the last value.
+     *
+     * @return If input contains match.
+     */
+    template<typename Iterator>
+    static bool search(Iterator first, const Iterator last)
+    {
+        constexpr strategy selected = select<Iterator>();
+
+        return
+            contains_required(first, last, std::integral_constant<bool,
+                simd::contiguous<Iterator>::value &&
+                selected != strategy::prefix &&
+                selected != strategy::reverse &&
+                !std::is_same<_required, rules::int_seq<>>::value
+            >{}) &&
+            search(first, last, strategy_tag<selected>{})
+        ;
+    }
+
+
+    /**
+     * @brief Search for positions of the first match.
+     *
+     * @param first An iterator to the first value.
+     * @param last  An iterator to the value following the last value.
+     * @param match Positions of the match.
+     *
+     * @return If input contains match.
+     */
+    template<typename Iterator>
+    static bool find(Iterator first, const Iterator last, std::pair<Iterator, Iterator>& match)
+    {
+        return find(first, last, match, std::integral_constant<int,
+            _anchors::begin ? 0 : _anchors::end ? 1 : 2
+        >{});
+    }
+
+
+// Private Operations
+private:
+
+
+    /**
+     * @brief Returns if long input contains the required literal.
+     */
+    template<typename Iterator>
+    static bool contains_required(Iterator first, const Iterator last, std::true_type)
+    {
+        if (static_cast<std::size_t>(last - first) < regex_required_size)
+            return true;
+
+        return regex_find_literal(first, last, _required{}, std::true_type{}) != last;
+    }
+
+
+    /**
+     * @brief Required literal is not checked.
+     */
+    template<typename Iterator>
+    static bool contains_required(Iterator first, const Iterator last, std::false_type)
+    {
+        return true;
+    }
+
+
+    /**
+     * @brief Find match of regex anchored at the beginning.
+     */
+    template<typename Iterator>
+    static bool find(Iterator first, const Iterator last,
+        std::pair<Iterator, Iterator>& match, std::integral_constant<int, 0>)
+    {
+        Iterator it = first;
+
+        if (!Regex::match_rule::match_ref(it, last))
+            return false;
+
+        match = {first, it};
+
+        return true;
+    }
+
+
+    /**
+     * @brief Find match of regex anchored only at the end.
+     */
+    template<typename Iterator>
+    static bool find(Iterator first, const Iterator last,
+        std::pair<Iterator, Iterator>& match, std::integral_constant<int, 1>)
+    {
+        static_assert(!std::is_void<_reverse_rule>::value,
+            "Match positions are found by reversed automaton");
+
+        std::reverse_iterator<Iterator> it{last};
+
+        if (!_reverse_rule::match_ref(it, std::reverse_iterator<Iterator>{first}))
+            return false;
+
+        match = {it.base(), last};
+
+        return true;
+    }
+
+
+    /**
+     * @brief Find match of unanchored regex.
+     */
+    template<typename Iterator>
+    static bool find(Iterator first, const Iterator last,
+        std::pair<Iterator, Iterator>& match, std::integral_constant<int, 2>)
+    {
+        using reverse = typename regex_reverse_rule<typename Regex::match_rule>::type;
+
+        static_assert(!std::is_void<_search_rule>::value && !std::is_void<reverse>::value,
+            "Match positions are found by automaton and reversed automaton");
+
+        Iterator end = first;
+
+        if (!_search_rule::match_shortest(end, last))
+            return false;
+
+        std::reverse_iterator<Iterator> it{end};
+        reverse::match_ref(it, std::reverse_iterator<Iterator>{first});
+
+        match = {it.base(), end};
+
+        return true;
+    }
+
+
+    template<typename Iterator>
+    static bool search(Iterator first, const Iterator last, strategy_tag<strategy::reverse>)
+    {
+        return _reverse_rule::match_any(
+            std::reverse_iterator<Iterator>{last},
+            std::reverse_iterator<Iterator>{first}
+        );
+    }
+
+
+    template<typename Iterator>
+    static bool search(Iterator first, const Iterator last, strategy_tag<strategy::anchored>)
+    {
+        return rules::match<typename Regex::match_rule>(first, last);
+    }
+
+
+    template<typename Iterator>
+    static bool search(Iterator first, const Iterator last, strategy_tag<strategy::prefix>)
+    {
+        for (Iterator it = first; ; ++it)
+        {
+            it = regex_find_literal(it, last, _prefix{}, simd::contiguous<Iterator>{});
+
+            if (it == last)
+                return false;
+
+            if (rules::match<typename Regex::match_rule>(it, last))
+                return true;
+        }
+    }
+
+
+    template<typename Iterator>
+    static bool search(Iterator first, const Iterator last, strategy_tag<strategy::literals>)
+    {
+        for (Iterator it = first; ; ++it)
+        {
+            it = regex_find_literals(it, last, _literals{});
+
+            if (it == last)
+                return false;
+
+            if (rules::match<typename Regex::match_rule>(it, last))
+                return true;
+        }
+    }
+
+
+    template<typename Iterator>
+    static bool search(Iterator first, const Iterator last, strategy_tag<strategy::automaton>)
+    {
+        return search_automaton(first, last, std::integral_constant<bool, _anchors::end>{});
+    }
+
+
+    template<typename Iterator>
+    static bool search_automaton(Iterator first, const Iterator last, std::true_type)
+    {
+        return rules::match<_search_rule>(first, last);
+    }
+
+
+    template<typename Iterator>
+    static bool search_automaton(Iterator first, const Iterator last, std::false_type)
+    {
+        return _search_rule::match_any(first, last);
+    }
+
+
+    template<typename Iterator>
+    static bool search(Iterator first, const Iterator last, strategy_tag<strategy::first>)
+    {
+        for (Iterator it = first; ; ++it)
+        {
+            if (it != last)
+            {
+                const char* const begin = simd::address(it);
+                it += simd::span_class(begin, begin + (last - it), _not_first) - begin;
+            }
+
+            // Match is not empty
+            if (it == last)
+                return false;
+
+            if (rules::match<typename Regex::match_rule>(it, last))
+                return true;
+        }
+    }
+
+
+    template<typename Iterator>
+    static bool search(Iterator first, const Iterator last, strategy_tag<strategy::naive>)
+    {
+        for (Iterator it = first; ; ++it)
+        {
+            if (rules::match<typename Regex::match_rule>(it, last))
+                return true;
+
+            if (it == last)
+                return false;
+        }
+    }
+
+};
+
+/* ************************************************************************ */
+
+template<typename Regex>
+constexpr simd::byte_class regex_searcher<Regex>::_not_first;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Search input range for a match.
+ *
+ * @tparam Regex    Regular expression.
+ * @tparam Iterator Source sequence iterator type.
+ *
+ * @param regex
+ * @param first
+ * @param last
+ *
+ * @return If any part of the input sequence is matched by regex.
+ */
+template<typename Regex, typename Iterator>
+bool regex_search(const Regex& regex, Iterator first, const Iterator last)
+{
+    return regex_searcher<Regex>::search(first, last);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Search input range for a match.
+ *
+ * @tparam Regex  Regular expression.
+ * @tparam Source Source sequence.
+ *
+ * @param regex
+ * @param source
+ *
+ * @return If any part of the input sequence is matched by regex.
+ */
 template<typename Regex, typename Source>
-bool regex_match(const Regex& regex, Source&& source)
+bool regex_search(const Regex& regex, Source&& source)
 {
-    return regex_match(regex, std::begin(source), std::end(source));
+    return regex_search(regex, std::begin(source), std::end(source));
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Search input range for a match and its positions.
+ *
+ * The match is the match that ends first, it starts at the leftmost
+ * position of matches with this end. Positions are found by automaton
+ * so regex must be matched by automaton unless it's anchored at the
+ * beginning.
+ *
+ * @tparam Regex    Regular expression.
+ * @tparam Iterator Source sequence iterator type.
+ *
+ * @param regex
+ * @param first
+ * @param last
+ * @param match Positions of the match.
+ *
+ * @return If any part of the input sequence is matched by regex.
+ */
+template<typename Regex, typename Iterator>
+bool regex_search(const Regex& regex, Iterator first, const Iterator last,
+    std::pair<Iterator, Iterator>& match)
+{
+    return regex_searcher<Regex>::find(first, last, match);
 }
 
 /* ************************************************************************ */
@@ -820,6 +2334,17 @@ using u32regex = basic_regex<char32_t, Chars...>;
 
 /* ************************************************************************ */
 
+/**
+ * @brief Create case-insensitive template regular expression object.
+ *
+ * @param str Regular expression string.
+ *
+ * @return Rules object.
+ */
+#define make_regex_icase(str) make_regex_t(str)::with_icase{}
+
+/* ************************************************************************ */
+
 }
 
 /* ************************************************************************ */
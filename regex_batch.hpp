@@ -0,0 +1,573 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file regex_batch.hpp
+ *
+ * This header contains matching of many short inputs with interleaved
+ * execution of the automaton.
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+// Library
+#include "automaton.hpp"
+#include "regex.hpp"
+#include "simd.hpp"
+
+/* ************************************************************************ */
+
+namespace template_regex {
+
+/* ************************************************************************ */
+
+/**
+ * @brief A number of inputs matched together by `regex_match_batch`.
+ *
+ * Out-of-order cores already overlap transitions of consecutive short
+ * inputs and the interleaved loop is slower there because of its
+ * bookkeeping. More lanes help in-order cores.
+ */
+constexpr std::size_t regex_batch_lanes = 1;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Maximum number of automaton states matched by SIMD lanes.
+ *
+ * The transition table has 256 entries of 4 bytes for each state.
+ */
+constexpr std::size_t regex_batch_simd_states = 64;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Transition table for `simd::run_dfa_lanes`.
+ *
+ * @tparam States Number of states including the dead state.
+ */
+template<std::size_t States>
+struct regex_batch_simd_table
+{
+    /// Transitions indexed by state (multiple of 256) and byte.
+    int next[States * 256] = {};
+
+    /// Starting state.
+    int start = 0;
+
+    /// The first state that cannot be left.
+    int sink = 0;
+
+    /// Accepting states indexed by state / 256.
+    bool accept[States] = {};
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Create transition table for SIMD lanes.
+ *
+ * States are ordered so states that cannot be left are the last. For
+ * regex not anchored at the end, accepting states cannot be left because
+ * the result is known.
+ *
+ * @tparam Table Result table type.
+ *
+ * @param table Transition table with the dead state.
+ * @param end   If regex is anchored at the end.
+ *
+ * @return Transition table.
+ */
+template<typename Table, typename State, std::size_t States, std::size_t Classes>
+constexpr Table make_regex_batch_simd_table(const rules::dfa_table<State, States, Classes>& table,
+    bool end) noexcept
+{
+    bool sink[States] = {};
+
+    for (std::size_t state = 0; state < States; ++state)
+    {
+        sink[state] = !end && table.accept[state];
+
+        for (std::size_t c = 0; !sink[state] && c < 256; ++c)
+        {
+            if (table.next[state][table.class_of[c]] != state)
+                break;
+
+            sink[state] = c == 255;
+        }
+    }
+
+    std::size_t order[States] = {};
+    std::size_t count = 0;
+
+    for (std::size_t state = 0; state < States; ++state)
+    {
+        if (!sink[state])
+            order[state] = count++;
+    }
+
+    Table res;
+    res.sink = static_cast<int>(count * 256);
+
+    for (std::size_t state = 0; state < States; ++state)
+    {
+        if (sink[state])
+            order[state] = count++;
+    }
+
+    res.start = static_cast<int>(order[0] * 256);
+
+    for (std::size_t state = 0; state < States; ++state)
+    {
+        res.accept[order[state]] = table.accept[state];
+
+        for (std::size_t c = 0; c < 256; ++c)
+        {
+            res.next[order[state] * 256 + c] = static_cast<int>(sink[state]
+                ? order[state] * 256
+                : order[table.next[state][table.class_of[c]]] * 256
+            );
+        }
+    }
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief SIMD lanes automaton of rule.
+ *
+ * @tparam Rule Rule without anchors.
+ * @tparam End  If regex is anchored at the end.
+ */
+template<typename Rule, bool End>
+struct regex_batch_simd_automaton
+{
+    /// Source table.
+    using source = rules::automaton_table<Rule>;
+
+    /// Table type.
+    using table_type = regex_batch_simd_table<source::states>;
+
+    /// Transition table.
+    static constexpr table_type value = make_regex_batch_simd_table<table_type>(source::value, End);
+};
+
+/* ************************************************************************ */
+
+template<typename Rule, bool End>
+constexpr typename regex_batch_simd_automaton<Rule, End>::table_type regex_batch_simd_automaton<Rule, End>::value;
+
+/* ************************************************************************ */
+
+/**
+ * @brief If regex is matched by SIMD lanes.
+ *
+ * @tparam Regex     Regular expression.
+ * @tparam Lanes     A number of lanes.
+ * @tparam Supported If regex can be converted into automaton within the
+ *                   state limit.
+ */
+template<typename Regex, std::size_t Lanes, bool Supported>
+struct regex_batch_simd : std::integral_constant<bool,
+    Lanes == simd::dfa_lanes &&
+    rules::automaton_table<typename regex_anchors<typename Regex::rule>::inner>::states <= regex_batch_simd_states
+> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for regex that cannot be converted into automaton.
+ */
+template<typename Regex, std::size_t Lanes>
+struct regex_batch_simd<Regex, Lanes, false> : std::false_type {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Batch matcher of regular expression.
+ *
+ * Inputs are matched by transition table with the result decided when
+ * the input ends instead of nested rule calls. Single input is matched by
+ * a chain of dependent table loads, so each byte waits for the previous
+ * transition. With more lanes, automatons of several independent inputs
+ * are advanced in the same loop and their loads overlap.
+ *
+ * With `simd::dfa_lanes` lanes, automatons up to `regex_batch_simd_states`
+ * states are advanced by AVX2 gathers (opt-in, the default is one lane).
+ * There is no AVX-512 implementation.
+ *
+ * @tparam Regex Regular expression.
+ * @tparam Lanes A number of inputs matched together.
+ */
+template<typename Regex, std::size_t Lanes = regex_batch_lanes>
+struct regex_batch
+{
+
+// Pre-conditions
+private:
+
+
+    static_assert(Lanes > 0, "At least one lane is required");
+
+
+// Private Types
+private:
+
+
+    /// Regex anchors.
+    using _anchors = regex_anchors<typename Regex::rule>;
+
+    /// If automaton of the regex fits into the state limit.
+    static constexpr bool _fits = rules::automaton_fits<typename _anchors::inner>::value;
+
+    /// State machine, unused placeholder when inputs are matched separately.
+    using _machine = rules::table_backend::machine<
+        typename std::conditional<_fits, typename _anchors::inner, rules::null_rule>::type
+    >;
+
+    /// State type.
+    using state_type = typename _machine::state_type;
+
+
+// Private Types
+private:
+
+
+    /// Implementations.
+    enum class strategy { separate, lanes, gather };
+
+    template<strategy S>
+    using strategy_tag = std::integral_constant<strategy, S>;
+
+
+// Public Constants
+public:
+
+
+    /// If inputs are matched by table, otherwise each is matched by `regex_match`.
+    static constexpr bool interleaved = _fits;
+
+    /// If inputs are matched by SIMD lanes (`Lanes` is `simd::dfa_lanes`).
+    static constexpr bool gathered = regex_batch_simd<Regex, Lanes, interleaved>::value;
+
+
+// Public Operations
+public:
+
+
+    /**
+     * @brief Match each input.
+     *
+     * @param first An iterator to the first input.
+     * @param last  An iterator to the input following the last input.
+     * @param out   Output iterator for match result of each input.
+     *
+     * @return A number of matched inputs.
+     */
+    template<typename InputIt, typename OutputIt>
+    static std::size_t match(InputIt first, const InputIt last, OutputIt out)
+    {
+        using iterator = decltype(std::begin(*first));
+
+        return match(first, last, out, strategy_tag<
+            !interleaved || !simd::contiguous<iterator>::value ? strategy::separate :
+            gathered ? strategy::gather :
+            strategy::lanes
+        >{});
+    }
+
+
+// Private Operations
+private:
+
+
+    /**
+     * @brief Match each input separately.
+     */
+    template<typename InputIt, typename OutputIt>
+    static std::size_t match(InputIt first, const InputIt last, OutputIt out,
+        strategy_tag<strategy::separate>)
+    {
+        std::size_t count = 0;
+
+        for (; first != last; ++first, ++out)
+        {
+            const bool res = regex_match(Regex{}, *first);
+            *out = res;
+            count += res;
+        }
+
+        return count;
+    }
+
+
+    /**
+     * @brief Match inputs in groups of lanes.
+     */
+    template<typename InputIt, typename OutputIt>
+    static std::size_t match(InputIt first, const InputIt last, OutputIt out,
+        strategy_tag<strategy::lanes>)
+    {
+        const unsigned char* pos[Lanes];
+        std::size_t size[Lanes];
+        bool res[Lanes];
+        std::size_t count = 0;
+
+        while (first != last)
+        {
+            // Fill lanes, missing inputs are empty
+            std::size_t lanes = 0;
+
+            for (; lanes < Lanes && first != last; ++lanes, ++first)
+            {
+                const auto begin = std::begin(*first);
+
+                size[lanes] = static_cast<std::size_t>(std::end(*first) - begin);
+                pos[lanes] = size[lanes] ? reinterpret_cast<const unsigned char*>(simd::address(begin)) : nullptr;
+            }
+
+            for (std::size_t lane = lanes; lane < Lanes; ++lane)
+            {
+                size[lane] = 0;
+                pos[lane] = nullptr;
+            }
+
+            match_lanes(pos, size, res);
+
+            for (std::size_t lane = 0; lane < lanes; ++lane, ++out)
+            {
+                *out = res[lane];
+                count += res[lane];
+            }
+        }
+
+        return count;
+    }
+
+
+    /**
+     * @brief Match inputs by SIMD lanes.
+     */
+    template<typename InputIt, typename OutputIt>
+    static std::size_t match(InputIt first, const InputIt last, OutputIt out,
+        strategy_tag<strategy::gather>)
+    {
+        static constexpr unsigned char empty = 0;
+
+        const auto& table = regex_batch_simd_automaton<typename _anchors::inner, _anchors::end>::value;
+
+        const unsigned char* data[Lanes];
+        std::size_t length[Lanes];
+        int size[Lanes];
+        int state[Lanes];
+        std::size_t count = 0;
+
+        while (first != last)
+        {
+            // Fill lanes, missing inputs are empty
+            std::size_t lanes = 0;
+            bool fits = true;
+
+            for (; lanes < Lanes && first != last; ++lanes, ++first)
+            {
+                const auto begin = std::begin(*first);
+
+                length[lanes] = static_cast<std::size_t>(std::end(*first) - begin);
+                fits = fits && length[lanes] <= INT_MAX;
+                size[lanes] = static_cast<int>(length[lanes]);
+                data[lanes] = length[lanes] ? reinterpret_cast<const unsigned char*>(simd::address(begin)) : &empty;
+            }
+
+            for (std::size_t lane = 0; lane < Lanes; ++lane)
+            {
+                state[lane] = table.start;
+
+                if (lane >= lanes)
+                {
+                    size[lane] = 0;
+                    data[lane] = &empty;
+                }
+            }
+
+            if (fits)
+            {
+                simd::run_dfa_lanes(table.next, table.sink, data, size, state);
+            }
+            else
+            {
+                // Inputs too long for 32-bit lanes
+                for (std::size_t lane = 0; lane < lanes; ++lane)
+                {
+                    for (std::size_t i = 0; i < length[lane] && state[lane] < table.sink; ++i)
+                        state[lane] = table.next[state[lane] + data[lane][i]];
+                }
+            }
+
+            for (std::size_t lane = 0; lane < lanes; ++lane, ++out)
+            {
+                const bool res = table.accept[state[lane] / 256];
+                *out = res;
+                count += res;
+            }
+        }
+
+        return count;
+    }
+
+
+    /**
+     * @brief Match inputs of all lanes.
+     *
+     * @param pos  Input data.
+     * @param size Input sizes.
+     * @param res  Match results.
+     */
+    static void match_lanes(const unsigned char* const (&pos)[Lanes],
+        const std::size_t (&size)[Lanes], bool (&res)[Lanes]) noexcept
+    {
+        // Not a char type so stores don't alias the input
+        unsigned state[Lanes];
+        std::size_t common = size[0];
+
+        for (std::size_t lane = 0; lane < Lanes; ++lane)
+        {
+            state[lane] = _machine::start;
+            res[lane] = !_anchors::end && _machine::accepting(_machine::start);
+            common = size[lane] < common ? size[lane] : common;
+        }
+
+        // All lanes have input, the dead state is a sink so lanes are
+        // advanced without branches
+        for (std::size_t i = 0; i < common; ++i)
+        {
+            bool running = false;
+
+            for (std::size_t lane = 0; lane < Lanes; ++lane)
+            {
+                state[lane] = next(state[lane], pos[lane][i]);
+
+                if (!_anchors::end)
+                    res[lane] |= _machine::accepting(state[lane]);
+
+                running |= !_machine::dead(state[lane]) && !res[lane];
+            }
+
+            if (!running)
+                break;
+        }
+
+        // The rest of longer inputs
+        for (std::size_t lane = 0; lane < Lanes; ++lane)
+        {
+            for (std::size_t i = common; i < size[lane] && !res[lane] && !_machine::dead(state[lane]); ++i)
+            {
+                state[lane] = next(state[lane], pos[lane][i]);
+
+                if (!_anchors::end)
+                    res[lane] = _machine::accepting(state[lane]);
+            }
+
+            if (_anchors::end)
+                res[lane] = _machine::accepting(state[lane]);
+        }
+    }
+
+
+    /**
+     * @brief Returns next state.
+     */
+    static unsigned next(unsigned state, unsigned char c) noexcept
+    {
+        return _machine::next(static_cast<state_type>(state), c);
+    }
+
+};
+
+/* ************************************************************************ */
+
+template<typename Regex, std::size_t Lanes>
+constexpr bool regex_batch<Regex, Lanes>::interleaved;
+
+template<typename Regex, std::size_t Lanes>
+constexpr bool regex_batch<Regex, Lanes>::gathered;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match many inputs by regular expression.
+ *
+ * The result is same as calling `regex_match` for each input, but short
+ * inputs are matched faster because automatons of several inputs are
+ * advanced together.
+ *
+ * @tparam Regex    Regular expression.
+ * @tparam InputIt  Iterator of inputs.
+ * @tparam OutputIt Output iterator of results.
+ *
+ * @param regex
+ * @param first     An iterator to the first input.
+ * @param last      An iterator to the input following the last input.
+ * @param out       Output iterator for match result of each input.
+ *
+ * @return A number of matched inputs.
+ */
+template<typename Regex, typename InputIt, typename OutputIt>
+std::size_t regex_match_batch(const Regex& regex, InputIt first, const InputIt last, OutputIt out)
+{
+    return regex_batch<Regex>::match(first, last, out);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match many inputs by regular expression.
+ *
+ * @tparam Regex    Regular expression.
+ * @tparam Source   Sequence of inputs.
+ * @tparam OutputIt Output iterator of results.
+ *
+ * @param regex
+ * @param source    Inputs.
+ * @param out       Output iterator for match result of each input.
+ *
+ * @return A number of matched inputs.
+ */
+template<typename Regex, typename Source, typename OutputIt>
+std::size_t regex_match_batch(const Regex& regex, Source&& source, OutputIt out)
+{
+    return regex_match_batch(regex, std::begin(source), std::end(source), out);
+}
+
+/* ************************************************************************ */
+
+}
+
+/* ************************************************************************ */
@@ -0,0 +1,479 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file regex_set.hpp
+ *
+ * This header contains set of regular expressions that are matched
+ * together by single pass over the input.
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <bitset>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Library
+#include "automaton.hpp"
+#include "regex.hpp"
+
+/* ************************************************************************ */
+
+namespace template_regex {
+
+/* ************************************************************************ */
+
+/**
+ * @brief If the product automaton can be created.
+ *
+ * @tparam Product   Merged rules.
+ * @tparam Supported If the rules can be converted into automaton.
+ */
+template<typename Product, bool Supported = rules::nfa_traits<Product>::supported>
+struct regex_set_product : std::integral_constant<bool,
+    rules::count_rule_dfa_states<Product>() < TEMPLATE_REGEX_AUTOMATON_MAX_STATES
+> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for rules that cannot be converted.
+ */
+template<typename Product>
+struct regex_set_product<Product, false> : std::false_type {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Product automaton of merged rules.
+ *
+ * @tparam Product Merged rules.
+ */
+template<typename Product>
+struct regex_set_automaton
+{
+    /// Automaton data.
+    using data = rules::automaton_data<Product>;
+
+    /// Number of states.
+    static constexpr std::size_t states = data::states;
+
+    /// Tags for each state.
+    struct tags_type
+    {
+        unsigned long long value[states > 0 ? states : 1] = {};
+    };
+
+
+    /**
+     * @brief Compute tags of states reachable from each state.
+     */
+    static constexpr tags_type make_reachable() noexcept
+    {
+        tags_type res;
+
+        for (std::size_t state = 0; state < states; ++state)
+            res.value[state] = data::value.accept[state];
+
+        for (bool changed = true; changed; )
+        {
+            changed = false;
+
+            for (std::size_t state = 0; state < states; ++state)
+            {
+                for (std::size_t cls = 0; cls < data::dfa_type::class_count; ++cls)
+                {
+                    const int target = data::value.next[state][cls];
+
+                    if (target >= 0 && (res.value[target] & ~res.value[state]))
+                    {
+                        res.value[state] |= res.value[target];
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        return res;
+    }
+
+
+    /// Tags that can be reached from each state. When all of them are
+    /// already seen the result cannot change.
+    static constexpr tags_type reachable = make_reachable();
+};
+
+/* ************************************************************************ */
+
+template<typename Product>
+constexpr typename regex_set_automaton<Product>::tags_type regex_set_automaton<Product>::reachable;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Create tags mask from flags.
+ *
+ * @return Mask with the n-th bit set when the n-th flag is set.
+ */
+constexpr unsigned long long regex_set_tags() noexcept
+{
+    return 0;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Create tags mask from flags.
+ *
+ * @param flag  The first flag.
+ * @param flags Remaining flags.
+ *
+ * @return Mask with the n-th bit set when the n-th flag is set.
+ */
+template<typename... Flags>
+constexpr unsigned long long regex_set_tags(bool flag, Flags... flags) noexcept
+{
+    return (flag ? 1ull : 0ull) | regex_set_tags(flags...) << 1;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Set of regular expressions.
+ *
+ * Each regular expression is matched in same way as by `regex_match`
+ * and the result contains a bit for each of them.
+ *
+ * The implementation is selected in compile time:
+ *  - Product automaton: rules of all regular expressions are merged into
+ *    a single DFA whose accepting states are tagged by matched regular
+ *    expressions (up to 64 regular expressions).
+ *  - Lockstep automatons: if the product automaton is too large, the
+ *    automaton of each regular expression is advanced by each input
+ *    value. Still a single pass over the input.
+ *  - Otherwise (multibyte values or DFA over the state limit), each
+ *    regular expression is matched separately by `regex_match`.
+ *
+ * @tparam Regexes Regular expressions.
+ */
+template<typename... Regexes>
+struct regex_set
+{
+
+// Pre-conditions
+private:
+
+
+    static_assert(sizeof...(Regexes) > 0, "Set cannot be empty");
+
+
+// Public Types
+public:
+
+
+    /// A number of regular expressions.
+    static constexpr std::size_t size = sizeof...(Regexes);
+
+    /// Matching result.
+    using result_type = std::bitset<size>;
+
+
+// Private Types
+private:
+
+
+    /// Merged rules.
+    using _product = rules::tagged_alternative<typename regex_anchors<typename Regexes::rule>::inner...>;
+
+
+// Public Constants
+public:
+
+
+    /// If regular expressions are merged into single automaton.
+    static constexpr bool merged = regex_set_product<_product>::value;
+
+
+// Private Types
+private:
+
+
+    /// Regular expression at index.
+    template<std::size_t Index>
+    using _regex = typename std::tuple_element<Index, std::tuple<Regexes...>>::type;
+
+    /// Anchors of regular expression at index.
+    template<std::size_t Index>
+    using _anchors = regex_anchors<typename _regex<Index>::rule>;
+
+    /// Table state machine of regular expression at index.
+    template<std::size_t Index>
+    using _machine = rules::table_backend::machine<typename _anchors<Index>::inner>;
+
+    template<bool... Values>
+    struct _bools {};
+
+    /// If all rules can be converted into automaton within the state limit.
+    static constexpr bool _supported = std::is_same<
+        _bools<true, rules::automaton_fits<typename regex_anchors<typename Regexes::rule>::inner>::value...>,
+        _bools<rules::automaton_fits<typename regex_anchors<typename Regexes::rule>::inner>::value..., true>
+    >::value;
+
+    /// Tags of regular expressions anchored at the end.
+    static constexpr unsigned long long _end_tags =
+        regex_set_tags(regex_anchors<typename Regexes::rule>::end...);
+
+    /// Implementations.
+    enum class strategy { product, lockstep, separate };
+
+    template<strategy S>
+    using strategy_tag = std::integral_constant<strategy, S>;
+
+    /**
+     * @brief Select implementation for iterator.
+     */
+    template<typename Iterator>
+    static constexpr strategy select() noexcept
+    {
+        return
+            sizeof(typename std::iterator_traits<Iterator>::value_type) != 1 ? strategy::separate :
+            merged ? strategy::product :
+            _supported ? strategy::lockstep :
+            strategy::separate
+        ;
+    }
+
+
+// Public Operations
+public:
+
+
+    /**
+     * @brief Match input by all regular expressions.
+     *
+     * @param first An iterator to the first value.
+     * @param last  An iterator to the value following the last value.
+     *
+     * @return Matched regular expressions.
+     */
+    template<typename Iterator>
+    static result_type match(Iterator first, const Iterator last)
+    {
+        return match(first, last, strategy_tag<select<Iterator>()>{},
+            std::make_index_sequence<size>{});
+    }
+
+
+// Private Operations
+private:
+
+
+    template<typename Iterator, std::size_t... Indices>
+    static result_type match(Iterator first, const Iterator last,
+        strategy_tag<strategy::product>, std::index_sequence<Indices...>)
+    {
+        using automaton = regex_set_automaton<_product>;
+
+        const auto& dfa = automaton::data::value;
+
+        int state = 0;
+        unsigned long long seen = dfa.accept[0] & ~_end_tags;
+
+        for (; first != last; ++first)
+        {
+            // Nothing new can be matched
+            if (!(automaton::reachable.value[state] & ~seen))
+                return result_type(seen);
+
+            state = dfa.transition(state, static_cast<unsigned char>(*first));
+
+            if (state < 0)
+                return result_type(seen);
+
+            seen |= dfa.accept[state] & ~_end_tags;
+        }
+
+        return result_type(seen | (dfa.accept[state] & _end_tags));
+    }
+
+
+    template<typename Iterator, std::size_t... Indices>
+    static result_type match(Iterator first, const Iterator last,
+        strategy_tag<strategy::lockstep>, std::index_sequence<Indices...>)
+    {
+        unsigned short states[] = {_machine<Indices>::start...};
+        bool alive[] = {true_value<Indices>()...};
+        std::size_t running = size;
+        result_type res;
+
+        // Regular expressions that match empty prefix are done
+        const int init[] = {accept<Indices>(states[Indices], alive[Indices], running, res)...};
+        (void) init;
+
+        for (; first != last && running > 0; ++first)
+        {
+            const unsigned c = static_cast<unsigned char>(*first);
+            const int dummy[] = {step<Indices>(states[Indices], alive[Indices], running, res, c)...};
+            (void) dummy;
+        }
+
+        // Regular expressions anchored at the end
+        const int dummy[] = {finish<Indices>(states[Indices], alive[Indices], res, first == last)...};
+        (void) dummy;
+
+        return res;
+    }
+
+
+    template<typename Iterator, std::size_t... Indices>
+    static result_type match(Iterator first, const Iterator last,
+        strategy_tag<strategy::separate>, std::index_sequence<Indices...>)
+    {
+        result_type res;
+
+        const int dummy[] = {(res[Indices] = regex_match(_regex<Indices>{}, first, last), 0)...};
+        (void) dummy;
+
+        return res;
+    }
+
+
+    template<std::size_t Index>
+    static constexpr bool true_value() noexcept
+    {
+        return true;
+    }
+
+
+    /**
+     * @brief Finish regular expression that matched a prefix.
+     */
+    template<std::size_t Index, typename State>
+    static int accept(State state, bool& alive, std::size_t& running, result_type& res) noexcept
+    {
+        if (!_anchors<Index>::end && _machine<Index>::accepting(state))
+        {
+            res[Index] = true;
+            alive = false;
+            --running;
+        }
+
+        return 0;
+    }
+
+
+    /**
+     * @brief Advance automaton of regular expression.
+     */
+    template<std::size_t Index, typename State>
+    static int step(State& state, bool& alive, std::size_t& running, result_type& res,
+        unsigned c) noexcept
+    {
+        if (!alive)
+            return 0;
+
+        state = _machine<Index>::next(static_cast<typename _machine<Index>::state_type>(state), c);
+
+        if (_machine<Index>::dead(static_cast<typename _machine<Index>::state_type>(state)))
+        {
+            alive = false;
+            --running;
+            return 0;
+        }
+
+        return accept<Index>(state, alive, running, res);
+    }
+
+
+    /**
+     * @brief Finish regular expression anchored at the end.
+     */
+    template<std::size_t Index, typename State>
+    static int finish(State state, bool alive, result_type& res, bool complete) noexcept
+    {
+        if (_anchors<Index>::end && alive && complete)
+            res[Index] = _machine<Index>::accepting(static_cast<typename _machine<Index>::state_type>(state));
+
+        return 0;
+    }
+
+};
+
+/* ************************************************************************ */
+
+template<typename... Regexes>
+constexpr std::size_t regex_set<Regexes...>::size;
+
+template<typename... Regexes>
+constexpr bool regex_set<Regexes...>::merged;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match input range by set of regular expressions.
+ *
+ * @tparam Regexes  Regular expressions.
+ * @tparam Iterator Source sequence iterator type.
+ *
+ * @param set
+ * @param first
+ * @param last
+ *
+ * @return Regular expressions that matched the input.
+ */
+template<typename... Regexes, typename Iterator>
+std::bitset<sizeof...(Regexes)> regex_match(const regex_set<Regexes...>& set,
+    Iterator first, const Iterator last)
+{
+    return regex_set<Regexes...>::match(first, last);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match input range by set of regular expressions.
+ *
+ * @tparam Regexes Regular expressions.
+ * @tparam Source  Source sequence.
+ *
+ * @param set
+ * @param source
+ *
+ * @return Regular expressions that matched the input.
+ */
+template<typename... Regexes, typename Source>
+std::bitset<sizeof...(Regexes)> regex_match(const regex_set<Regexes...>& set, Source&& source)
+{
+    return regex_match(set, std::begin(source), std::end(source));
+}
+
+/* ************************************************************************ */
+
+}
+
+/* ************************************************************************ */
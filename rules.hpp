@@ -39,12 +39,17 @@
 /* ************************************************************************ */
 
 // C++
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <type_traits>
 #include <tuple>
 #include <utility>
 #include <functional>
 
+// Library
+#include "simd.hpp"
+
 /* ************************************************************************ */
 
 namespace template_regex {
@@ -64,6 +69,50 @@ struct int_seq { };
 
 /* ************************************************************************ */
 
+/**
+ * @brief Concatenate multiple `int_seq`.
+ *
+ * @tparam Seqs Concatenated sequences.
+ */
+template<typename... Seqs>
+struct int_seq_concat;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Concatenation of no sequences.
+ */
+template<>
+struct int_seq_concat<>
+{
+    using type = int_seq<>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Concatenation of single sequence.
+ */
+template<int... I>
+struct int_seq_concat<int_seq<I...>>
+{
+    using type = int_seq<I...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Concatenation of multiple sequences.
+ */
+template<int... I1, int... I2, typename... Seqs>
+struct int_seq_concat<int_seq<I1...>, int_seq<I2...>, Seqs...>
+    : int_seq_concat<int_seq<I1..., I2...>, Seqs...>
+{
+    // Nothing
+};
+
+/* ************************************************************************ */
+
 /**
  * @brief Sequence number range generator. The generated range is [S, E - 1].
  *
@@ -259,21 +308,59 @@ struct matcher
 
 /* ************************************************************************ */
 
+template<typename... Items>
+struct list_trie;
+
+/* ************************************************************************ */
+
 /**
  * @brief List of rules.
+ *
+ * Items are tried in order and the value of the first matched item is
+ * returned. When all items are literals, they are matched at once by
+ * `list_trie` and the value of the longest matched literal is returned.
  */
 template<typename Rule, typename... Rules>
 struct list
 {
     template<typename Out, typename Iterator>
     static Out match(Iterator& it, const Iterator end, Out def)
+    {
+        return match(it, end, def,
+            std::integral_constant<bool, list_trie<Rule, Rules...>::supported>{});
+    }
+
+
+    /**
+     * @brief Returns value of the first matched item.
+     */
+    template<typename Out, typename Iterator>
+    static Out match_first(Iterator& it, const Iterator end, Out def)
     {
         if (Rule::match(it, end))
         {
             return static_cast<Out>(Rule::value);
         }
 
-        return list<Rules...>::match(it, end, def);
+        return list<Rules...>::match_first(it, end, def);
+    }
+
+
+// Private Operations
+private:
+
+
+    template<typename Out, typename Iterator>
+    static Out match(Iterator& it, const Iterator end, Out def, std::true_type)
+    {
+        return list_trie<Rule, Rules...>::match(it, end, def);
+    }
+
+
+    template<typename Out, typename Iterator>
+    static Out match(Iterator& it, const Iterator end, Out def, std::false_type)
+    {
+        return match_first(it, end, def);
     }
 };
 
@@ -287,6 +374,16 @@ struct list<Rule>
 {
     template<typename Out, typename Iterator>
     static Out match(Iterator& it, const Iterator end, Out def)
+    {
+        return match_first(it, end, def);
+    }
+
+
+    /**
+     * @brief Returns value of the first matched item.
+     */
+    template<typename Out, typename Iterator>
+    static Out match_first(Iterator& it, const Iterator end, Out def)
     {
         if (Rule::match(it, end))
         {
@@ -308,6 +405,9 @@ struct list<Rule>
 template<typename Rule, int Value>
 struct item
 {
+    /// Matching rule.
+    using rule = Rule;
+
     /// Return value.
     static constexpr int value = Value;
 
@@ -414,6 +514,131 @@ struct capture : matcher<capture<Rule>>
 
 /* ************************************************************************ */
 
+/**
+ * @brief Submatch of the rule.
+ *
+ * Matching doesn't change, positions are stored by one-pass automaton
+ * (`onepass.hpp`) or backtracking matcher (`backtrack.hpp`).
+ *
+ * Regular Expression: "(Rule)"
+ *
+ * @tparam Index Submatch index, numbered from 1 by `number_groups`.
+ * @tparam Rule  Inner rule.
+ */
+template<unsigned Index, typename Rule>
+struct group : matcher<group<Index, Rule>>
+{
+    /// A number of outputs in the rule.
+    static const unsigned output_count = Rule::output_count;
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    {
+        return Rule::match_impl(it, end, out...);
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rule with already numbered inner rules.
+ *
+ * @tparam Rule     Rule template.
+ * @tparam Numbered Numbered inner rules.
+ */
+template<template<typename...> class Rule, typename... Numbered>
+struct number_groups_rule
+{
+    using type = Rule<Numbered...>;
+};
+
+/* ************************************************************************ */
+
+template<unsigned Next, typename Numbered, typename... Rules>
+struct number_groups_list;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Number `group` rules in order of their beginning.
+ *
+ * @tparam Rule Source rule.
+ * @tparam Next Index of the first group.
+ */
+template<typename Rule, unsigned Next = 1>
+struct number_groups
+{
+    /// Rule with numbered groups.
+    using type = Rule;
+
+    /// Index after the last group.
+    static constexpr unsigned next = Next;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for rules with inner rules.
+ */
+template<template<typename...> class Rule, typename... Rules, unsigned Next>
+struct number_groups<Rule<Rules...>, Next>
+{
+    using _list = number_groups_list<Next, number_groups_rule<Rule>, Rules...>;
+
+    using type = typename _list::type;
+    static constexpr unsigned next = _list::next;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule, unsigned Next>
+struct number_groups<group<Index, Rule>, Next>
+{
+    using _inner = number_groups<Rule, Next + 1>;
+
+    using type = group<Next, typename _inner::type>;
+    static constexpr unsigned next = _inner::next;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Number groups in list of inner rules.
+ *
+ * @tparam Next     Index of the next group.
+ * @tparam Numbered Rule with already numbered inner rules.
+ * @tparam Rules    Remaining inner rules.
+ */
+template<unsigned Next, typename Numbered, typename... Rules>
+struct number_groups_list
+{
+    using type = typename Numbered::type;
+    static constexpr unsigned next = Next;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Number groups in list of inner rules.
+ */
+template<unsigned Next, template<typename...> class Rule, typename... Numbered,
+    typename First, typename... Rules>
+struct number_groups_list<Next, number_groups_rule<Rule, Numbered...>, First, Rules...>
+{
+    using _first = number_groups<First, Next>;
+    using _rest = number_groups_list<_first::next,
+        number_groups_rule<Rule, Numbered..., typename _first::type>, Rules...>;
+
+    using type = typename _rest::type;
+    static constexpr unsigned next = _rest::next;
+};
+
+/* ************************************************************************ */
+
 /**
  * @brief Usefull struct for rule specialization (recursive stop rule).
  */
@@ -538,6 +763,196 @@ struct range  : value_matcher<range<Low, High>>
 
 /* ************************************************************************ */
 
+/**
+ * @brief Match case-insensitive letter range: "{Low}-{High}" or upper case.
+ *
+ * Lower and upper case ASCII letters differ only by 0x20 bit so the value
+ * is folded by single OR and compared with the lower case range.
+ *
+ * @param Low  The first lower case letter.
+ * @param High The last lower case letter.
+ */
+template<int Low, int High>
+struct range_icase : value_matcher<range_icase<Low, High>>
+{
+    // Pre-conditions
+    static_assert(Low >= 'a' && High <= 'z' && Low <= High, "Range must contain lower case letters");
+
+
+    /**
+     * @brief Check if given value match class rule.
+     *
+     * @tparam Val Value type.
+     *
+     * @param val Tested value.
+     */
+    template<typename Val>
+    static constexpr bool is(Val value)
+    {
+        return static_cast<unsigned>((static_cast<int>(value) | 0x20) - Low) <=
+            static_cast<unsigned>(High - Low);
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Bits of ASCII character classes stored in `ctype_table`.
+ */
+constexpr unsigned ctype_digit      = 0x001;
+constexpr unsigned ctype_upper      = 0x002;
+constexpr unsigned ctype_lower      = 0x004;
+constexpr unsigned ctype_underscore = 0x008;
+constexpr unsigned ctype_space      = 0x010;
+constexpr unsigned ctype_blank      = 0x020;
+constexpr unsigned ctype_punct      = 0x040;
+constexpr unsigned ctype_cntrl      = 0x080;
+constexpr unsigned ctype_xdigit     = 0x100;
+constexpr unsigned ctype_print_only = 0x200;
+
+constexpr unsigned ctype_alpha = ctype_upper | ctype_lower;
+constexpr unsigned ctype_alnum = ctype_alpha | ctype_digit;
+constexpr unsigned ctype_word  = ctype_alnum | ctype_underscore;
+constexpr unsigned ctype_graph = ctype_alnum | ctype_punct;
+constexpr unsigned ctype_print = ctype_graph | ctype_print_only;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Table of character class bits for each byte.
+ *
+ * Bytes above 127 don't belong to any class.
+ */
+struct ctype_table
+{
+
+    /// Class bits of bytes.
+    std::uint16_t bits[256];
+
+
+    /**
+     * @brief Constructor.
+     */
+    constexpr ctype_table() noexcept
+        : bits{}
+    {
+        for (unsigned c = 0; c < 128; ++c)
+        {
+            unsigned res = 0;
+
+            if (c >= '0' && c <= '9')
+                res |= ctype_digit | ctype_xdigit;
+            else if (c >= 'A' && c <= 'Z')
+                res |= ctype_upper | (c <= 'F' ? ctype_xdigit : 0);
+            else if (c >= 'a' && c <= 'z')
+                res |= ctype_lower | (c <= 'f' ? ctype_xdigit : 0);
+            else if (c == ' ')
+                res |= ctype_space | ctype_blank | ctype_print_only;
+            else if (c == '\t')
+                res |= ctype_space | ctype_blank | ctype_cntrl;
+            else if (c >= '\n' && c <= '\r')
+                res |= ctype_space | ctype_cntrl;
+            else if (c < 32 || c == 127)
+                res |= ctype_cntrl;
+            else
+                res |= ctype_punct | (c == '_' ? ctype_underscore : 0);
+
+            bits[c] = static_cast<std::uint16_t>(res);
+        }
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Shared instance of `ctype_table`.
+ */
+template<typename T = void>
+struct ctype_data
+{
+    static constexpr ctype_table value{};
+};
+
+/* ************************************************************************ */
+
+template<typename T>
+constexpr ctype_table ctype_data<T>::value;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match value from ASCII character class ("\d", "[:alpha:]", ...).
+ *
+ * The value is tested by single lookup into `ctype_table`. Values are
+ * compared as bytes.
+ *
+ * @param Mask    Class bits (`ctype_*` constants), any of them matches.
+ * @param Negated If values out of the class are matched ("\D", "\W", "\S").
+ */
+template<unsigned Mask, bool Negated = false>
+struct char_class : value_matcher<char_class<Mask, Negated>>
+{
+
+    /**
+     * @brief Check if given value match class rule.
+     *
+     * @tparam Val Value type.
+     *
+     * @param val Tested value.
+     */
+    template<typename Val>
+    static constexpr bool is(Val value)
+    {
+        return ((ctype_data<>::value.bits[static_cast<unsigned char>(value)] & Mask) != 0) != Negated;
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match value from set of bytes stored as 256-bit bitmap.
+ *
+ * The value is tested by single load and bit test regardless the number
+ * of ranges in the set. Values are compared as bytes.
+ *
+ * @param W0 Bits of bytes 0 - 63.
+ * @param W1 Bits of bytes 64 - 127.
+ * @param W2 Bits of bytes 128 - 191.
+ * @param W3 Bits of bytes 192 - 255.
+ */
+template<unsigned long long W0, unsigned long long W1, unsigned long long W2, unsigned long long W3>
+struct bitmap : value_matcher<bitmap<W0, W1, W2, W3>>
+{
+
+    /// Set bits.
+    static constexpr unsigned long long bits[4] = {W0, W1, W2, W3};
+
+
+    /**
+     * @brief Check if given value match class rule.
+     *
+     * @tparam Val Value type.
+     *
+     * @param val Tested value.
+     */
+    template<typename Val>
+    static constexpr bool is(Val value)
+    {
+        return (bits[static_cast<unsigned char>(value) >> 6] >> (static_cast<unsigned char>(value) & 63)) & 1;
+    }
+
+};
+
+/* ************************************************************************ */
+
+template<unsigned long long W0, unsigned long long W1, unsigned long long W2, unsigned long long W3>
+constexpr unsigned long long bitmap<W0, W1, W2, W3>::bits[4];
+
+/* ************************************************************************ */
+
 /**
  * @brief Rule that does nothing.
  */
@@ -682,30 +1097,117 @@ struct alternative_not<Rule> : matcher<alternative_not<Rule>>
 
 /* ************************************************************************ */
 
+template<typename Rule>
+struct class_traits;
+
+/* ************************************************************************ */
+
 /**
- * @brief Optional repeat - none or more.
- *
- *  - Regular expressions: {Rule}*
- *  - EBNF: { <Rule> }
+ * @brief Scanner of repeated character class.
  *
- * @param Rule Base rule
+ * @tparam Rule Character class rule.
  */
 template<typename Rule>
-struct repeat_optional : matcher<repeat_optional<Rule>>
+struct class_scanner
 {
 
-    /// A number of outputs in the rule.
-    static const unsigned output_count = Rule::output_count;
+    /// Class bytes.
+    static constexpr simd::byte_class value{
+        class_traits<Rule>::set().bits[0],
+        class_traits<Rule>::set().bits[1],
+        class_traits<Rule>::set().bits[2],
+        class_traits<Rule>::set().bits[3]
+    };
 
 
-    template<typename Iterator, typename... Output>
-    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    /**
+     * @brief Skip all values in the class.
+     *
+     * @param it  An iterator to the first value.
+     * @param end An iterator to the value following the last value.
+     *
+     * @return An iterator to the first value not in the class.
+     */
+    template<typename Iterator>
+    static Iterator scan(Iterator it, const Iterator end) noexcept
+    {
+        if (it == end)
+            return it;
+
+        const char* const first = simd::address(it);
+
+        return it + (simd::span_class(first, first + (end - it), value) - first);
+    }
+
+};
+
+/* ************************************************************************ */
+
+template<typename Rule>
+constexpr simd::byte_class class_scanner<Rule>::value;
+
+/* ************************************************************************ */
+
+/**
+ * @brief If repeated rule can be matched by `class_scanner`.
+ *
+ * @tparam Rule     Repeated rule.
+ * @tparam Iterator Input iterator.
+ */
+template<typename Rule, typename Iterator>
+struct class_scan : std::integral_constant<bool,
+    class_traits<Rule>::is_class && simd::contiguous<Iterator>::value
+> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Optional repeat - none or more.
+ *
+ *  - Regular expressions: {Rule}*
+ *  - EBNF: { <Rule> }
+ *
+ * Character classes over contiguous bytes are matched by vectorized
+ * `class_scanner`.
+ *
+ * @param Rule Base rule
+ */
+template<typename Rule>
+struct repeat_optional : matcher<repeat_optional<Rule>>
+{
+
+    /// A number of outputs in the rule.
+    static const unsigned output_count = Rule::output_count;
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    {
+        return match_loop(class_scan<Rule, Iterator>{}, it, end, out...);
+    }
+
+
+// Private Operations
+private:
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_loop(std::false_type, Iterator& it, const Iterator end, Output... out)
     {
         while (Rule::match_ref(it, end, out...))
             continue;
 
         return true;
     }
+
+
+    template<typename Iterator>
+    static bool match_loop(std::true_type, Iterator& it, const Iterator end)
+    {
+        it = class_scanner<Rule>::scan(it, end);
+
+        return true;
+    }
 };
 
 /* ************************************************************************ */
@@ -716,6 +1218,9 @@ struct repeat_optional : matcher<repeat_optional<Rule>>
  * - Regular expressions: {Rule}+
  * - EBNF: <Rule> { <Rule> }
  *
+ * Character classes over contiguous bytes are matched by vectorized
+ * `class_scanner`.
+ *
  * @param Rule Base rule
  */
 template<typename Rule>
@@ -728,6 +1233,17 @@ struct repeat : matcher<repeat<Rule>>
 
     template<typename Iterator, typename... Output>
     static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    {
+        return match_loop(class_scan<Rule, Iterator>{}, it, end, out...);
+    }
+
+
+// Private Operations
+private:
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_loop(std::false_type, Iterator& it, const Iterator end, Output... out)
     {
         unsigned int count = 0;
 
@@ -736,6 +1252,16 @@ struct repeat : matcher<repeat<Rule>>
 
         return (count != 0);
     }
+
+
+    template<typename Iterator>
+    static bool match_loop(std::true_type, Iterator& it, const Iterator end)
+    {
+        const Iterator first = it;
+        it = class_scanner<Rule>::scan(it, end);
+
+        return it != first;
+    }
 };
 
 /* ************************************************************************ */
@@ -764,6 +1290,277 @@ struct optional : matcher<optional<Rule>>
 
 /* ************************************************************************ */
 
+/**
+ * @brief Maximum count of `repeat_n` that means unbounded repetition.
+ */
+constexpr unsigned repeat_unbounded = ~0u;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Maximum count of repetitions that are unrolled by `repeat_n`.
+ */
+constexpr unsigned repeat_unroll = 8;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Unrolled matching of rule repeated given times.
+ *
+ * @tparam Rule  Repeated rule.
+ * @tparam Count Number of repetitions.
+ * @tparam Check If input end is checked before each repetition.
+ */
+template<typename Rule, unsigned Count, bool Check>
+struct repeat_unrolled
+{
+    template<typename Iterator, typename... Output>
+    static bool match(Iterator& it, const Iterator end, Output... out)
+    {
+        return
+            (!Check || it != end) &&
+            Rule::match_impl(it, end, out...) &&
+            repeat_unrolled<Rule, Count - 1, Check>::match(it, end, out...)
+        ;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Stop specialization for `repeat_unrolled`.
+ */
+template<typename Rule, bool Check>
+struct repeat_unrolled<Rule, 0, Check>
+{
+    template<typename Iterator, typename... Output>
+    static bool match(Iterator& it, const Iterator end, Output... out)
+    {
+        return true;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Counted repeat: {Rule}{Min,Max}
+ *
+ * The required repetitions are unrolled up to `repeat_unroll`, otherwise
+ * they are matched by counted loop. Character classes over random access
+ * iterators check the input length once for all required repetitions
+ * and contiguous bytes are matched by vectorized `class_scanner`.
+ *
+ * @tparam Rule Base rule.
+ * @tparam Min  Minimum number of repetitions.
+ * @tparam Max  Maximum number of repetitions or `repeat_unbounded`.
+ */
+template<typename Rule, unsigned Min, unsigned Max = Min>
+struct repeat_n : matcher<repeat_n<Rule, Min, Max>>
+{
+    // Pre-conditions
+    static_assert(Min <= Max, "Minimum count is greater than maximum count");
+
+
+    /// A number of outputs in the rule.
+    static const unsigned output_count = Rule::output_count;
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    {
+        return match_loop(class_scan<Rule, Iterator>{}, _counted<Iterator>{}, it, end, out...);
+    }
+
+
+// Private Types
+private:
+
+
+    /// If input length can be checked once before the repetitions.
+    template<typename Iterator>
+    using _counted = std::integral_constant<bool, class_traits<Rule>::is_class &&
+        std::is_same<
+            typename std::iterator_traits<Iterator>::iterator_category,
+            std::random_access_iterator_tag
+        >::value
+    >;
+
+    /// If required repetitions are unrolled.
+    using _unrolled = std::integral_constant<bool, (Min <= repeat_unroll)>;
+
+    /// If optional repetitions are too few for vectorized scan.
+    using _short = std::integral_constant<bool, (Max - Min <= repeat_unroll)>;
+
+
+// Private Operations
+private:
+
+
+    /**
+     * @brief Returns a number of values available for optional repetitions.
+     */
+    template<typename Iterator>
+    static unsigned available(const Iterator it, const Iterator end) noexcept
+    {
+        const auto size = end - it;
+
+        return static_cast<unsigned long long>(size) < Max - Min
+            ? static_cast<unsigned>(size)
+            : Max - Min
+        ;
+    }
+
+
+    /**
+     * @brief Match required repetitions by unrolled code.
+     */
+    template<bool Check, typename Iterator, typename... Output>
+    static bool match_required(std::true_type, Iterator& it, const Iterator end, Output... out)
+    {
+        return repeat_unrolled<Rule, Min, Check>::match(it, end, out...);
+    }
+
+
+    /**
+     * @brief Match required repetitions by counted loop.
+     */
+    template<bool Check, typename Iterator, typename... Output>
+    static bool match_required(std::false_type, Iterator& it, const Iterator end, Output... out)
+    {
+        for (unsigned i = 0; i < Min; ++i)
+        {
+            if ((Check && it == end) || !Rule::match_impl(it, end, out...))
+                return false;
+        }
+
+        return true;
+    }
+
+
+    /**
+     * @brief Match any rule.
+     */
+    template<typename Iterator, typename... Output>
+    static bool match_loop(std::false_type, std::false_type, Iterator& it, const Iterator end, Output... out)
+    {
+        if (!match_required<true>(_unrolled{}, it, end, out...))
+            return false;
+
+        for (unsigned i = Min; i < Max && it != end; ++i)
+        {
+            // Failed repetition is not a part of the match
+            Iterator tmp = it;
+
+            if (!Rule::match_impl(tmp, end, out...))
+                break;
+
+            it = tmp;
+        }
+
+        return true;
+    }
+
+
+    /**
+     * @brief Match character class over random access iterator.
+     */
+    template<typename Iterator>
+    static bool match_loop(std::false_type, std::true_type, Iterator& it, const Iterator end)
+    {
+        if (end - it < static_cast<long long>(Min))
+            return false;
+
+        if (!match_required<false>(_unrolled{}, it, end))
+            return false;
+
+        match_optional(std::true_type{}, it, end);
+
+        return true;
+    }
+
+
+    /**
+     * @brief Match character class over contiguous bytes.
+     */
+    template<typename Iterator>
+    static bool match_loop(std::true_type, std::true_type, Iterator& it, const Iterator end)
+    {
+        if (end - it < static_cast<long long>(Min))
+            return false;
+
+        if (!match_required(_unrolled{}, it))
+            return false;
+
+        match_optional(_short{}, it, end);
+
+        return true;
+    }
+
+
+    /**
+     * @brief Match few optional repetitions of class by counted loop.
+     */
+    template<typename Iterator>
+    static void match_optional(std::true_type, Iterator& it, const Iterator end)
+    {
+        for (unsigned count = available(it, end); count > 0 && Rule::match_impl(it, end); --count)
+            continue;
+    }
+
+
+    /**
+     * @brief Match optional repetitions of class by vectorized scan.
+     */
+    template<typename Iterator>
+    static void match_optional(std::false_type, Iterator& it, const Iterator end)
+    {
+        it = class_scanner<Rule>::scan(it, it + available(it, end));
+    }
+
+
+    /**
+     * @brief Match required repetitions of class by unrolled code.
+     */
+    template<typename Iterator>
+    static bool match_required(std::true_type, Iterator& it)
+    {
+        return repeat_unrolled<Rule, Min, false>::match(it, it + Min);
+    }
+
+
+    /**
+     * @brief Match required repetitions of class by vectorized scan.
+     */
+    template<typename Iterator>
+    static bool match_required(std::false_type, Iterator& it)
+    {
+        const Iterator last = it + Min;
+
+        if (class_scanner<Rule>::scan(it, last) != last)
+            return false;
+
+        it = last;
+
+        return true;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Groups numbering of `repeat_n`.
+ */
+template<typename Rule, unsigned Min, unsigned Max, unsigned Next>
+struct number_groups<repeat_n<Rule, Min, Max>, Next>
+{
+    using _inner = number_groups<Rule, Next>;
+
+    using type = repeat_n<typename _inner::type, Min, Max>;
+    static constexpr unsigned next = _inner::next;
+};
+
+/* ************************************************************************ */
+
 template<typename... Rules>
 struct output_counter { };
 
@@ -973,170 +1770,2561 @@ struct sequence_remove<alternative_not<sequence<Rules...>>>
 /* ************************************************************************ */
 
 /**
- * @brief Special type for ignoring store rules.
+ * @brief Structure used for merging `alternative`.
+ *
+ * @tparam Alt...
  */
-struct null_variable { };
+template<typename... Alt>
+struct alternative_merge;
 
 /* ************************************************************************ */
 
 /**
- * @brief Tests if T is variable type.
+ * @brief Structure used for merging `alternative`.
  *
- * @tparam T Tested type.
+ * @tparam Alt1...
+ * @tparam Alt2...
  */
-template<typename T>
-struct is_variable : std::false_type {};
+template<typename... Alt1, typename... Alt2>
+struct alternative_merge<alternative<Alt1...>, alternative<Alt2...>>
+{
+    using type = alternative<Alt1..., Alt2...>;
+};
 
 /* ************************************************************************ */
 
 /**
- * @brief Specialization for std::reference_wrapper.
+ * @brief Structure used for merging `alternative`.
  *
- * @tparam T Tested type.
+ * @tparam Alt1...
  */
-template<typename T>
-struct is_variable<std::reference_wrapper<T>> : std::true_type {};
+template<typename... Alt1>
+struct alternative_merge<alternative<Alt1...>, void>
+{
+    using type = alternative<Alt1...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Removes alternatives that contains only one rule.
+ *
+ * @param Alt Alternative.
+ */
+template<typename Alt>
+struct alternative_remove
+{
+    using type = Alt;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Removes alternatives that contains only one rule.
+ *
+ * @param Rule Rule.
+ */
+template<typename Rule>
+struct alternative_remove<alternative<Rule>>
+{
+    using type = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Set of bytes (256 bits).
+ */
+struct charset
+{
+
+    /// Set bits.
+    unsigned long long bits[4];
+
+
+    /**
+     * @brief Constructor of an empty set.
+     */
+    constexpr charset() noexcept
+        : bits{0, 0, 0, 0}
+    {
+        // Nothing
+    }
+
+
+    /**
+     * @brief Test if byte is in the set.
+     *
+     * @param c Tested byte.
+     */
+    constexpr bool test(unsigned c) const noexcept
+    {
+        return (bits[(c >> 6) & 3] >> (c & 63)) & 1;
+    }
+
+
+    /**
+     * @brief Returns if set is empty.
+     */
+    constexpr bool empty() const noexcept
+    {
+        return (bits[0] | bits[1] | bits[2] | bits[3]) == 0;
+    }
+
+
+    /**
+     * @brief Add byte into the set.
+     *
+     * @param c Added byte.
+     */
+    constexpr void set(unsigned c) noexcept
+    {
+        bits[(c >> 6) & 3] |= 1ull << (c & 63);
+    }
+
+
+    /**
+     * @brief Add range of values into the set.
+     *
+     * Values are converted into bytes so the both signed (-128 - -1) and
+     * unsigned (128 - 255) representations are accepted.
+     *
+     * @param low  The first value.
+     * @param high The last value.
+     */
+    constexpr void set_range(int low, int high) noexcept
+    {
+        low = low < -128 ? -128 : low;
+        high = high > 255 ? 255 : high;
+
+        for (int c = low; c <= high; ++c)
+            set(static_cast<unsigned>(c) & 0xFF);
+    }
+
+
+    /**
+     * @brief Returns union of two sets.
+     */
+    constexpr charset operator|(const charset& rhs) const noexcept
+    {
+        charset res;
+
+        for (int i = 0; i < 4; ++i)
+            res.bits[i] = bits[i] | rhs.bits[i];
+
+        return res;
+    }
+
+
+    /**
+     * @brief Returns complement of the set.
+     */
+    constexpr charset operator~() const noexcept
+    {
+        charset res;
+
+        for (int i = 0; i < 4; ++i)
+            res.bits[i] = ~bits[i];
+
+        return res;
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Character class traits.
+ *
+ * Rule is a character class if it always matches exactly one value. All
+ * value matchers are character classes.
+ *
+ * @tparam Rule Tested rule.
+ */
+template<typename Rule>
+struct class_traits
+{
+    /// If rule is character class.
+    static constexpr bool is_class = false;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `val`.
+ */
+template<int Value>
+struct class_traits<val<Value>>
+{
+    static constexpr bool is_class = true;
+
+    static constexpr charset set() noexcept
+    {
+        charset res;
+        res.set_range(Value, Value);
+        return res;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `val_not`.
+ */
+template<int Value>
+struct class_traits<val_not<Value>>
+{
+    static constexpr bool is_class = true;
+
+    static constexpr charset set() noexcept
+    {
+        return ~class_traits<val<Value>>::set();
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `range`.
+ */
+template<int Low, int High>
+struct class_traits<range<Low, High>>
+{
+    static constexpr bool is_class = true;
+
+    static constexpr charset set() noexcept
+    {
+        charset res;
+        res.set_range(Low, High);
+        return res;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `range_icase`.
+ */
+template<int Low, int High>
+struct class_traits<range_icase<Low, High>>
+{
+    static constexpr bool is_class = true;
+
+    static constexpr charset set() noexcept
+    {
+        charset res;
+        res.set_range(Low, High);
+        res.set_range(Low - 0x20, High - 0x20);
+        return res;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `char_class`.
+ */
+template<unsigned Mask, bool Negated>
+struct class_traits<char_class<Mask, Negated>>
+{
+    static constexpr bool is_class = true;
+
+    static constexpr charset set() noexcept
+    {
+        charset res;
+
+        for (unsigned c = 0; c < 256; ++c)
+            if (char_class<Mask, Negated>::is(static_cast<unsigned char>(c)))
+                res.set(c);
+
+        return res;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `any`.
+ */
+template<>
+struct class_traits<any>
+{
+    static constexpr bool is_class = true;
+
+    static constexpr charset set() noexcept
+    {
+        return ~charset{};
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative`.
+ */
+template<typename Rule, typename... Rules>
+struct class_traits<alternative<Rule, Rules...>>
+{
+    static constexpr bool is_class =
+        class_traits<Rule>::is_class &&
+        class_traits<alternative<Rules...>>::is_class
+    ;
+
+    static constexpr charset set() noexcept
+    {
+        return class_traits<Rule>::set() | class_traits<alternative<Rules...>>::set();
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative` with single rule.
+ */
+template<typename Rule>
+struct class_traits<alternative<Rule>> : class_traits<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative_not`.
+ */
+template<typename... Rules>
+struct class_traits<alternative_not<Rules...>>
+{
+    static constexpr bool is_class = class_traits<alternative<Rules...>>::is_class;
+
+    static constexpr charset set() noexcept
+    {
+        return ~class_traits<alternative<Rules...>>::set();
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` with single rule.
+ */
+template<typename Rule>
+struct class_traits<sequence<Rule>> : class_traits<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `bitmap`.
+ */
+template<unsigned long long W0, unsigned long long W1, unsigned long long W2, unsigned long long W3>
+struct class_traits<bitmap<W0, W1, W2, W3>>
+{
+    static constexpr bool is_class = true;
+
+    static constexpr charset set() noexcept
+    {
+        charset res;
+        res.bits[0] = W0;
+        res.bits[1] = W1;
+        res.bits[2] = W2;
+        res.bits[3] = W3;
+        return res;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Minimum number of class alternatives compiled into `bitmap`.
+ */
+constexpr std::size_t bitmap_members = 3;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Bitmap of bytes matched by character class.
+ *
+ * @tparam Rule Character class rule.
+ */
+template<typename Rule>
+struct bitmap_of
+{
+    static_assert(class_traits<Rule>::is_class, "Rule must be character class");
+
+    using type = bitmap<
+        class_traits<Rule>::set().bits[0],
+        class_traits<Rule>::set().bits[1],
+        class_traits<Rule>::set().bits[2],
+        class_traits<Rule>::set().bits[3]
+    >;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Literal traits.
+ *
+ * Rule is a literal if it matches only one sequence of values.
+ *
+ * @tparam Rule Tested rule.
+ */
+template<typename Rule>
+struct literal_traits
+{
+    /// If rule is literal.
+    static constexpr bool is_literal = false;
+
+    /// Literal values.
+    using type = int_seq<>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `val`.
+ */
+template<int Value>
+struct literal_traits<val<Value>>
+{
+    static constexpr bool is_literal = true;
+    using type = int_seq<Value>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence`.
+ */
+template<typename Rule, typename... Rules>
+struct literal_traits<sequence<Rule, Rules...>>
+{
+    static constexpr bool is_literal =
+        literal_traits<Rule>::is_literal &&
+        literal_traits<sequence<Rules...>>::is_literal
+    ;
+
+    using type = typename int_seq_concat<
+        typename literal_traits<Rule>::type,
+        typename literal_traits<sequence<Rules...>>::type
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` with single rule.
+ */
+template<typename Rule>
+struct literal_traits<sequence<Rule>> : literal_traits<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Trie of literals.
+ *
+ * Values are grouped into classes, class 0 contains values that are not
+ * used in any literal. Transitions are stored in a single array, each
+ * transition contains the first row of the target node and in the upper
+ * bits an index (+ 1) of literal that ends in the target node. Node 0 is
+ * the root and because the root cannot be a target, 0 means no
+ * transition.
+ *
+ * @tparam Nodes   Number of nodes.
+ * @tparam Classes A number of value classes.
+ */
+template<std::size_t Nodes, std::size_t Classes>
+struct literal_trie
+{
+
+    /// Bits of transition used for the target row.
+    static constexpr unsigned row_bits = 20;
+
+    /// Mask of the target row.
+    static constexpr std::uint32_t row_mask = (1u << row_bits) - 1;
+
+    static_assert(Nodes * Classes <= row_mask, "Too many literal trie nodes");
+
+
+    /// Value class of each byte.
+    unsigned char class_of[256];
+
+    /// Transitions.
+    std::uint32_t next[Nodes * Classes];
+
+    /// A number of used nodes.
+    std::size_t node_count;
+
+
+    /**
+     * @brief Constructor of an empty trie.
+     */
+    constexpr literal_trie() noexcept
+        : class_of{}
+        , next{}
+        , node_count{1}
+    {
+        // Nothing
+    }
+
+
+    /**
+     * @brief Add literal into trie.
+     *
+     * Values must have assigned classes. When literal is already in the
+     * trie, the first index is kept.
+     *
+     * @param values Literal values.
+     * @param size   A number of values (at least 1).
+     * @param index  Literal index.
+     */
+    constexpr void add(const int* values, std::size_t size, std::size_t index) noexcept
+    {
+        std::size_t pos = 0;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            pos += class_of[values[i] & 0xFF];
+
+            if (next[pos] == 0)
+                next[pos] = static_cast<std::uint32_t>(node_count++ * Classes);
+
+            if (i + 1 == size && (next[pos] >> row_bits) == 0)
+                next[pos] |= static_cast<std::uint32_t>(index + 1) << row_bits;
+
+            pos = next[pos] & row_mask;
+        }
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Returns a number of values in sequence.
+ */
+template<int... Values>
+constexpr std::size_t int_seq_size(int_seq<Values...>) noexcept
+{
+    return sizeof...(Values);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Returns a number of distinct bytes in sequence.
+ */
+template<int... Values>
+constexpr std::size_t int_seq_distinct_bytes(int_seq<Values...>) noexcept
+{
+    const int values[] = {0, Values...};
+    charset set;
+    std::size_t count = 0;
+
+    for (std::size_t i = 1; i < sizeof(values) / sizeof(values[0]); ++i)
+    {
+        const unsigned c = static_cast<unsigned>(values[i]) & 0xFF;
+
+        if (!set.test(c))
+        {
+            set.set(c);
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Matching of list items by literal trie.
+ *
+ * All literals are matched in single pass and the value of the longest
+ * matched literal is returned. If there are more same literals the first
+ * one is used.
+ *
+ * @tparam Items List items.
+ */
+template<typename... Items>
+struct list_trie
+{
+
+// Private Types
+private:
+
+
+    template<bool... Values>
+    struct _bools {};
+
+    /// All literal values.
+    using _values = typename int_seq_concat<
+        typename literal_traits<typename Items::rule>::type...
+    >::type;
+
+
+// Public Constants
+public:
+
+
+    /// If all items are literals.
+    static constexpr bool supported = std::is_same<
+        _bools<true, literal_traits<typename Items::rule>::is_literal...>,
+        _bools<literal_traits<typename Items::rule>::is_literal..., true>
+    >::value;
+
+    /// A number of value classes.
+    static constexpr std::size_t classes = 1 + int_seq_distinct_bytes(_values{});
+
+    static_assert(sizeof...(Items) < 4096, "Too many list items");
+
+
+// Public Operations
+public:
+
+
+    /**
+     * @brief Assign value classes in order of the first occurrence.
+     */
+    template<typename Trie, int... Values>
+    static constexpr void assign_classes(Trie& trie, int_seq<Values...>) noexcept
+    {
+        const int values[] = {0, Values...};
+        unsigned count = 0;
+
+        for (std::size_t i = 1; i < sizeof(values) / sizeof(values[0]); ++i)
+        {
+            const unsigned c = static_cast<unsigned>(values[i]) & 0xFF;
+
+            if (trie.class_of[c] == 0)
+                trie.class_of[c] = static_cast<unsigned char>(++count);
+        }
+    }
+
+
+    /**
+     * @brief Add literal into trie.
+     */
+    template<typename Trie, int... Values>
+    static constexpr int add(Trie& trie, std::size_t index, int_seq<Values...>) noexcept
+    {
+        const int values[] = {0, Values...};
+
+        trie.add(values + 1, sizeof...(Values), index);
+
+        return 0;
+    }
+
+
+    /**
+     * @brief Create trie.
+     */
+    template<typename Trie>
+    static constexpr Trie make() noexcept
+    {
+        Trie res;
+        std::size_t index = 0;
+
+        assign_classes(res, _values{});
+
+        const int dummy[] = {
+            add(res, index++, typename literal_traits<typename Items::rule>::type{})...
+        };
+        (void) dummy;
+
+        return res;
+    }
+
+
+// Public Constants
+public:
+
+
+    /// A number of trie nodes.
+    static constexpr std::size_t nodes =
+        make<literal_trie<1 + int_seq_size(_values{}), classes>>().node_count;
+
+
+// Public Types
+public:
+
+
+    /// Trie type.
+    using trie_type = literal_trie<nodes, classes>;
+
+
+// Public Constants
+public:
+
+
+    /// Trie.
+    static constexpr trie_type value = make<trie_type>();
+
+
+// Public Operations
+public:
+
+
+    /**
+     * @brief Returns value of the longest matched item.
+     *
+     * @param it  An iterator to the first value.
+     * @param end An iterator to the value following the last value.
+     * @param def Value returned when no item is matched.
+     */
+    template<typename Out, typename Iterator>
+    static Out match(Iterator it, const Iterator end, Out def)
+    {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        static constexpr int values[] = {0, Items::value...};
+
+        std::uint32_t best = 0;
+        std::uint32_t pos = 0;
+
+        for (; it != end; ++it)
+        {
+            const value_type c = *it;
+
+            // Only bytes can be in the trie
+            if (sizeof(value_type) > 1 && static_cast<unsigned long>(c) > 255)
+                break;
+
+            const std::uint32_t next = value.next[pos + value.class_of[static_cast<unsigned char>(c)]];
+
+            if (next == 0)
+                break;
+
+            pos = next & trie_type::row_mask;
+            best = (next >> trie_type::row_bits) ? (next >> trie_type::row_bits) : best;
+        }
+
+        return best ? static_cast<Out>(values[best]) : def;
+    }
+
+};
+
+/* ************************************************************************ */
+
+template<typename... Items>
+constexpr typename list_trie<Items...>::trie_type list_trie<Items...>::value;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Special type for ignoring store rules.
+ */
+struct null_variable { };
+
+/* ************************************************************************ */
+
+/**
+ * @brief Tests if T is variable type.
+ *
+ * @tparam T Tested type.
+ */
+template<typename T>
+struct is_variable : std::false_type {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for std::reference_wrapper.
+ *
+ * @tparam T Tested type.
+ */
+template<typename T>
+struct is_variable<std::reference_wrapper<T>> : std::true_type {};
+
+static_assert(is_variable<std::reference_wrapper<int>>::value, "Nop");
+
+/* ************************************************************************ */
+
+/**
+ * @brief Tests if T is variable type.
+ *
+ * @tparam T Tested type.
+ */
+template<>
+struct is_variable<null_variable> : std::true_type {};
+
+/* ************************************************************************ */
+
+template<typename Output, typename Value>
+struct store_helper
+{
+    static void set(Output& out)
+    {
+        out = Value::val;
+    }
+};
+
+/* ************************************************************************ */
+
+template<typename T, typename Value>
+struct store_helper<std::reference_wrapper<T>, Value>
+{
+    static void set(std::reference_wrapper<T> out)
+    {
+        out.get() = Value::value;
+    }
+};
+
+/* ************************************************************************ */
+
+template<typename Value>
+struct store_helper<null_variable, Value>
+{
+    static void set(null_variable& out)
+    {
+        // Nothing
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Special rule that allows to store a special value to variable when
+ * the matcher goes throught.
+ *
+ * @tparam Rule  Inner rule.
+ * @tparam Value Value set to variable. Its not directly a value but a type
+ * that must contains a member `value` with result value.
+ */
+template<typename Rule, typename Value>
+struct store : matcher<store<Rule, Value>>
+{
+
+    /// A number of outputs in the rule.
+    static const unsigned output_count = Rule::output_count + 1;
+
+
+    template<typename Iterator, typename Output, typename... Outputs>
+    static bool match_impl(Iterator& it, const Iterator end, Output out,
+        Outputs... outs)
+    {
+        // Parameter type must be a variable
+        static_assert(is_variable<Output>::value,
+            "The first output must be a variable");
+
+        // Store value into output
+        store_helper<Output, Value>::set(out);
+
+        // Just forward
+        return Rule::match_impl(it, end, outs...);
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match beginning of the source.
+ *
+ * @tparam Rule Inner rule.
+ */
+template<typename Rule>
+struct begin : matcher<begin<Rule>>
+{
+    /// A number of outputs in the rule.
+    static const unsigned output_count = Rule::output_count;
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    {
+        return Rule::match_impl(it, end);
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match end of the source.
+ *
+ * @tparam Rule Inner rule.
+ */
+template<typename Rule>
+struct end : matcher<end<Rule>>
+{
+    /// A number of outputs in the rule.
+    static const unsigned output_count = Rule::output_count;
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    {
+        return Rule::match_impl(it, end) && (it == end);
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Exact match of the source.
+ *
+ * @tparam Rule Inner rule.
+ */
+template<typename Rule>
+struct begin_end : matcher<begin_end<Rule>>
+{
+    /// A number of outputs in the rule.
+    static const unsigned output_count = Rule::output_count;
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    {
+        return Rule::match_impl(it, end) && (it == end);
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rule that matches reversed inputs of source rule.
+ *
+ * Sequences are reversed and anchors swapped, other rules keep their
+ * structure. Value matchers and unknown rules are kept.
+ *
+ * @tparam Rule Source rule.
+ */
+template<typename Rule>
+struct reverse_rule
+{
+    /// Reversed rule.
+    using type = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Reversed list of sequence items.
+ *
+ * @tparam Reversed Already reversed items as `sequence`.
+ * @tparam Rules    Remaining items.
+ */
+template<typename Reversed, typename... Rules>
+struct reverse_sequence
+{
+    using type = Reversed;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Move the first item before reversed items.
+ */
+template<typename... Reversed, typename Rule, typename... Rules>
+struct reverse_sequence<sequence<Reversed...>, Rule, Rules...>
+    : reverse_sequence<sequence<typename reverse_rule<Rule>::type, Reversed...>, Rules...>
+{
+    // Nothing
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence`.
+ */
+template<typename... Rules>
+struct reverse_rule<sequence<Rules...>> : reverse_sequence<sequence<>, Rules...> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative`.
+ */
+template<typename... Rules>
+struct reverse_rule<alternative<Rules...>>
+{
+    using type = alternative<typename reverse_rule<Rules>::type...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `optional`.
+ */
+template<typename Rule>
+struct reverse_rule<optional<Rule>>
+{
+    using type = optional<typename reverse_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_optional`.
+ */
+template<typename Rule>
+struct reverse_rule<repeat_optional<Rule>>
+{
+    using type = repeat_optional<typename reverse_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat`.
+ */
+template<typename Rule>
+struct reverse_rule<repeat<Rule>>
+{
+    using type = repeat<typename reverse_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n`.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct reverse_rule<repeat_n<Rule, Min, Max>>
+{
+    using type = repeat_n<typename reverse_rule<Rule>::type, Min, Max>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `capture`.
+ */
+template<typename Rule>
+struct reverse_rule<capture<Rule>>
+{
+    using type = capture<typename reverse_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule>
+struct reverse_rule<group<Index, Rule>>
+{
+    using type = group<Index, typename reverse_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store`.
+ */
+template<typename Rule, typename Value>
+struct reverse_rule<store<Rule, Value>>
+{
+    using type = store<typename reverse_rule<Rule>::type, Value>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin`.
+ */
+template<typename Rule>
+struct reverse_rule<begin<Rule>>
+{
+    using type = end<typename reverse_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `end`.
+ */
+template<typename Rule>
+struct reverse_rule<end<Rule>>
+{
+    using type = begin<typename reverse_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `begin_end`.
+ */
+template<typename Rule>
+struct reverse_rule<begin_end<Rule>>
+{
+    using type = begin_end<typename reverse_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Case-insensitive variant of rule.
+ *
+ * ASCII letters in values and ranges are matched in both cases, other
+ * rules keep their structure.
+ *
+ * @tparam Rule Source rule.
+ */
+template<typename Rule>
+struct icase_rule
+{
+    /// Case-insensitive rule.
+    using type = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for rules with inner rules.
+ */
+template<template<typename...> class Rule, typename... Rules>
+struct icase_rule<Rule<Rules...>>
+{
+    using type = Rule<typename icase_rule<Rules>::type...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Case-insensitive range.
+ *
+ * Letters of range are matched by `range_icase` and other values by the
+ * source range.
+ *
+ * @tparam Low   The first value.
+ * @tparam High  The last value.
+ * @tparam Lower If range contains lower case letters.
+ * @tparam Upper If range contains upper case letters.
+ * @tparam Other If range contains other values.
+ */
+template<int Low, int High,
+    bool Lower = (Low <= 'z' && High >= 'a'),
+    bool Upper = (Low <= 'Z' && High >= 'A'),
+    bool Other = (Low < 'A' || High > 'z' || (Low < 'a' && High > 'Z'))>
+struct icase_range
+{
+    // Only other values
+    using type = range<Low, High>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Only lower case letters.
+ */
+template<int Low, int High>
+struct icase_range<Low, High, true, false, false>
+{
+    using type = range_icase<Low, High>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Only upper case letters.
+ */
+template<int Low, int High>
+struct icase_range<Low, High, false, true, false>
+{
+    using type = range_icase<Low + 0x20, High + 0x20>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Range with letters and other values.
+ *
+ * The source range is extended by both cases of its lower and upper case
+ * letters.
+ */
+template<int Low, int High, bool Lower, bool Upper>
+struct icase_range<Low, High, Lower, Upper, true>
+{
+    using _lower = range_icase<(Low < 'a' ? 'a' : Low), (High > 'z' ? 'z' : High)>;
+    using _upper = range_icase<(Low < 'A' ? 'A' : Low) + 0x20, (High > 'Z' ? 'Z' : High) + 0x20>;
+
+    using type = typename std::conditional<Lower && Upper,
+        alternative<range<Low, High>, _lower, _upper>,
+        typename std::conditional<Lower,
+            alternative<range<Low, High>, _lower>,
+            alternative<range<Low, High>, _upper>
+        >::type
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Range without letters.
+ */
+template<int Low, int High>
+struct icase_range<Low, High, false, false, true>
+{
+    using type = range<Low, High>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `val`.
+ */
+template<int Value>
+struct icase_rule<val<Value>>
+{
+    using type = typename std::conditional<
+        (Value >= 'a' && Value <= 'z') || (Value >= 'A' && Value <= 'Z'),
+        icase_range<Value, Value>,
+        std::conditional<true, val<Value>, void>
+    >::type::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `val_not`.
+ */
+template<int Value>
+struct icase_rule<val_not<Value>>
+{
+    using type = typename std::conditional<
+        (Value >= 'a' && Value <= 'z') || (Value >= 'A' && Value <= 'Z'),
+        alternative_not<typename icase_range<Value, Value>::type>,
+        val_not<Value>
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `char_class`, "[:upper:]" and "[:lower:]" match letters.
+ */
+template<unsigned Mask, bool Negated>
+struct icase_rule<char_class<Mask, Negated>>
+{
+    using type = char_class<((Mask & ctype_alpha) ? (Mask | ctype_alpha) : Mask), Negated>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Adds the other case of letters in the set.
+ *
+ * @param set Source set.
+ */
+constexpr charset charset_icase(charset set) noexcept
+{
+    for (unsigned c = 'a'; c <= 'z'; ++c)
+    {
+        if (set.test(c) || set.test(c - 0x20))
+        {
+            set.set(c);
+            set.set(c - 0x20);
+        }
+    }
+
+    return set;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `bitmap`.
+ */
+template<unsigned long long W0, unsigned long long W1, unsigned long long W2, unsigned long long W3>
+struct icase_rule<bitmap<W0, W1, W2, W3>>
+{
+    using type = bitmap<
+        charset_icase(class_traits<bitmap<W0, W1, W2, W3>>::set()).bits[0],
+        charset_icase(class_traits<bitmap<W0, W1, W2, W3>>::set()).bits[1],
+        charset_icase(class_traits<bitmap<W0, W1, W2, W3>>::set()).bits[2],
+        charset_icase(class_traits<bitmap<W0, W1, W2, W3>>::set()).bits[3]
+    >;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `range`.
+ */
+template<int Low, int High>
+struct icase_rule<range<Low, High>> : icase_range<Low, High> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n`.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct icase_rule<repeat_n<Rule, Min, Max>>
+{
+    using type = repeat_n<typename icase_rule<Rule>::type, Min, Max>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule>
+struct icase_rule<group<Index, Rule>>
+{
+    using type = group<Index, typename icase_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store`.
+ */
+template<typename Rule, typename Value>
+struct icase_rule<store<Rule, Value>>
+{
+    using type = store<typename icase_rule<Rule>::type, Value>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rule with character sets converted into `bitmap` if it is cheaper.
+ *
+ * Alternatives of at least `bitmap_members` classes are tested member by
+ * member so they are replaced by single bit test. Negated alternatives
+ * are always replaced. Other rules keep their structure.
+ *
+ * @tparam Rule Source rule.
+ */
+template<typename Rule>
+struct bitmap_rule
+{
+    /// Converted rule.
+    using type = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for rules with inner rules.
+ */
+template<template<typename...> class Rule, typename... Rules>
+struct bitmap_rule<Rule<Rules...>>
+{
+    using type = Rule<typename bitmap_rule<Rules>::type...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative`.
+ */
+template<typename... Rules>
+struct bitmap_rule<alternative<Rules...>>
+{
+    using type = typename std::conditional<
+        class_traits<alternative<Rules...>>::is_class && sizeof...(Rules) >= bitmap_members,
+        bitmap_of<alternative<Rules...>>,
+        std::conditional<true, alternative<typename bitmap_rule<Rules>::type...>, void>
+    >::type::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative_not`.
+ */
+template<typename... Rules>
+struct bitmap_rule<alternative_not<Rules...>>
+{
+    using type = typename std::conditional<
+        class_traits<alternative_not<Rules...>>::is_class,
+        bitmap_of<alternative_not<Rules...>>,
+        std::conditional<true, alternative_not<typename bitmap_rule<Rules>::type...>, void>
+    >::type::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n`.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct bitmap_rule<repeat_n<Rule, Min, Max>>
+{
+    using type = repeat_n<typename bitmap_rule<Rule>::type, Min, Max>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule>
+struct bitmap_rule<group<Index, Rule>>
+{
+    using type = group<Index, typename bitmap_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store`.
+ */
+template<typename Rule, typename Value>
+struct bitmap_rule<store<Rule, Value>>
+{
+    using type = store<typename bitmap_rule<Rule>::type, Value>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Case of `prefix_switch`: value followed by rule.
+ *
+ * @tparam Value The first value.
+ * @tparam Rule  Rule matched after the value.
+ */
+template<int Value, typename Rule>
+struct prefix_case
+{
+    /// The first value.
+    static constexpr int value = Value;
+
+    /// Rule matched after the value.
+    using rule = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Case index of each byte for `prefix_switch`.
+ */
+struct prefix_index
+{
+
+    /// Case index (+ 1) of each byte, 0 for bytes without case.
+    unsigned char index[256];
+
+
+    /**
+     * @brief Constructor.
+     *
+     * @tparam Values The first values of cases.
+     */
+    template<int... Values>
+    constexpr explicit prefix_index(int_seq<Values...>) noexcept
+        : index{}
+    {
+        const int values[] = {0, Values...};
+
+        for (std::size_t i = 1; i < sizeof(values) / sizeof(values[0]); ++i)
+            index[static_cast<unsigned>(values[i]) & 0xFF] = static_cast<unsigned char>(i);
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Dispatching of `prefix_switch` cases by case index.
+ *
+ * Cases are split into halves by index so only a logarithmic number of
+ * comparisons is required.
+ *
+ * @tparam Cases Cases in `std::tuple`, the first one fails.
+ * @tparam First The first case index.
+ * @tparam Last  Index after the last case.
+ */
+template<typename Cases, std::size_t First, std::size_t Last>
+struct prefix_dispatch
+{
+    template<typename Iterator, typename... Output>
+    static bool match(unsigned index, Iterator& it, const Iterator end, Output... out)
+    {
+        constexpr std::size_t middle = (First + Last) / 2;
+
+        return (index < middle)
+            ? prefix_dispatch<Cases, First, middle>::match(index, it, end, out...)
+            : prefix_dispatch<Cases, middle, Last>::match(index, it, end, out...)
+        ;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for single case.
+ */
+template<typename Cases, std::size_t Index>
+struct prefix_dispatch<Cases, Index, Index + 1>
+{
+    template<typename Iterator, typename... Output>
+    static bool match(unsigned index, Iterator& it, const Iterator end, Output... out)
+    {
+        ++it;
+        return std::tuple_element<Index, Cases>::type::rule::match_impl(it, end, out...);
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for bytes without case.
+ */
+template<typename Cases>
+struct prefix_dispatch<Cases, 0, 1>
+{
+    template<typename Iterator, typename... Output>
+    static bool match(unsigned index, Iterator& it, const Iterator end, Output... out)
+    {
+        return false;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Comparison chain of `prefix_switch` cases.
+ *
+ * @tparam Cases A list of `prefix_case`.
+ */
+template<typename... Cases>
+struct prefix_chain
+{
+    template<typename Iterator, typename... Output>
+    static bool match(int value, Iterator& it, const Iterator end, Output... out)
+    {
+        return false;
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Comparison chain of `prefix_switch` cases.
+ */
+template<typename Case, typename... Cases>
+struct prefix_chain<Case, Cases...>
+{
+    template<typename Iterator, typename... Output>
+    static bool match(int value, Iterator& it, const Iterator end, Output... out)
+    {
+        if (value == Case::value)
+        {
+            ++it;
+            return Case::rule::match_impl(it, end, out...);
+        }
+
+        return prefix_chain<Cases...>::match(value, it, end, out...);
+    }
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Maximum number of `prefix_switch` cases tested by comparison chain.
+ */
+constexpr std::size_t prefix_chain_cases = 8;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Alternative of rules that start with distinct values.
+ *
+ * The first value selects at most one case so the value is read once and
+ * failed cases don't consume the input. Up to `prefix_chain_cases` cases
+ * are compared in chain, more cases are selected by lookup of their index
+ * and binary search of the index.
+ *
+ * @tparam Cases A list of `prefix_case`.
+ */
+template<typename... Cases>
+struct prefix_switch : matcher<prefix_switch<Cases...>>
+{
+
+// Private Types
+private:
+
+
+    /// Cases with failing case at index 0.
+    using _cases = std::tuple<void, Cases...>;
+
+
+// Public Constants
+public:
+
+
+    /// A number of outputs in the rule.
+    static const unsigned output_count = std::tuple_element<1, _cases>::type::rule::output_count;
+
+    /// Case index of bytes.
+    static constexpr prefix_index value{int_seq<Cases::value...>{}};
+
+
+// Public Operations
+public:
+
+
+    template<typename Iterator, typename... Output>
+    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        if (it == end)
+            return false;
+
+        return match_case(std::integral_constant<bool, (sizeof...(Cases) <= prefix_chain_cases)>{},
+            static_cast<value_type>(*it), it, end, out...);
+    }
+
+
+// Private Operations
+private:
+
+
+    template<typename Val, typename Iterator, typename... Output>
+    static bool match_case(std::true_type, Val c, Iterator& it, const Iterator end, Output... out)
+    {
+        return prefix_chain<Cases...>::match(static_cast<int>(c), it, end, out...);
+    }
+
+
+    template<typename Val, typename Iterator, typename... Output>
+    static bool match_case(std::false_type, Val c, Iterator& it, const Iterator end, Output... out)
+    {
+        // Only bytes have cases
+        if (sizeof(Val) > 1 && static_cast<unsigned long>(c) > 255)
+            return false;
+
+        return prefix_dispatch<_cases, 0, 1 + sizeof...(Cases)>::match(
+            value.index[static_cast<unsigned char>(c)], it, end, out...);
+    }
+
+};
+
+/* ************************************************************************ */
+
+template<typename... Cases>
+constexpr prefix_index prefix_switch<Cases...>::value;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Splits rule into the first value and the rest.
+ *
+ * @tparam Rule Split rule.
+ */
+template<typename Rule>
+struct prefix_split
+{
+    /// If rule starts with value.
+    static constexpr bool is_value = false;
+
+    /// The first value.
+    static constexpr int value = 0;
+
+    /// Rule after the first value.
+    using rest = void;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `val`.
+ */
+template<int Value>
+struct prefix_split<val<Value>>
+{
+    static constexpr bool is_value = true;
+    static constexpr int value = Value;
+    using rest = null_rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` with single rule.
+ */
+template<typename Rule>
+struct prefix_split<sequence<Rule>> : prefix_split<Rule> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` of value and rule.
+ */
+template<int Value, typename Rule>
+struct prefix_split<sequence<val<Value>, Rule>>
+{
+    static constexpr bool is_value = true;
+    static constexpr int value = Value;
+    using rest = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence` of value and more rules.
+ */
+template<int Value, typename Rule, typename... Rules>
+struct prefix_split<sequence<val<Value>, Rule, Rules...>>
+{
+    static constexpr bool is_value = true;
+    static constexpr int value = Value;
+    using rest = sequence<Rule, Rules...>;
+};
+
+/* ************************************************************************ */
+
+template<typename Rule>
+struct prefix_trie_rule;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rests of rules that start with the value.
+ *
+ * @tparam Value The first value.
+ * @tparam Rules Split rules.
+ */
+template<int Value, typename... Rules>
+struct prefix_rests
+{
+    /// Rests in `alternative` (`void` for none).
+    using type = void;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rests of rules that start with the value.
+ */
+template<int Value, typename Rule, typename... Rules>
+struct prefix_rests<Value, Rule, Rules...>
+{
+    using type = typename std::conditional<prefix_split<Rule>::value == Value,
+        alternative_merge<alternative<typename prefix_split<Rule>::rest>,
+            typename prefix_rests<Value, Rules...>::type>,
+        prefix_rests<Value, Rules...>
+    >::type::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rule matched after the first value of `prefix_case`.
+ *
+ * @tparam Rests Rests in `alternative`.
+ */
+template<typename Rests>
+struct prefix_tail
+{
+    using type = typename prefix_trie_rule<Rests>::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for single rest.
+ */
+template<typename Rule>
+struct prefix_tail<alternative<Rule>>
+{
+    using type = typename prefix_trie_rule<Rule>::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief If `prefix_switch` has a case for the value.
+ *
+ * @tparam Value Tested value.
+ * @tparam Cases Cases of `prefix_switch`.
+ */
+template<int Value, typename Cases>
+struct prefix_has_case;
+
+/* ************************************************************************ */
+
+/**
+ * @brief If `prefix_switch` has a case for the value.
+ */
+template<int Value, int... Values, typename... Rules>
+struct prefix_has_case<Value, prefix_switch<prefix_case<Values, Rules>...>>
+    : std::integral_constant<bool, !std::is_same<
+        int_seq<(Values == Value ? 1 : 0)...>,
+        int_seq<(Values == Value ? 0 : 0)...>
+    >::value> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Builds `prefix_switch` from rules that start with values.
+ *
+ * Cases are ordered by the first occurrence of the value and rules of
+ * each case keep their order.
+ *
+ * @tparam Switch Already built `prefix_switch`.
+ * @tparam Rules  Remaining rules.
+ */
+template<typename Switch, typename... Rules>
+struct prefix_cases
+{
+    using type = Switch;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Builds `prefix_switch` from rules that start with values.
+ */
+template<typename... Cases, typename Rule, typename... Rules>
+struct prefix_cases<prefix_switch<Cases...>, Rule, Rules...>
+{
+    /// The first value of the rule.
+    static constexpr int _value = prefix_split<Rule>::value;
+
+    using type = typename prefix_cases<
+        typename std::conditional<prefix_has_case<_value, prefix_switch<Cases...>>::value,
+            prefix_switch<Cases...>,
+            prefix_switch<Cases..., prefix_case<_value,
+                typename prefix_tail<typename prefix_rests<_value, Rule, Rules...>::type>::type
+            >>
+        >::type,
+        Rules...
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rules of alternative before the first `null_rule`.
+ *
+ * Rules after `null_rule` are never tried so "A|()|B" is same as "A?".
+ *
+ * @tparam Rules Alternative rules.
+ */
+template<typename... Rules>
+struct prefix_optional
+{
+    /// If rules contain `null_rule`.
+    static constexpr bool found = false;
+
+    /// Rules before `null_rule` in `alternative` (`void` for none).
+    using type = void;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `null_rule`.
+ */
+template<typename... Rules>
+struct prefix_optional<null_rule, Rules...>
+{
+    static constexpr bool found = true;
+    using type = void;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for other rules.
+ */
+template<typename Rule, typename... Rules>
+struct prefix_optional<Rule, Rules...>
+{
+    static constexpr bool found = prefix_optional<Rules...>::found;
+
+    using type = typename alternative_merge<
+        alternative<Rule>,
+        typename prefix_optional<Rules...>::type
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Optional rule for rules before `null_rule`.
+ *
+ * @tparam Rules Rules in `alternative` or `void`.
+ */
+template<typename Rules>
+struct prefix_optional_rule
+{
+    using type = optional<typename prefix_tail<Rules>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `null_rule` as the first rule.
+ */
+template<>
+struct prefix_optional_rule<void>
+{
+    using type = null_rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Rule with alternatives of literal prefixes factored into trie.
+ *
+ * Alternatives whose rules all start with a value (and that are not
+ * character classes) are replaced by `prefix_switch` where rules with the
+ * same first value share a case: "int|if" is matched as "i(nt|f)".
+ * Alternatives with `null_rule` (e.g. rests of "int|in") become optional.
+ * Other rules keep their structure.
+ *
+ * @tparam Rule Source rule.
+ */
+template<typename Rule>
+struct prefix_trie_rule
+{
+    /// Factored rule.
+    using type = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for rules with inner rules.
+ */
+template<template<typename...> class Rule, typename... Rules>
+struct prefix_trie_rule<Rule<Rules...>>
+{
+    using type = Rule<typename prefix_trie_rule<Rules>::type...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative`.
+ */
+template<typename... Rules>
+struct prefix_trie_rule<alternative<Rules...>>
+{
+
+// Private Types
+private:
+
+
+    template<bool... Values>
+    struct _bools {};
+
+
+// Public Constants
+public:
+
+
+    /// If all rules start with value.
+    static constexpr bool factored = !class_traits<alternative<Rules...>>::is_class && std::is_same<
+        _bools<true, prefix_split<Rules>::is_value...>,
+        _bools<prefix_split<Rules>::is_value..., true>
+    >::value;
+
+
+// Public Types
+public:
+
+
+    using type = typename std::conditional<prefix_optional<Rules...>::found,
+        prefix_optional_rule<typename prefix_optional<Rules...>::type>,
+        typename std::conditional<factored,
+            prefix_cases<prefix_switch<>, Rules...>,
+            std::conditional<true, alternative<typename prefix_trie_rule<Rules>::type...>, void>
+        >::type
+    >::type::type;
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n`.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct prefix_trie_rule<repeat_n<Rule, Min, Max>>
+{
+    using type = repeat_n<typename prefix_trie_rule<Rule>::type, Min, Max>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule>
+struct prefix_trie_rule<group<Index, Rule>>
+{
+    using type = group<Index, typename prefix_trie_rule<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store`.
+ */
+template<typename Rule, typename Value>
+struct prefix_trie_rule<store<Rule, Value>>
+{
+    using type = store<typename prefix_trie_rule<Rule>::type, Value>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Canonical form of rule.
+ *
+ * Sequences are flattened, alternatives are flattened and their duplicate
+ * members are removed, values and ranges of character sets are merged and
+ * nested quantifiers are collapsed. Single rule sequences and alternatives
+ * are replaced by the rule. Groups keep their inner rule structure.
+ *
+ * @tparam Rule Source rule.
+ */
+template<typename Rule>
+struct simplify
+{
+    /// Simplified rule.
+    using type = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Quantifier of simplified rule.
+ *
+ * @tparam Rule Rule.
+ */
+template<typename Rule>
+struct simplify_quantifier
+{
+    /// If rule is a quantifier.
+    static constexpr bool is_quantifier = false;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `optional`.
+ */
+template<typename Rule>
+struct simplify_quantifier<optional<Rule>>
+{
+    static constexpr bool is_quantifier = true;
+    static constexpr bool required = false;
+    static constexpr bool many = false;
+    using rule = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat`.
+ */
+template<typename Rule>
+struct simplify_quantifier<repeat<Rule>>
+{
+    static constexpr bool is_quantifier = true;
+    static constexpr bool required = true;
+    static constexpr bool many = true;
+    using rule = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_optional`.
+ */
+template<typename Rule>
+struct simplify_quantifier<repeat_optional<Rule>>
+{
+    static constexpr bool is_quantifier = true;
+    static constexpr bool required = false;
+    static constexpr bool many = true;
+    using rule = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Quantifier of rule that matches given number of occurrences.
+ *
+ * @tparam Rule     Inner rule.
+ * @tparam Required If at least one occurrence is required.
+ * @tparam Many     If more than one occurrence is allowed.
+ */
+template<typename Rule, bool Required, bool Many>
+struct simplify_quantified
+{
+    using type = optional<Rule>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for one and more occurrences.
+ */
+template<typename Rule>
+struct simplify_quantified<Rule, true, true>
+{
+    using type = repeat<Rule>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for zero and more occurrences.
+ */
+template<typename Rule>
+struct simplify_quantified<Rule, false, true>
+{
+    using type = repeat_optional<Rule>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Collapses quantifier of simplified rule into single quantifier.
+ *
+ * @tparam Quantified Quantifier of simplified rule.
+ * @tparam Nested     If inner rule is a quantifier.
+ */
+template<typename Quantified,
+    bool Nested = simplify_quantifier<typename simplify_quantifier<Quantified>::rule>::is_quantifier>
+struct simplify_nested
+{
+    using type = Quantified;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for nested quantifiers.
+ */
+template<typename Quantified>
+struct simplify_nested<Quantified, true>
+{
 
-static_assert(is_variable<std::reference_wrapper<int>>::value, "Nop");
+// Private Types
+private:
+
+
+    using _outer = simplify_quantifier<Quantified>;
+    using _inner = simplify_quantifier<typename _outer::rule>;
+
+
+// Public Types
+public:
+
+
+    using type = typename simplify_quantified<typename _inner::rule,
+        _outer::required && _inner::required,
+        _outer::many || _inner::many
+    >::type;
+
+};
 
 /* ************************************************************************ */
 
 /**
- * @brief Tests if T is variable type.
+ * @brief Flattens simplified sequence members.
  *
- * @tparam T Tested type.
+ * @tparam Seq   Sequence of flattened rules.
+ * @tparam Rules Remaining rules.
  */
-template<>
-struct is_variable<null_variable> : std::true_type {};
+template<typename Seq, typename... Rules>
+struct simplify_sequence
+{
+    using type = Seq;
+};
 
 /* ************************************************************************ */
 
-template<typename Output, typename Value>
-struct store_helper
-{
-    static void set(Output& out)
-    {
-        out = Value::val;
-    }
-};
+/**
+ * @brief Specialization for a rule.
+ */
+template<typename... Done, typename Rule, typename... Rules>
+struct simplify_sequence<sequence<Done...>, Rule, Rules...>
+    : simplify_sequence<sequence<Done..., Rule>, Rules...> {};
 
 /* ************************************************************************ */
 
-template<typename T, typename Value>
-struct store_helper<std::reference_wrapper<T>, Value>
+/**
+ * @brief Specialization for nested sequence.
+ */
+template<typename... Done, typename... Inner, typename... Rules>
+struct simplify_sequence<sequence<Done...>, sequence<Inner...>, Rules...>
+    : simplify_sequence<sequence<Done..., Inner...>, Rules...> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Flattens simplified alternative members and removes duplicates.
+ *
+ * @tparam Done  Tuple of unique rules.
+ * @tparam Rules Remaining rules.
+ */
+template<typename Done, typename... Rules>
+struct simplify_alternative
 {
-    static void set(std::reference_wrapper<T> out)
-    {
-        out.get() = Value::value;
-    }
+    using type = Done;
 };
 
 /* ************************************************************************ */
 
-template<typename Value>
-struct store_helper<null_variable, Value>
+/**
+ * @brief Specialization for a rule.
+ */
+template<typename... Done, typename Rule, typename... Rules>
+struct simplify_alternative<std::tuple<Done...>, Rule, Rules...>
 {
-    static void set(null_variable& out)
-    {
-        // Nothing
-    }
+
+// Private Types
+private:
+
+
+    template<bool... Values>
+    struct _bools {};
+
+
+// Public Constants
+public:
+
+
+    /// If rule is already in the list.
+    static constexpr bool duplicate = !std::is_same<
+        _bools<false, std::is_same<Rule, Done>::value...>,
+        _bools<std::is_same<Rule, Done>::value..., false>
+    >::value;
+
+
+// Public Types
+public:
+
+
+    using type = typename simplify_alternative<typename std::conditional<duplicate,
+        std::tuple<Done...>,
+        std::tuple<Done..., Rule>
+    >::type, Rules...>::type;
+
 };
 
 /* ************************************************************************ */
 
 /**
- * @brief Special rule that allows to store a special value to variable when
- * the matcher goes throught.
+ * @brief Specialization for nested alternative.
+ */
+template<typename... Done, typename... Inner, typename... Rules>
+struct simplify_alternative<std::tuple<Done...>, alternative<Inner...>, Rules...>
+    : simplify_alternative<std::tuple<Done...>, Inner..., Rules...> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Range of values matched by rule.
  *
- * @tparam Rule  Inner rule.
- * @tparam Value Value set to variable. Its not directly a value but a type
- * that must contains a member `value` with result value.
+ * @tparam Rule Rule.
  */
-template<typename Rule, typename Value>
-struct store : matcher<store<Rule, Value>>
+template<typename Rule>
+struct simplify_range
 {
+    /// If rule matches single range of values.
+    static constexpr bool is_range = false;
 
-    /// A number of outputs in the rule.
-    static const unsigned output_count = Rule::output_count + 1;
+    /// Lowest matched value.
+    static constexpr int low = 0;
 
+    /// Highest matched value.
+    static constexpr int high = 0;
+};
 
-    template<typename Iterator, typename Output, typename... Outputs>
-    static bool match_impl(Iterator& it, const Iterator end, Output out,
-        Outputs... outs)
-    {
-        // Parameter type must be a variable
-        static_assert(is_variable<Output>::value,
-            "The first output must be a variable");
+/* ************************************************************************ */
 
-        // Store value into output
-        store_helper<Output, Value>::set(out);
+/**
+ * @brief Specialization for `val`.
+ */
+template<int Value>
+struct simplify_range<val<Value>>
+{
+    static constexpr bool is_range = true;
+    static constexpr int low = Value;
+    static constexpr int high = Value;
+};
 
-        // Just forward
-        return Rule::match_impl(it, end, outs...);
-    }
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `range`.
+ */
+template<int Low, int High>
+struct simplify_range<range<Low, High>>
+{
+    static constexpr bool is_range = true;
+    static constexpr int low = Low;
+    static constexpr int high = High;
 };
 
 /* ************************************************************************ */
 
 /**
- * @brief Match beginning of the source.
+ * @brief List of ranges where overlapping and adjacent ranges are merged.
  *
- * @tparam Rule Inner rule.
+ * A merged range takes the place of the first of them.
+ *
+ * @tparam Size Number of source ranges.
  */
-template<typename Rule>
-struct begin : matcher<begin<Rule>>
+template<std::size_t Size>
+struct range_list
 {
-    /// A number of outputs in the rule.
-    static const unsigned output_count = Rule::output_count;
 
+    /// Lowest values of ranges.
+    int low[Size];
 
-    template<typename Iterator, typename... Output>
-    static bool match_impl(Iterator& it, const Iterator end, Output... out)
+    /// Highest values of ranges.
+    int high[Size];
+
+    /// Number of merged ranges.
+    std::size_t size;
+
+
+    /**
+     * @brief Constructor.
+     */
+    template<int... Lows, int... Highs>
+    constexpr range_list(int_seq<Lows...>, int_seq<Highs...>) noexcept
+        : low{Lows...}
+        , high{Highs...}
+        , size{Size}
     {
-        return Rule::match_impl(it, end);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            for (std::size_t j = i + 1; j < size; )
+            {
+                if (low[j] > high[i] + 1 || low[i] > high[j] + 1)
+                {
+                    ++j;
+                    continue;
+                }
+
+                low[i] = low[i] < low[j] ? low[i] : low[j];
+                high[i] = high[i] > high[j] ? high[i] : high[j];
+
+                for (std::size_t k = j + 1; k < size; ++k)
+                {
+                    low[k - 1] = low[k];
+                    high[k - 1] = high[k];
+                }
+
+                --size;
+
+                // Extended range can touch skipped ranges
+                j = i + 1;
+            }
+        }
     }
+
 };
 
 /* ************************************************************************ */
 
 /**
- * @brief Match end of the source.
+ * @brief Merged ranges of rules.
  *
- * @tparam Rule Inner rule.
+ * @tparam Rules Values and ranges.
  */
-template<typename Rule>
-struct end : matcher<end<Rule>>
+template<typename... Rules>
+struct simplify_range_data
 {
-    /// A number of outputs in the rule.
-    static const unsigned output_count = Rule::output_count;
+    static constexpr range_list<sizeof...(Rules)> value{
+        int_seq<simplify_range<Rules>::low...>{},
+        int_seq<simplify_range<Rules>::high...>{}
+    };
+};
 
+/* ************************************************************************ */
 
-    template<typename Iterator, typename... Output>
-    static bool match_impl(Iterator& it, const Iterator end, Output... out)
-    {
-        return Rule::match_impl(it, end) && (it == end);
-    }
+template<typename... Rules>
+constexpr range_list<sizeof...(Rules)> simplify_range_data<Rules...>::value;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Builds alternative from merged ranges.
+ *
+ * @tparam Alt     Alternative template.
+ * @tparam Data    Merged ranges.
+ * @tparam Indices Indices of ranges.
+ */
+template<template<typename...> class Alt, typename Data, typename Indices>
+struct simplify_range_rules;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Builds alternative from merged ranges.
+ */
+template<template<typename...> class Alt, typename Data, int... Indices>
+struct simplify_range_rules<Alt, Data, int_seq<Indices...>>
+{
+    using type = Alt<typename std::conditional<
+        Data::value.low[Indices] == Data::value.high[Indices],
+        val<Data::value.low[Indices]>,
+        range<Data::value.low[Indices], Data::value.high[Indices]>
+    >::type...>;
 };
 
 /* ************************************************************************ */
 
 /**
- * @brief Exact match of the source.
+ * @brief Builds alternative from unique rules, values and ranges are merged.
  *
- * @tparam Rule Inner rule.
+ * @tparam Alt   Alternative template.
+ * @tparam Rules Tuple of unique rules.
+ */
+template<template<typename...> class Alt, typename Rules>
+struct simplify_ranges;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Builds alternative from unique rules, values and ranges are merged.
+ */
+template<template<typename...> class Alt, typename... Rules>
+struct simplify_ranges<Alt, std::tuple<Rules...>>
+{
+
+// Private Types
+private:
+
+
+    template<bool... Values>
+    struct _bools {};
+
+    using _data = simplify_range_data<Rules...>;
+
+
+// Public Constants
+public:
+
+
+    /// If all rules are values or ranges.
+    static constexpr bool mergeable = std::is_same<
+        _bools<true, simplify_range<Rules>::is_range...>,
+        _bools<simplify_range<Rules>::is_range..., true>
+    >::value;
+
+
+// Public Types
+public:
+
+
+    using type = typename std::conditional<mergeable,
+        simplify_range_rules<Alt, _data, make_int_seq<0, mergeable ? _data::value.size : 0>>,
+        std::conditional<true, Alt<Rules...>, void>
+    >::type::type;
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for rules with inner rules.
+ */
+template<template<typename...> class Rule, typename... Rules>
+struct simplify<Rule<Rules...>>
+{
+    using type = Rule<typename simplify<Rules>::type...>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `sequence`.
+ */
+template<typename... Rules>
+struct simplify<sequence<Rules...>>
+{
+    using type = typename sequence_remove<typename simplify_sequence<
+        sequence<>, typename simplify<Rules>::type...
+    >::type>::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative`.
+ */
+template<typename... Rules>
+struct simplify<alternative<Rules...>>
+{
+    using type = typename alternative_remove<typename simplify_ranges<alternative,
+        typename simplify_alternative<std::tuple<>, typename simplify<Rules>::type...>::type
+    >::type>::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `alternative_not`.
+ */
+template<typename... Rules>
+struct simplify<alternative_not<Rules...>>
+{
+    using type = typename simplify_ranges<alternative_not,
+        typename simplify_alternative<std::tuple<>, typename simplify<Rules>::type...>::type
+    >::type;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `optional`.
  */
 template<typename Rule>
-struct begin_end : matcher<begin_end<Rule>>
+struct simplify<optional<Rule>>
+    : simplify_nested<optional<typename simplify<Rule>::type>> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat`.
+ */
+template<typename Rule>
+struct simplify<repeat<Rule>>
+    : simplify_nested<repeat<typename simplify<Rule>::type>> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_optional`.
+ */
+template<typename Rule>
+struct simplify<repeat_optional<Rule>>
+    : simplify_nested<repeat_optional<typename simplify<Rule>::type>> {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `repeat_n`.
+ */
+template<typename Rule, unsigned Min, unsigned Max>
+struct simplify<repeat_n<Rule, Min, Max>>
 {
-    /// A number of outputs in the rule.
-    static const unsigned output_count = Rule::output_count;
+    using type = repeat_n<typename simplify<Rule>::type, Min, Max>;
+};
 
+/* ************************************************************************ */
 
-    template<typename Iterator, typename... Output>
-    static bool match_impl(Iterator& it, const Iterator end, Output... out)
-    {
-        return Rule::match_impl(it, end) && (it == end);
-    }
+/**
+ * @brief Specialization for `group`.
+ */
+template<unsigned Index, typename Rule>
+struct simplify<group<Index, Rule>>
+{
+    using type = group<Index, typename simplify<Rule>::type>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for `store`.
+ */
+template<typename Rule, typename Value>
+struct simplify<store<Rule, Value>>
+{
+    using type = store<typename simplify<Rule>::type, Value>;
 };
 
 /* ************************************************************************ */
@@ -1185,14 +4373,25 @@ bool match(const Rule& rule, Iterator first, const Iterator last)
  *
  * Matched values: ' ', '\t', '\n', '\r', '\v', '\f'.
  */
-using whitespace = alternative<
-    val<' '>,
-    val<'\t'>,
-    val<'\n'>,
-    val<'\r'>,
-    val<'\v'>,
-    val<'\f'>
->;
+using whitespace = char_class<ctype_space>;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Predefined type for digit matching.
+ *
+ * Matched values: '0' - '9'.
+ */
+using digit = char_class<ctype_digit>;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Predefined type for word character matching.
+ *
+ * Matched values: 'a' - 'z', 'A' - 'Z', '0' - '9', '_'.
+ */
+using word = char_class<ctype_word>;
 
 /* ************************************************************************ */
 
@@ -0,0 +1,1033 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file simd.hpp
+ *
+ * This header contains vectorized scanning kernels for contiguous byte
+ * input. Each kernel has a scalar version and x86 versions (SSE2, AVX2)
+ * selected by CPU detection at runtime.
+ *
+ * Define TEMPLATE_REGEX_NO_SIMD to use only the scalar versions.
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/* ************************************************************************ */
+
+#if !defined(TEMPLATE_REGEX_NO_SIMD) && \
+    (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+/// x86 SIMD kernels are available.
+#define TEMPLATE_REGEX_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/* ************************************************************************ */
+
+namespace template_regex {
+namespace simd {
+
+/* ************************************************************************ */
+
+/**
+ * @brief Returns if the CPU supports AVX2.
+ *
+ * The result is detected only once.
+ */
+inline bool has_avx2() noexcept
+{
+#ifdef TEMPLATE_REGEX_SIMD_X86
+    static const bool result = __builtin_cpu_supports("avx2");
+    return result;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Returns if the CPU supports SSSE3.
+ *
+ * The result is detected only once.
+ */
+inline bool has_ssse3() noexcept
+{
+#ifdef TEMPLATE_REGEX_SIMD_X86
+    static const bool result = __builtin_cpu_supports("ssse3");
+    return result;
+#else
+    return false;
+#endif
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief If iterator refers to contiguous bytes.
+ *
+ * @tparam Iterator Tested iterator.
+ */
+template<typename Iterator>
+struct contiguous : std::integral_constant<bool,
+    std::is_pointer<Iterator>::value &&
+    sizeof(typename std::iterator_traits<Iterator>::value_type) == 1
+> {};
+
+template<>
+struct contiguous<std::string::iterator> : std::true_type {};
+
+template<>
+struct contiguous<std::string::const_iterator> : std::true_type {};
+
+template<>
+struct contiguous<std::vector<char>::iterator> : std::true_type {};
+
+template<>
+struct contiguous<std::vector<char>::const_iterator> : std::true_type {};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Returns address of byte referenced by contiguous iterator.
+ *
+ * @param it Dereferenceable iterator.
+ */
+template<typename Iterator>
+inline const char* address(Iterator it) noexcept
+{
+    return reinterpret_cast<const char*>(&*it);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Maximum number of class ranges compared by AVX2 range kernel.
+ */
+constexpr unsigned avx2_range_limit = 2;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Set of bytes prepared for the class scanning kernels.
+ *
+ * The set is stored as bitmap for scalar kernel, as nibble lookup
+ * tables for `pshufb` kernel and as list of byte ranges for range
+ * compare kernel.
+ */
+struct byte_class
+{
+
+    /// Maximum number of stored ranges.
+    static constexpr unsigned max_ranges = 8;
+
+    /// Set bits.
+    unsigned long long bits[4];
+
+    /// Bit `high & 7` of `nibble_low[low]` is set for bytes below 128.
+    unsigned char nibble_low[16];
+
+    /// Bit `high & 7` of `nibble_high[low]` is set for bytes above 127.
+    unsigned char nibble_high[16];
+
+    /// The first bytes of ranges.
+    unsigned char range_first[max_ranges];
+
+    /// Range sizes (the last byte - the first byte).
+    unsigned char range_size[max_ranges];
+
+    /// A number of ranges, can be greater than `max_ranges`.
+    unsigned range_count;
+
+    /// Value ORed to bytes before range compares (0 or 0x20).
+    unsigned char range_fold;
+
+
+    /**
+     * @brief Constructor of empty class.
+     */
+    constexpr byte_class() noexcept
+        : byte_class(0, 0, 0, 0)
+    {
+        // Nothing
+    }
+
+
+    /**
+     * @brief Constructor.
+     *
+     * @param w0 Bits of bytes 0 - 63.
+     * @param w1 Bits of bytes 64 - 127.
+     * @param w2 Bits of bytes 128 - 191.
+     * @param w3 Bits of bytes 192 - 255.
+     */
+    constexpr byte_class(unsigned long long w0, unsigned long long w1,
+        unsigned long long w2, unsigned long long w3) noexcept
+        : bits{w0, w1, w2, w3}
+        , nibble_low{}
+        , nibble_high{}
+        , range_first{}
+        , range_size{}
+        , range_count{0}
+        , range_fold{0}
+    {
+        for (unsigned c = 0; c < 256; ++c)
+        {
+            if (!test(c))
+                continue;
+
+            const unsigned char bit = static_cast<unsigned char>(1u << ((c >> 4) & 7));
+
+            if (c < 128)
+                nibble_low[c & 15] |= bit;
+            else
+                nibble_high[c & 15] |= bit;
+
+            // New range
+            if (c == 0 || !test(c - 1))
+            {
+                if (range_count < max_ranges)
+                    range_first[range_count] = static_cast<unsigned char>(c);
+
+                ++range_count;
+            }
+
+            if (range_count <= max_ranges)
+            {
+                range_size[range_count - 1] = static_cast<unsigned char>(
+                    c - range_first[range_count - 1]
+                );
+            }
+        }
+
+        fold_ranges();
+    }
+
+
+    /**
+     * @brief Test if byte is in the set.
+     *
+     * @param c Tested byte.
+     */
+    constexpr bool test(unsigned c) const noexcept
+    {
+        return (bits[(c >> 6) & 3] >> (c & 63)) & 1;
+    }
+
+
+// Private Operations
+private:
+
+
+    /**
+     * @brief Use case folded ranges if they are fewer.
+     *
+     * When each byte is in the class together with the byte with 0x20 bit
+     * set (e.g. `[a-zA-Z]`), bytes are ORed with 0x20 and only bytes with
+     * this bit are tested. Ranges can then span bytes without the bit.
+     */
+    constexpr void fold_ranges() noexcept
+    {
+        for (unsigned c = 0; c < 256; ++c)
+        {
+            if (test(c) != test(c | 0x20))
+                return;
+        }
+
+        unsigned char first[max_ranges] = {};
+        unsigned char size[max_ranges] = {};
+        unsigned count = 0;
+        bool previous = false;
+
+        for (unsigned c = 0x20; c < 256; c = ((c + 1) & 0x20) ? c + 1 : c + 33)
+        {
+            const bool current = test(c);
+
+            if (current && !previous)
+            {
+                if (count < max_ranges)
+                    first[count] = static_cast<unsigned char>(c);
+
+                ++count;
+            }
+
+            if (current && count <= max_ranges)
+                size[count - 1] = static_cast<unsigned char>(c - first[count - 1]);
+
+            previous = current;
+        }
+
+        if (count >= range_count || count > max_ranges)
+            return;
+
+        for (unsigned i = 0; i < max_ranges; ++i)
+        {
+            range_first[i] = first[i];
+            range_size[i] = size[i];
+        }
+
+        range_count = count;
+        range_fold = 0x20;
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first byte not in class (scalar version).
+ *
+ * @param first The first byte.
+ * @param last  Pointer after the last byte.
+ * @param cls   Byte class.
+ *
+ * @return Pointer to found byte or `last`.
+ */
+inline const char* span_class_scalar(const char* first, const char* last,
+    const byte_class& cls) noexcept
+{
+    while (first != last && cls.test(static_cast<unsigned char>(*first)))
+        ++first;
+
+    return first;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Fingerprints of multiple literals for the candidate search.
+ *
+ * Literals are distributed into 8 buckets. For each of the first
+ * `bytes` positions there are nibble tables (for `pshufb` kernels) and
+ * a byte table (for scalar kernel) with bits of buckets that contain
+ * the value at the position. A candidate is a position where all tables
+ * have a common bucket.
+ */
+struct literal_filter
+{
+
+    /// Maximum length of the fingerprint.
+    static constexpr unsigned max_bytes = 3;
+
+    /// A number of buckets.
+    static constexpr unsigned buckets = 8;
+
+    /// Length of the fingerprint (the shortest literal length).
+    unsigned bytes;
+
+    /// Buckets by low nibble of the value at position.
+    unsigned char low[max_bytes][16];
+
+    /// Buckets by high nibble of the value at position.
+    unsigned char high[max_bytes][16];
+
+    /// Buckets by the value at position.
+    unsigned char table[max_bytes][256];
+
+
+    /**
+     * @brief Constructor of filter without literals.
+     */
+    constexpr literal_filter() noexcept
+        : bytes{max_bytes}
+        , low{}
+        , high{}
+        , table{}
+    {
+        // Nothing
+    }
+
+
+    /**
+     * @brief Add literal.
+     *
+     * @param lit   Literal.
+     * @param size  Literal size (at least 1).
+     * @param index Literal index.
+     */
+    constexpr void add(const char* lit, std::size_t size, unsigned index) noexcept
+    {
+        const unsigned char bit = static_cast<unsigned char>(1u << (index % buckets));
+
+        if (size < bytes)
+            bytes = static_cast<unsigned>(size);
+
+        for (unsigned i = 0; i < max_bytes; ++i)
+        {
+            if (i < size)
+            {
+                const unsigned c = static_cast<unsigned char>(lit[i]);
+                low[i][c & 15] |= bit;
+                high[i][c >> 4] |= bit;
+                table[i][c] |= bit;
+            }
+            else
+            {
+                // Position is not part of fingerprint
+                for (unsigned c = 0; c < 256; ++c)
+                {
+                    low[i][c & 15] |= bit;
+                    high[i][c >> 4] |= bit;
+                    table[i][c] |= bit;
+                }
+            }
+        }
+    }
+
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first literal candidate (scalar version).
+ *
+ * @param first  The first byte.
+ * @param last   Pointer after the last byte.
+ * @param filter Literal fingerprints.
+ *
+ * @return Pointer to candidate or `last`.
+ */
+inline const char* find_literals_scalar(const char* first, const char* last,
+    const literal_filter& filter) noexcept
+{
+    for (const char* it = first; static_cast<std::size_t>(last - it) >= filter.bytes; ++it)
+    {
+        unsigned match = filter.table[0][static_cast<unsigned char>(it[0])];
+
+        for (unsigned i = 1; match && i < filter.bytes; ++i)
+            match &= filter.table[i][static_cast<unsigned char>(it[i])];
+
+        if (match)
+            return it;
+    }
+
+    return last;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief A number of inputs processed by `run_dfa_lanes`.
+ *
+ * One input for each 32-bit lane of AVX2 register. There is no AVX-512
+ * kernel (16 lanes), inputs are processed by AVX2 or scalar code only.
+ */
+constexpr std::size_t dfa_lanes = 8;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Run DFA over multiple inputs (scalar version).
+ *
+ * Transition table is indexed by `state + byte` where states are multiples
+ * of 256. States from `sink` don't change by any byte.
+ *
+ * @param table Transition table.
+ * @param sink  The first sink state.
+ * @param data  Inputs, valid pointers even for empty inputs.
+ * @param size  Input sizes.
+ * @param state Starting states, replaced by final states.
+ */
+inline void run_dfa_lanes_scalar(const int* table, int sink, const unsigned char* const* data,
+    const int* size, int* state) noexcept
+{
+    for (std::size_t lane = 0; lane < dfa_lanes; ++lane)
+    {
+        for (int i = 0; i < size[lane] && state[lane] < sink; ++i)
+            state[lane] = table[state[lane] + data[lane][i]];
+    }
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first occurrence of a byte.
+ *
+ * @param first The first byte.
+ * @param last  Pointer after the last byte.
+ * @param c     Searched byte.
+ *
+ * @return Pointer to found byte or `last`.
+ */
+inline const char* find_byte(const char* first, const char* last, char c) noexcept
+{
+    // memchr is already vectorized by C library
+    const void* res = std::memchr(first, c, static_cast<std::size_t>(last - first));
+
+    return res ? static_cast<const char*>(res) : last;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first occurrence of a literal (scalar version).
+ *
+ * @param first The first byte.
+ * @param last  Pointer after the last byte.
+ * @param lit   Literal.
+ * @param size  Literal size (at least 1).
+ *
+ * @return Pointer to found literal or `last`.
+ */
+inline const char* find_literal_scalar(const char* first, const char* last,
+    const char* lit, std::size_t size) noexcept
+{
+    if (static_cast<std::size_t>(last - first) < size)
+        return last;
+
+    const char* const stop = last - size + 1;
+
+    for (const char* it = first; it != stop; ++it)
+    {
+        it = find_byte(it, stop, lit[0]);
+
+        if (it == stop)
+            break;
+
+        if (std::memcmp(it + 1, lit + 1, size - 1) == 0)
+            return it;
+    }
+
+    return last;
+}
+
+/* ************************************************************************ */
+
+#ifdef TEMPLATE_REGEX_SIMD_X86
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first occurrence of a literal (SSE2 version).
+ *
+ * Blocks of 16 positions are filtered by the first and the last literal
+ * byte and only the remaining positions are compared.
+ *
+ * @param first The first byte.
+ * @param last  Pointer after the last byte.
+ * @param lit   Literal.
+ * @param size  Literal size (at least 2).
+ *
+ * @return Pointer to found literal or `last`.
+ */
+inline const char* find_literal_sse2(const char* first, const char* last,
+    const char* lit, std::size_t size) noexcept
+{
+    const __m128i head = _mm_set1_epi8(lit[0]);
+    const __m128i tail = _mm_set1_epi8(lit[size - 1]);
+
+    const char* it = first;
+
+    for (; static_cast<std::size_t>(last - it) >= size - 1 + 16; it += 16)
+    {
+        const __m128i block_head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        const __m128i block_tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + size - 1));
+
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(block_head, head),
+            _mm_cmpeq_epi8(block_tail, tail)
+        )));
+
+        while (mask)
+        {
+            const int pos = __builtin_ctz(mask);
+
+            if (std::memcmp(it + pos + 1, lit + 1, size - 2) == 0)
+                return it + pos;
+
+            mask &= mask - 1;
+        }
+    }
+
+    return find_literal_scalar(it, last, lit, size);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first occurrence of a literal (AVX2 version).
+ *
+ * @param first The first byte.
+ * @param last  Pointer after the last byte.
+ * @param lit   Literal.
+ * @param size  Literal size (at least 2).
+ *
+ * @return Pointer to found literal or `last`.
+ */
+__attribute__((target("avx2")))
+inline const char* find_literal_avx2(const char* first, const char* last,
+    const char* lit, std::size_t size) noexcept
+{
+    const __m256i head = _mm256_set1_epi8(lit[0]);
+    const __m256i tail = _mm256_set1_epi8(lit[size - 1]);
+
+    const char* it = first;
+
+    for (; static_cast<std::size_t>(last - it) >= size - 1 + 32; it += 32)
+    {
+        const __m256i block_head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+        const __m256i block_tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it + size - 1));
+
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(block_head, head),
+            _mm256_cmpeq_epi8(block_tail, tail)
+        )));
+
+        while (mask)
+        {
+            const int pos = __builtin_ctz(mask);
+
+            if (std::memcmp(it + pos + 1, lit + 1, size - 2) == 0)
+                return it + pos;
+
+            mask &= mask - 1;
+        }
+    }
+
+    return find_literal_sse2(it, last, lit, size);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first byte not in class (SSE2 version).
+ *
+ * Each range is tested by single unsigned compare: byte - first <= size.
+ * The class can have at most `byte_class::max_ranges` ranges. Case folded
+ * classes OR bytes with 0x20 first.
+ *
+ * @param first The first byte.
+ * @param last  Pointer after the last byte.
+ * @param cls   Byte class.
+ *
+ * @return Pointer to found byte or `last`.
+ */
+inline const char* span_class_sse2(const char* first, const char* last,
+    const byte_class& cls) noexcept
+{
+    const char* it = first;
+    const __m128i fold = _mm_set1_epi8(static_cast<char>(cls.range_fold));
+
+    for (; last - it >= 16; it += 16)
+    {
+        const __m128i block = _mm_or_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(it)), fold);
+        __m128i in = _mm_setzero_si128();
+
+        for (unsigned i = 0; i < cls.range_count; ++i)
+        {
+            const __m128i diff = _mm_sub_epi8(block,
+                _mm_set1_epi8(static_cast<char>(cls.range_first[i])));
+
+            in = _mm_or_si128(in, _mm_cmpeq_epi8(diff, _mm_min_epu8(diff,
+                _mm_set1_epi8(static_cast<char>(cls.range_size[i])))));
+        }
+
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(in)) ^ 0xFFFFu;
+
+        if (mask)
+            return it + __builtin_ctz(mask);
+    }
+
+    return span_class_scalar(it, last, cls);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first byte not in class (AVX2 version).
+ *
+ * Bytes are tested by `pshufb` lookup: the low nibble selects a row of
+ * bits and the high nibble selects a bit in the row. Any class can be
+ * tested this way.
+ *
+ * @param first The first byte.
+ * @param last  Pointer after the last byte.
+ * @param cls   Byte class.
+ *
+ * @return Pointer to found byte or `last`.
+ */
+__attribute__((target("avx2")))
+inline const char* span_class_avx2(const char* first, const char* last,
+    const byte_class& cls) noexcept
+{
+    const __m256i rows_low = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.nibble_low)));
+    const __m256i rows_high = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.nibble_high)));
+    const __m256i bits = _mm256_setr_epi8(
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+    );
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    const char* it = first;
+
+    for (; last - it >= 32; it += 32)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+        const __m256i low = _mm256_and_si256(block, nibble);
+        const __m256i high = _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble);
+
+        // Bytes above 127 have the sign bit set
+        const __m256i row = _mm256_blendv_epi8(
+            _mm256_shuffle_epi8(rows_low, low),
+            _mm256_shuffle_epi8(rows_high, low),
+            block
+        );
+        const __m256i bit = _mm256_shuffle_epi8(bits, high);
+        const __m256i in = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+
+        const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(in));
+
+        if (mask)
+            return it + __builtin_ctz(mask);
+    }
+
+    return span_class_scalar(it, last, cls);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first byte not in class (AVX2 range version).
+ *
+ * Same as `span_class_sse2` on 32 byte blocks. Classes with at most
+ * `avx2_range_limit` ranges (e.g. digits or whitespaces) are tested
+ * by fewer instructions than by `pshufb` lookup.
+ *
+ * @param first The first byte.
+ * @param last  Pointer after the last byte.
+ * @param cls   Byte class.
+ *
+ * @return Pointer to found byte or `last`.
+ */
+__attribute__((target("avx2")))
+inline const char* span_class_avx2_ranges(const char* first, const char* last,
+    const byte_class& cls) noexcept
+{
+    const __m256i fold = _mm256_set1_epi8(static_cast<char>(cls.range_fold));
+    __m256i low[avx2_range_limit];
+    __m256i size[avx2_range_limit];
+
+    for (unsigned i = 0; i < avx2_range_limit; ++i)
+    {
+        // Unused ranges repeat the first one
+        const unsigned r = i < cls.range_count ? i : 0;
+        low[i] = _mm256_set1_epi8(static_cast<char>(cls.range_first[r]));
+        size[i] = _mm256_set1_epi8(static_cast<char>(cls.range_size[r]));
+    }
+
+    const char* it = first;
+
+    for (; last - it >= 32; it += 32)
+    {
+        const __m256i block = _mm256_or_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it)), fold);
+        __m256i in = _mm256_setzero_si256();
+
+        for (unsigned i = 0; i < avx2_range_limit; ++i)
+        {
+            const __m256i diff = _mm256_sub_epi8(block, low[i]);
+            in = _mm256_or_si256(in, _mm256_cmpeq_epi8(diff, _mm256_min_epu8(diff, size[i])));
+        }
+
+        const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(in));
+
+        if (mask)
+            return it + __builtin_ctz(mask);
+    }
+
+    return span_class_scalar(it, last, cls);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first literal candidate (SSSE3 version).
+ *
+ * @param first  The first byte.
+ * @param last   Pointer after the last byte.
+ * @param filter Literal fingerprints.
+ *
+ * @return Pointer to candidate or `last`.
+ */
+__attribute__((target("ssse3")))
+inline const char* find_literals_ssse3(const char* first, const char* last,
+    const literal_filter& filter) noexcept
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    const char* it = first;
+
+    for (; static_cast<std::size_t>(last - it) >= filter.bytes - 1 + 16; it += 16)
+    {
+        __m128i match = _mm_set1_epi8(-1);
+
+        for (unsigned i = 0; i < filter.bytes; ++i)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + i));
+            const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(filter.low[i]));
+            const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(filter.high[i]));
+
+            match = _mm_and_si128(match, _mm_and_si128(
+                _mm_shuffle_epi8(low, _mm_and_si128(block, nibble)),
+                _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(block, 4), nibble))
+            ));
+        }
+
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(match, _mm_setzero_si128()))) ^ 0xFFFFu;
+
+        if (mask)
+            return it + __builtin_ctz(mask);
+    }
+
+    return find_literals_scalar(it, last, filter);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first literal candidate (AVX2 version).
+ *
+ * @param first  The first byte.
+ * @param last   Pointer after the last byte.
+ * @param filter Literal fingerprints.
+ *
+ * @return Pointer to candidate or `last`.
+ */
+__attribute__((target("avx2")))
+inline const char* find_literals_avx2(const char* first, const char* last,
+    const literal_filter& filter) noexcept
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    const char* it = first;
+
+    for (; static_cast<std::size_t>(last - it) >= filter.bytes - 1 + 32; it += 32)
+    {
+        __m256i match = _mm256_set1_epi8(-1);
+
+        for (unsigned i = 0; i < filter.bytes; ++i)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it + i));
+            const __m256i low = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(filter.low[i])));
+            const __m256i high = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(filter.high[i])));
+
+            match = _mm256_and_si256(match, _mm256_and_si256(
+                _mm256_shuffle_epi8(low, _mm256_and_si256(block, nibble)),
+                _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble))
+            ));
+        }
+
+        const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(match, _mm256_setzero_si256())));
+
+        if (mask)
+            return it + __builtin_ctz(mask);
+    }
+
+    return find_literals_scalar(it, last, filter);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Run DFA over multiple inputs (AVX2 version).
+ *
+ * Each input has own lane and all lanes are advanced by single gather
+ * from transition table. Lanes with finished input or in sink state are
+ * masked out.
+ */
+__attribute__((target("avx2")))
+inline void run_dfa_lanes_avx2(const int* table, int sink, const unsigned char* const* data,
+    const int* size, int* state) noexcept
+{
+    const __m256i sizes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(size));
+    const __m256i last = _mm256_set1_epi32(sink - 1);
+
+    __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state));
+
+    int length = 0;
+
+    for (std::size_t lane = 0; lane < dfa_lanes; ++lane)
+        length = size[lane] > length ? size[lane] : length;
+
+    for (int i = 0; i < length; ++i)
+    {
+        const __m256i active = _mm256_andnot_si256(
+            _mm256_cmpgt_epi32(current, last),
+            _mm256_cmpgt_epi32(sizes, _mm256_set1_epi32(i))
+        );
+
+        if (_mm256_testz_si256(active, active))
+            break;
+
+        // Finished inputs read their first byte, the lane is masked out
+        const __m256i bytes = _mm256_setr_epi32(
+            data[0][i < size[0] ? i : 0], data[1][i < size[1] ? i : 0],
+            data[2][i < size[2] ? i : 0], data[3][i < size[3] ? i : 0],
+            data[4][i < size[4] ? i : 0], data[5][i < size[5] ? i : 0],
+            data[6][i < size[6] ? i : 0], data[7][i < size[7] ? i : 0]
+        );
+
+        current = _mm256_mask_i32gather_epi32(current, table,
+            _mm256_add_epi32(current, bytes), active, 4);
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(state), current);
+}
+
+/* ************************************************************************ */
+
+#endif
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first occurrence of a literal.
+ *
+ * @param first The first byte.
+ * @param last  Pointer after the last byte.
+ * @param lit   Literal.
+ * @param size  Literal size.
+ *
+ * @return Pointer to found literal or `last`.
+ */
+inline const char* find_literal(const char* first, const char* last,
+    const char* lit, std::size_t size) noexcept
+{
+    if (size == 0)
+        return first;
+
+    if (size == 1)
+        return find_byte(first, last, lit[0]);
+
+#ifdef TEMPLATE_REGEX_SIMD_X86
+    if (has_avx2())
+        return find_literal_avx2(first, last, lit, size);
+
+    return find_literal_sse2(first, last, lit, size);
+#else
+    return find_literal_scalar(first, last, lit, size);
+#endif
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first byte not in class.
+ *
+ * @param first The first byte.
+ * @param last  Pointer after the last byte.
+ * @param cls   Byte class.
+ *
+ * @return Pointer to found byte or `last`.
+ */
+inline const char* span_class(const char* first, const char* last,
+    const byte_class& cls) noexcept
+{
+#ifdef TEMPLATE_REGEX_SIMD_X86
+    if (last - first >= 32 && has_avx2())
+    {
+        if (cls.range_count > 0 && cls.range_count <= avx2_range_limit)
+            return span_class_avx2_ranges(first, last, cls);
+
+        return span_class_avx2(first, last, cls);
+    }
+
+    if (cls.range_count <= byte_class::max_ranges)
+        return span_class_sse2(first, last, cls);
+#endif
+
+    return span_class_scalar(first, last, cls);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Find the first position where one of literals can start.
+ *
+ * Returned candidate must be verified by caller.
+ *
+ * @param first  The first byte.
+ * @param last   Pointer after the last byte.
+ * @param filter Literal fingerprints.
+ *
+ * @return Pointer to candidate or `last`.
+ */
+inline const char* find_literals(const char* first, const char* last,
+    const literal_filter& filter) noexcept
+{
+#ifdef TEMPLATE_REGEX_SIMD_X86
+    if (has_avx2())
+        return find_literals_avx2(first, last, filter);
+
+    if (has_ssse3())
+        return find_literals_ssse3(first, last, filter);
+#endif
+
+    return find_literals_scalar(first, last, filter);
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Run DFA over multiple inputs.
+ *
+ * AVX2 gathers are used when available, otherwise the scalar version.
+ * AVX-512 is not implemented.
+ *
+ * @param table Transition table indexed by `state + byte`.
+ * @param sink  The first sink state.
+ * @param data  `dfa_lanes` inputs, valid pointers even for empty inputs.
+ * @param size  Input sizes.
+ * @param state Starting states, replaced by final states.
+ */
+inline void run_dfa_lanes(const int* table, int sink, const unsigned char* const* data,
+    const int* size, int* state) noexcept
+{
+#ifdef TEMPLATE_REGEX_SIMD_X86
+    if (has_avx2())
+        return run_dfa_lanes_avx2(table, sink, data, size, state);
+#endif
+
+    run_dfa_lanes_scalar(table, sink, data, size, state);
+}
+
+/* ************************************************************************ */
+
+}
+}
+
+/* ************************************************************************ */
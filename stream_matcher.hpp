@@ -0,0 +1,307 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+#pragma once
+
+/* ************************************************************************ */
+
+/**
+ * @file stream_matcher.hpp
+ *
+ * This header contains matcher of input that is received in chunks.
+ */
+
+/* ************************************************************************ */
+
+// C++
+#include <cstddef>
+#include <type_traits>
+
+// Library
+#include "rules.hpp"
+#include "automaton.hpp"
+#include "regex.hpp"
+
+/* ************************************************************************ */
+
+namespace template_regex {
+
+/* ************************************************************************ */
+
+/**
+ * @brief Searching rule of stream matcher.
+ *
+ * Regex anchored at the beginning is matched only from the stream
+ * beginning, otherwise it's searched by ".*{Rule}".
+ *
+ * @tparam Rule  Rule without anchors.
+ * @tparam Begin If rule is anchored at the beginning.
+ */
+template<typename Rule, bool Begin>
+struct stream_matcher_rule
+{
+    using type = rules::sequence<rules::repeat_optional<rules::any>, Rule>;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Specialization for regex anchored at the beginning.
+ */
+template<typename Rule>
+struct stream_matcher_rule<Rule, true>
+{
+    using type = Rule;
+};
+
+/* ************************************************************************ */
+
+/**
+ * @brief Matcher of input stream received in chunks.
+ *
+ * The matcher holds only the automaton state between chunks, so chunks
+ * don't have to be buffered and the memory is constant for unbounded
+ * streams. Matches are reported by stream offset where they end:
+ *  - Regex anchored at the end is reported only by `finish`.
+ *  - Regex anchored at the beginning is matched only from the stream
+ *    beginning.
+ *  - Otherwise all positions where any match ends are reported.
+ *
+ * The regex must be convertible into automaton. The searching automaton
+ * (".*{Rule}" for regex not anchored at the beginning) can have much more
+ * states than the regex automaton and it must have less than
+ * TEMPLATE_REGEX_AUTOMATON_MAX_STATES states.
+ *
+ * @tparam Regex Regular expression.
+ */
+template<typename Regex>
+struct stream_matcher
+{
+
+// Private Types
+private:
+
+
+    /// Regex anchors.
+    using _anchors = regex_anchors<typename Regex::rule>;
+
+    /// Searching rule.
+    using _rule = typename stream_matcher_rule<typename _anchors::inner, _anchors::begin>::type;
+
+    static_assert(rules::nfa_traits<_rule>::supported, "Regex cannot be converted into automaton");
+
+    static_assert(!rules::nfa_traits<_rule>::supported || rules::automaton_fits<_rule>::value,
+        "Searching automaton of the regex has too many states (TEMPLATE_REGEX_AUTOMATON_MAX_STATES)");
+
+    /// State machine.
+    using _machine = rules::table_backend::machine<_rule>;
+
+
+// Public Types
+public:
+
+
+    /// Automaton state type.
+    using state_type = typename _machine::state_type;
+
+
+// Public Operations
+public:
+
+
+    /**
+     * @brief Process chunk of the stream.
+     *
+     * @param data     Chunk data.
+     * @param size     Chunk size.
+     * @param callback Functor called with stream offset of each match end.
+     *
+     * @return A number of reported matches.
+     */
+    template<typename Callback>
+    std::size_t feed(const char* data, std::size_t size, Callback callback)
+    {
+        std::size_t count = start(callback);
+
+        // Nothing can be matched
+        if (_machine::dead(state_))
+        {
+            offset_ += size;
+            return count;
+        }
+
+        state_type state = state_;
+        std::size_t found = 0;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            state = _machine::next(state, static_cast<unsigned char>(data[i]));
+
+            // Only anchored regex can reach the dead state
+            if (_machine::dead(state))
+                break;
+
+            if (!_anchors::end && _machine::accepting(state))
+            {
+                callback(offset_ + i + 1);
+                ++found;
+            }
+        }
+
+        state_ = state;
+        offset_ += size;
+        matches_ += found;
+
+        return count + found;
+    }
+
+
+    /**
+     * @brief Process chunk of the stream and count matches.
+     *
+     * @param data Chunk data.
+     * @param size Chunk size.
+     *
+     * @return A number of matches.
+     */
+    std::size_t feed(const char* data, std::size_t size)
+    {
+        return feed(data, size, [](std::size_t) {});
+    }
+
+
+    /**
+     * @brief Finish the stream.
+     *
+     * Matches of regex anchored at the end are reported. The matcher is
+     * reset for the next stream.
+     *
+     * @param callback Functor called with stream offset of each match end.
+     *
+     * @return If the stream contains any match.
+     */
+    template<typename Callback>
+    bool finish(Callback callback)
+    {
+        start(callback);
+
+        if (_anchors::end && _machine::accepting(state_))
+        {
+            callback(offset_);
+            ++matches_;
+        }
+
+        const bool res = matches_ > 0;
+        reset();
+
+        return res;
+    }
+
+
+    /**
+     * @brief Finish the stream.
+     *
+     * @return If the stream contains any match.
+     */
+    bool finish()
+    {
+        return finish([](std::size_t) {});
+    }
+
+
+    /**
+     * @brief Reset the matcher for a new stream.
+     */
+    void reset() noexcept
+    {
+        state_ = _machine::start;
+        offset_ = 0;
+        matches_ = 0;
+        started_ = false;
+    }
+
+
+    /**
+     * @brief Returns current automaton state.
+     */
+    state_type state() const noexcept
+    {
+        return state_;
+    }
+
+
+    /**
+     * @brief Returns a number of processed bytes.
+     */
+    std::size_t offset() const noexcept
+    {
+        return offset_;
+    }
+
+
+// Private Operations
+private:
+
+
+    /**
+     * @brief Report empty match at the stream beginning.
+     *
+     * @return A number of reported matches.
+     */
+    template<typename Callback>
+    std::size_t start(Callback& callback)
+    {
+        if (started_)
+            return 0;
+
+        started_ = true;
+
+        if (_anchors::end || !_machine::accepting(state_))
+            return 0;
+
+        callback(std::size_t(0));
+        ++matches_;
+
+        return 1;
+    }
+
+
+// Private Data Members
+private:
+
+
+    /// Automaton state.
+    state_type state_ = _machine::start;
+
+    /// A number of processed bytes.
+    std::size_t offset_ = 0;
+
+    /// A number of reported matches.
+    std::size_t matches_ = 0;
+
+    /// If the stream beginning was processed.
+    bool started_ = false;
+
+};
+
+/* ************************************************************************ */
+
+}
+
+/* ************************************************************************ */
@@ -0,0 +1,203 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Template Regex
+#include "../analysis.hpp"
+#include "../regex.hpp"
+
+/* ************************************************************************ */
+
+using namespace template_regex;
+
+/* ************************************************************************ */
+
+TEST(analysis, literal_prefix)
+{
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefix<make_regex_t("abc")::rule>::type,
+        rules::int_seq<'a', 'b', 'c'>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefix<make_regex_t("^GET /[a-z]+$")::rule>::type,
+        rules::int_seq<'G', 'E', 'T', ' ', '/'>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefix<make_regex_t("ab+c")::rule>::type,
+        rules::int_seq<'a', 'b'>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefix<make_regex_t("ab?c")::rule>::type,
+        rules::int_seq<'a'>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefix<make_regex_t("(abc|abd)x")::rule>::type,
+        rules::int_seq<'a', 'b'>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefix<make_regex_t("[a-z]abc")::rule>::type,
+        rules::int_seq<>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefix<make_regex_t("a*b")::rule>::type,
+        rules::int_seq<>
+    >();
+}
+
+/* ************************************************************************ */
+
+TEST(analysis, literal_prefixes)
+{
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefixes<make_regex_t("abc")::rule>::type,
+        rules::literal_set<rules::int_seq<'a', 'b', 'c'>>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefixes<make_regex_t("(GET|POST|PUT) /")::rule>::type,
+        rules::literal_set<
+            rules::int_seq<'G', 'E', 'T', ' ', '/'>,
+            rules::int_seq<'P', 'O', 'S', 'T', ' ', '/'>,
+            rules::int_seq<'P', 'U', 'T', ' ', '/'>
+        >
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefixes<make_regex_t("(a|b)(c|d)")::rule>::type,
+        rules::literal_set<
+            rules::int_seq<'a', 'c'>,
+            rules::int_seq<'a', 'd'>,
+            rules::int_seq<'b', 'c'>,
+            rules::int_seq<'b', 'd'>
+        >
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefixes<make_regex_t("(ab+|cd)x")::rule>::type,
+        rules::literal_set<
+            rules::int_seq<'a', 'b'>,
+            rules::int_seq<'c', 'd'>
+        >
+    >();
+
+    // Branch without literal
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefixes<make_regex_t("(ab|[a-z])x")::rule>::type,
+        rules::literal_set<>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_prefixes<make_regex_t("a*b")::rule>::type,
+        rules::literal_set<>
+    >();
+}
+
+/* ************************************************************************ */
+
+/* ************************************************************************ */
+
+TEST(analysis, match_length)
+{
+    using date = make_regex_t("^[0-9][0-9]?/[0-9][0-9]?/[0-9][0-9][0-9][0-9]$");
+
+    static_assert(rules::match_length<date::rule>::min == 8, "Fail date min");
+    static_assert(rules::match_length<date::rule>::max == 10, "Fail date max");
+
+    static_assert(rules::match_length<make_regex_t("ab+c")::rule>::min == 3, "Fail ab+c min");
+    static_assert(rules::match_length<make_regex_t("ab+c")::rule>::max == rules::length_unbounded, "Fail ab+c max");
+
+    static_assert(rules::match_length<make_regex_t("(abc|x)?y")::rule>::min == 1, "Fail (abc|x)?y min");
+    static_assert(rules::match_length<make_regex_t("(abc|x)?y")::rule>::max == 4, "Fail (abc|x)?y max");
+
+    static_assert(rules::match_length<make_regex_t("[0-9]{2,5}")::rule>::min == 2, "Fail {2,5} min");
+    static_assert(rules::match_length<make_regex_t("[0-9]{2,5}")::rule>::max == 5, "Fail {2,5} max");
+
+    static_assert(rules::match_length<make_regex_t("(ab){3,}")::rule>::min == 6, "Fail {3,} min");
+    static_assert(rules::match_length<make_regex_t("(ab){3,}")::rule>::max == rules::length_unbounded, "Fail {3,} max");
+
+    static_assert(rules::match_length<rules::repeat<rules::null_rule>>::max == 0, "Fail repeat of empty");
+
+    // Shortest input accepted by automaton
+    static_assert(rules::automaton_data<regex_anchors<date::rule>::inner>::min_length == 8, "Fail automaton min");
+}
+
+/* ************************************************************************ */
+
+TEST(analysis, nullable)
+{
+    static_assert(!rules::nullable<make_regex_t("ab")::rule>::value, "Fail ab");
+    static_assert(rules::nullable<make_regex_t("a*b?")::rule>::value, "Fail a*b?");
+    static_assert(rules::nullable<make_regex_t("(a|b*)")::rule>::value, "Fail (a|b*)");
+    static_assert(!rules::nullable<make_regex_t("(a|b+)c*")::rule>::value, "Fail (a|b+)c*");
+    static_assert(rules::nullable<make_regex_t("a{0,3}")::rule>::value, "Fail a{0,3}");
+}
+
+/* ************************************************************************ */
+
+TEST(analysis, first_set)
+{
+    constexpr auto set = rules::first_set<make_regex_t("a*[0-9]?(x|yz)")::rule>::set();
+
+    static_assert(set.test('a'), "Fail a");
+    static_assert(set.test('5'), "Fail 5");
+    static_assert(set.test('x'), "Fail x");
+    static_assert(set.test('y'), "Fail y");
+    static_assert(!set.test('z'), "Fail z");
+    static_assert(!set.test('b'), "Fail b");
+
+    static_assert(rules::first_set<make_regex_t("[^a]")::rule>::set().test('b'), "Fail [^a]");
+    static_assert(!rules::first_set<make_regex_t("[^a]")::rule>::set().test('a'), "Fail [^a]");
+}
+
+/* ************************************************************************ */
+
+TEST(analysis, required_literals)
+{
+    ::testing::StaticAssertTypeEq<
+        rules::required_literals<make_regex_t("GET /[a-z]+ HTTP")::rule>::type,
+        rules::literal_set<rules::int_seq<'G', 'E', 'T', ' ', '/'>, rules::int_seq<' ', 'H', 'T', 'T', 'P'>>
+    >();
+
+    // Literal continues into prefix of the following rule
+    ::testing::StaticAssertTypeEq<
+        rules::required_literals<make_regex_t("[0-9]+ab(cd)+")::rule>::type,
+        rules::literal_set<rules::int_seq<'a', 'b', 'c', 'd'>, rules::int_seq<'c', 'd'>>
+    >();
+
+    // Optional parts are not required
+    ::testing::StaticAssertTypeEq<
+        rules::required_literals<make_regex_t("x?(abc)*")::rule>::type,
+        rules::literal_set<>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::literal_set_longest<
+            rules::required_literals<make_regex_t("^.*error: [0-9]+ at x")::rule>::type
+        >::type,
+        rules::int_seq<'e', 'r', 'r', 'o', 'r', ':', ' '>
+    >();
+}
@@ -0,0 +1,329 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// C++
+#include <forward_list>
+#include <string>
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Template Regex
+#include "../automaton.hpp"
+#include "../regex.hpp"
+
+/* ************************************************************************ */
+
+using namespace template_regex;
+
+/* ************************************************************************ */
+
+TEST(automaton, charset)
+{
+    constexpr auto set = rules::class_traits<
+        rules::alternative<rules::range<'a', 'z'>, rules::val<'_'>>
+    >::set();
+
+    static_assert(set.test('a'), "'a' is in set");
+    static_assert(set.test('z'), "'z' is in set");
+    static_assert(set.test('_'), "'_' is in set");
+    static_assert(!set.test('A'), "'A' is not in set");
+
+    constexpr auto neg = rules::class_traits<
+        rules::alternative_not<rules::val<']'>>
+    >::set();
+
+    static_assert(!neg.test(']'), "']' is not in set");
+    static_assert(neg.test('a'), "'a' is in set");
+}
+
+/* ************************************************************************ */
+
+TEST(automaton, states)
+{
+    // a
+    static_assert(rules::automaton_data<rules::val<'a'>>::states == 2, "Fail a");
+
+    // a*
+    static_assert(rules::automaton_data<
+        rules::repeat_optional<rules::val<'a'>>
+    >::states == 1, "Fail a*");
+
+    // [a-z0-9]+
+    static_assert(rules::automaton_data<
+        rules::repeat<rules::alternative<rules::range<'a', 'z'>, rules::range<'0', '9'>>>
+    >::states == 2, "Fail [a-z0-9]+");
+
+    // [0-9]{1,64}: a state for each count
+    static_assert(rules::automaton_data<
+        rules::repeat_n<rules::range<'0', '9'>, 1, 64>
+    >::states == 65, "Fail [0-9]{1,64}");
+
+    // [0-9]{2,}
+    static_assert(rules::automaton_data<
+        rules::repeat_n<rules::range<'0', '9'>, 2, rules::repeat_unbounded>
+    >::states == 3, "Fail [0-9]{2,}");
+
+    // [a-z]: 2 classes ([^a-z], [a-z])
+    static_assert(rules::automaton_data<
+        rules::range<'a', 'z'>
+    >::classes.count == 2, "Fail classes");
+}
+
+/* ************************************************************************ */
+
+TEST(automaton, minimization)
+{
+    // ab|cb: both branches ends in same state
+    using rule1 = rules::alternative<
+        rules::sequence<rules::val<'a'>, rules::val<'b'>>,
+        rules::sequence<rules::val<'c'>, rules::val<'b'>>
+    >;
+
+    static_assert(rules::automaton_data<rule1>::states_before == 5, "Fail before");
+    static_assert(rules::automaton_data<rule1>::states == 3, "Fail after");
+
+    // a(b|c)*: states after 'a', 'b' and 'c' are equivalent
+    using rule2 = rules::sequence<
+        rules::val<'a'>,
+        rules::repeat_optional<rules::alternative<rules::val<'b'>, rules::sequence<rules::val<'c'>>>>
+    >;
+
+    static_assert(rules::automaton_data<rule2>::states == 2, "Fail a(b|c)*");
+
+    // Regex constants
+    using regex = make_regex_t("^(jan|feb|mar)[0-9]$");
+
+    static_assert(regex::states_before > regex::states_after, "Fail regex");
+    static_assert(regex::states_after == 9, "Fail regex");
+
+    EXPECT_TRUE(regex_match(regex{}, std::string("feb1")));
+    EXPECT_TRUE(regex_match(regex{}, std::string("mar9")));
+    EXPECT_FALSE(regex_match(regex{}, std::string("fab1")));
+}
+
+/* ************************************************************************ */
+
+TEST(automaton, match)
+{
+    using rule = rules::automaton<rules::sequence<
+        rules::repeat<rules::range<'a', 'z'>>,
+        rules::val<'1'>
+    >>;
+
+    // Match
+    {
+        const std::string str = "abc1";
+
+        auto it = std::begin(str);
+        EXPECT_TRUE(rule::match_ref(it, std::end(str)));
+        EXPECT_EQ(std::end(str), it);
+    }
+
+    // Match prefix
+    {
+        const std::string str = "abc1xyz";
+
+        auto it = std::begin(str);
+        EXPECT_TRUE(rule::match_ref(it, std::end(str)));
+        EXPECT_EQ(std::begin(str) + 4, it);
+    }
+
+    // No match
+    {
+        const std::string str = "abc";
+
+        auto it = std::begin(str);
+        EXPECT_FALSE(rule::match_ref(it, std::end(str)));
+        EXPECT_EQ(std::begin(str), it);
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(automaton, longest)
+{
+    using rule = rules::automaton<rules::alternative<
+        rules::val<'a'>,
+        rules::sequence<rules::val<'a'>, rules::val<'b'>>
+    >>;
+
+    const std::string str = "abc";
+
+    auto it = std::begin(str);
+    EXPECT_TRUE(rule::match_ref(it, std::end(str)));
+    EXPECT_EQ(std::begin(str) + 2, it);
+}
+
+/* ************************************************************************ */
+
+TEST(automaton, table)
+{
+    using rule = rules::automaton<rules::sequence<
+        rules::repeat<rules::range<'a', 'z'>>,
+        rules::val<'1'>
+    >, false, rules::table_backend>;
+
+    // Match prefix
+    {
+        const std::string str = "abc1xyz";
+
+        auto it = std::begin(str);
+        EXPECT_TRUE(rule::match_ref(it, std::end(str)));
+        EXPECT_EQ(std::begin(str) + 4, it);
+    }
+
+    // No match
+    {
+        const std::string str = "abc";
+
+        auto it = std::begin(str);
+        EXPECT_FALSE(rule::match_ref(it, std::end(str)));
+        EXPECT_EQ(std::begin(str), it);
+    }
+
+    // [a-zA-Z0-9_] is one column
+    using table1 = rules::automaton_table<rules::repeat<rules::alternative<
+        rules::range<'a', 'z'>,
+        rules::range<'A', 'Z'>,
+        rules::range<'0', '9'>,
+        rules::val<'_'>
+    >>>;
+
+    static_assert(table1::classes == 2, "Fail [a-zA-Z0-9_]");
+    EXPECT_EQ(table1::value.class_of['a'], table1::value.class_of['_']);
+    EXPECT_EQ(table1::value.class_of['a'], table1::value.class_of['5']);
+    EXPECT_NE(table1::value.class_of['a'], table1::value.class_of['-']);
+
+    // Minimization makes 'a' and 'c' equivalent
+    using rule2 = rules::alternative<
+        rules::sequence<rules::val<'a'>, rules::val<'b'>>,
+        rules::sequence<rules::val<'c'>, rules::val<'b'>>
+    >;
+
+    static_assert(rules::automaton_data<rule2>::classes.count == 4, "Fail classes");
+    static_assert(rules::automaton_table<rule2>::classes == 3, "Fail merged classes");
+}
+
+/* ************************************************************************ */
+
+TEST(automaton, engines)
+{
+    using regex = make_regex_t("^[-+]?[0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?$");
+    using regex_nested = regex::with_engine<engine::nested>;
+    using regex_code = regex::with_engine<engine::code>;
+    using regex_table = regex::with_engine<engine::table>;
+
+    ::testing::StaticAssertTypeEq<regex::match_rule, regex_code::match_rule>();
+    ::testing::StaticAssertTypeEq<regex::rule, regex_nested::match_rule>();
+
+    for (const std::string str : {"1", "-1.5e10", ".5", "+0.25E-3"})
+    {
+        EXPECT_TRUE(regex_match(regex_code{}, str)) << str;
+        EXPECT_TRUE(regex_match(regex_table{}, str)) << str;
+    }
+
+    for (const std::string str : {"1.", "1e", "", "+", "1.5e10x"})
+    {
+        EXPECT_FALSE(regex_match(regex_code{}, str)) << str;
+        EXPECT_FALSE(regex_match(regex_table{}, str)) << str;
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(automaton, regex)
+{
+    // Greedy nested rules cannot match this
+    {
+        auto regex = make_regex("^a*ab$");
+
+        EXPECT_TRUE(regex_match(regex, std::string("ab")));
+        EXPECT_TRUE(regex_match(regex, std::string("aaab")));
+        EXPECT_FALSE(regex_match(regex, std::string("aaa")));
+        EXPECT_FALSE(regex_match(regex, std::string("aaba")));
+    }
+
+    {
+        auto regex = make_regex("^(int|if)[0-9]*$");
+
+        EXPECT_TRUE(regex_match(regex, std::string("int")));
+        EXPECT_TRUE(regex_match(regex, std::string("if")));
+        EXPECT_TRUE(regex_match(regex, std::string("if10")));
+        EXPECT_FALSE(regex_match(regex, std::string("in")));
+    }
+
+    {
+        auto regex = make_regex("^[-+]?[0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?$");
+
+        EXPECT_TRUE(regex_match(regex, std::string("1")));
+        EXPECT_TRUE(regex_match(regex, std::string("-1.5e10")));
+        EXPECT_TRUE(regex_match(regex, std::string(".5")));
+        EXPECT_FALSE(regex_match(regex, std::string("1.")));
+        EXPECT_FALSE(regex_match(regex, std::string("1e")));
+    }
+
+    // Many states dispatched by binary search
+    {
+        auto regex = make_regex("^a{0,3}[0-9]{1,64}$");
+
+        EXPECT_TRUE(regex_match(regex, std::string("aaa1")));
+        EXPECT_TRUE(regex_match(regex, std::string(64, '1')));
+        EXPECT_TRUE(regex_match(regex, "a" + std::string(64, '1')));
+        EXPECT_FALSE(regex_match(regex, std::string(65, '1')));
+        EXPECT_FALSE(regex_match(regex, std::string("aaaa1")));
+    }
+
+    // Too many DFA states, NFA is simulated
+    {
+        using regex = make_regex_t("^[ab]*a[ab][ab][ab][ab][ab][ab][ab][ab][ab]$");
+        using inner = regex_anchors<regex::rule>::inner;
+
+        static_assert(!rules::automaton_fits<inner>::value, "Fail automaton fits");
+
+        ::testing::StaticAssertTypeEq<rules::nfa_automaton<inner, true>, regex::match_rule>();
+        static_assert(regex::states_after == 0, "Fail states");
+
+        EXPECT_TRUE(regex_match(regex{}, std::string("aaaaaaaaaaab")));
+        EXPECT_TRUE(regex_match(regex{}, std::string("abababababab")));
+        EXPECT_TRUE(regex_match(regex{}, std::string("baaaaaaaaaaa")));
+        EXPECT_TRUE(regex_match(regex{}, std::string("abbbbbbbbb")));
+        EXPECT_FALSE(regex_match(regex{}, std::string("a")));
+        EXPECT_FALSE(regex_match(regex{}, std::string("bbbbbbbbbbbbb")));
+        EXPECT_FALSE(regex_match(regex{}, std::string("abbbbbbbbbc")));
+        EXPECT_FALSE(regex_match(regex{}, std::string("aabbbbbbbbbb")));
+
+        // Forward iterators aren't matched backwards
+        const std::string str = "aaaaaaaaaaab";
+        EXPECT_TRUE(regex_match(regex{}, std::forward_list<char>(str.begin(), str.end())));
+
+        // Search and prefix match
+        using unanchored = make_regex_t("[ab]*a[ab][ab][ab][ab][ab][ab][ab][ab][ab]");
+
+        ::testing::StaticAssertTypeEq<rules::nfa_automaton<inner>, unanchored::match_rule>();
+
+        EXPECT_TRUE(regex_match(unanchored{}, std::string("aaaaaaaaaaabcc")));
+        EXPECT_FALSE(regex_match(unanchored{}, std::string("bbbbbbbbbbbbcc")));
+        EXPECT_TRUE(regex_search(unanchored{}, std::string("cc-aaaaaaaaaaab")));
+        EXPECT_TRUE(regex_search(unanchored{}, std::string("cc-abababababab-cc")));
+        EXPECT_FALSE(regex_search(unanchored{}, std::string("cc-bbbbbbbbbbbb-cc-abbbb")));
+    }
+}
+
+/* ************************************************************************ */
@@ -0,0 +1,143 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// C++
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Template Regex
+#include "../lexer.hpp"
+
+/* ************************************************************************ */
+
+using namespace template_regex;
+
+/* ************************************************************************ */
+
+TEST(lexer, longest)
+{
+    enum class token { none, for_, foreach, identifier, number, space, less, less_equal };
+
+    using for_ = rules::sequence<rules::val<'f'>, rules::val<'o'>, rules::val<'r'>>;
+
+    using foreach = rules::sequence<
+        rules::val<'f'>, rules::val<'o'>, rules::val<'r'>,
+        rules::val<'e'>, rules::val<'a'>, rules::val<'c'>, rules::val<'h'>
+    >;
+
+    using identifier = rules::sequence<
+        rules::alternative<rules::range<'a', 'z'>, rules::val<'_'>>,
+        rules::repeat_optional<rules::alternative<rules::range<'a', 'z'>, rules::range<'0', '9'>, rules::val<'_'>>>
+    >;
+
+    using lexer = rules::lexer<
+        rules::item<for_, static_cast<int>(token::for_)>,
+        rules::item<foreach, static_cast<int>(token::foreach)>,
+        rules::item<identifier, static_cast<int>(token::identifier)>,
+        rules::item<rules::repeat<rules::range<'0', '9'>>, static_cast<int>(token::number)>,
+        rules::item<rules::repeat<rules::val<' '>>, static_cast<int>(token::space)>,
+        rules::item<rules::val<'<'>, static_cast<int>(token::less)>,
+        rules::item<rules::sequence<rules::val<'<'>, rules::val<'='>>, static_cast<int>(token::less_equal)>
+    >;
+
+    using result = std::pair<token, std::size_t>;
+
+    const std::vector<std::pair<std::string, result>> data = {
+        {"for", {token::for_, 3}},
+        {"for(x)", {token::for_, 3}},
+        {"foreach", {token::foreach, 7}},
+        {"foreach(x)", {token::foreach, 7}},
+        {"forea", {token::identifier, 5}},
+        {"format x", {token::identifier, 6}},
+        {"fo", {token::identifier, 2}},
+        {"x1_y <= 5", {token::identifier, 4}},
+        {"12345a", {token::number, 5}},
+        {"   x", {token::space, 3}},
+        {"<=", {token::less_equal, 2}},
+        {"<5", {token::less, 1}},
+        {"+", {token::none, 0}},
+        {"", {token::none, 0}},
+    };
+
+    for (const auto& test : data)
+    {
+        EXPECT_EQ(test.second, lexer::match(test.first.begin(), test.first.end(), token::none))
+            << test.first;
+    }
+
+    // Long tokens
+    {
+        const std::string str = "for" + std::string(100, 'x') + "1 " + std::string(50, ' ') + "x";
+
+        EXPECT_EQ(result(token::identifier, 104), lexer::match(str.begin(), str.end(), token::none));
+        EXPECT_EQ(result(token::space, 51), lexer::match(str.begin() + 104, str.end(), token::none));
+    }
+
+    // Not contiguous bytes
+    const std::string str = "foreach1";
+    const std::list<char> list(str.begin(), str.end());
+    EXPECT_EQ(result(token::identifier, 8), lexer::match(list.begin(), list.end(), token::none));
+}
+
+/* ************************************************************************ */
+
+TEST(lexer, priority)
+{
+    // Same length, the first item wins
+    using lexer1 = rules::lexer<
+        rules::item<rules::sequence<rules::val<'i'>, rules::val<'f'>>, 1>,
+        rules::item<rules::repeat<rules::range<'a', 'z'>>, 2>
+    >;
+
+    using lexer2 = rules::lexer<
+        rules::item<rules::repeat<rules::range<'a', 'z'>>, 2>,
+        rules::item<rules::sequence<rules::val<'i'>, rules::val<'f'>>, 1>
+    >;
+
+    const std::string str = "if";
+    EXPECT_EQ(std::make_pair(1, std::size_t(2)), lexer1::match(str.begin(), str.end(), 0));
+    EXPECT_EQ(std::make_pair(2, std::size_t(2)), lexer2::match(str.begin(), str.end(), 0));
+
+    // Tokenize input
+    const std::string input = "if ifx if";
+    std::vector<int> tokens;
+
+    for (auto it = input.begin(); it != input.end(); )
+    {
+        const auto res = lexer1::match(it, input.end(), 0);
+
+        if (res.second == 0)
+        {
+            ++it;
+            continue;
+        }
+
+        tokens.push_back(res.first);
+        it += res.second;
+    }
+
+    EXPECT_EQ(std::vector<int>({1, 2, 1}), tokens);
+}
+
+/* ************************************************************************ */
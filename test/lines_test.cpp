@@ -0,0 +1,120 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// C++
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Template Regex
+#include "../lines.hpp"
+
+/* ************************************************************************ */
+
+using namespace template_regex;
+
+/* ************************************************************************ */
+
+TEST(lines, for_each_line)
+{
+    const auto split = [](const std::string& str) {
+        std::vector<std::string> res;
+
+        for_each_line(str.data(), str.data() + str.size(), [&res](const char* first, const char* last) {
+            res.emplace_back(first, last);
+        });
+
+        return res;
+    };
+
+    EXPECT_EQ(std::vector<std::string>(), split(""));
+    EXPECT_EQ(std::vector<std::string>({"a"}), split("a"));
+    EXPECT_EQ(std::vector<std::string>({"a"}), split("a\n"));
+    EXPECT_EQ(std::vector<std::string>({"a", "", "bc"}), split("a\n\nbc"));
+    EXPECT_EQ(std::vector<std::string>({""}), split("\n"));
+}
+
+/* ************************************************************************ */
+
+TEST(lines, scan)
+{
+    auto regex = make_regex("^[a-z_][a-z0-9_]*$");
+
+    const std::string data = "abc\n9x\n\nx_1\nfoo bar\nlast";
+    std::vector<std::string> matched;
+
+    const std::size_t count = regex_scan_lines(regex, data.data(), data.data() + data.size(),
+        [&matched](const char* first, const char* last) {
+            matched.emplace_back(first, last);
+        }
+    );
+
+    EXPECT_EQ(3u, count);
+    EXPECT_EQ(std::vector<std::string>({"abc", "x_1", "last"}), matched);
+    EXPECT_EQ(3u, regex_scan_lines(regex, data.data(), data.data() + data.size()));
+}
+
+/* ************************************************************************ */
+
+#ifdef TEMPLATE_REGEX_MAPPED_FILE
+
+TEST(lines, mapped_file)
+{
+    const std::string filename = "lines_test.txt";
+
+    {
+        std::ofstream file(filename);
+        file << "12/5/2015\nx\n1/12/2016\n";
+    }
+
+    {
+        const mapped_file file(filename);
+
+        EXPECT_EQ(22u, file.size());
+        EXPECT_EQ(2u, regex_scan_lines(
+            make_regex("^[0-9][0-9]?/[0-9][0-9]?/[0-9][0-9][0-9][0-9]$"),
+            file.begin(), file.end()
+        ));
+    }
+
+    // Empty file
+    {
+        std::ofstream file(filename);
+    }
+
+    {
+        const mapped_file file(filename);
+
+        EXPECT_EQ(0u, file.size());
+        EXPECT_EQ(0u, regex_scan_lines(make_regex("a*"), file.begin(), file.end()));
+    }
+
+    std::remove(filename.c_str());
+
+    EXPECT_THROW(mapped_file{filename}, std::system_error);
+}
+
+#endif
+
+/* ************************************************************************ */
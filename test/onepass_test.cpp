@@ -0,0 +1,316 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// C++
+#include <string>
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Template Regex
+#include "../regex.hpp"
+
+/* ************************************************************************ */
+
+using namespace template_regex;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Tests if rule of regex without anchors is one-pass.
+ */
+template<typename Regex>
+static constexpr bool onepass() noexcept
+{
+    return rules::is_onepass<typename regex_anchors<typename Regex::rule>::inner>::value;
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Returns group as string.
+ */
+template<typename Results>
+static std::string group(const Results& results, std::size_t index)
+{
+    return std::string(results[index].first, results[index].second);
+}
+
+/* ************************************************************************ */
+
+TEST(onepass, detection)
+{
+    static_assert(onepass<make_regex_t("^([0-9]+)/([0-9]+)/([0-9][0-9][0-9][0-9])$")>(), "");
+    static_assert(onepass<make_regex_t("^([a-z]+)=([0-9]*)$")>(), "");
+    static_assert(onepass<make_regex_t("(GET|POST) /([a-z]+)")>(), "");
+    static_assert(onepass<make_regex_t("([a-z]+)(,[a-z]+)*")>(), "");
+
+    // Two threads after the same byte
+    static_assert(!onepass<make_regex_t("^(a*)(a)$")>(), "");
+    static_assert(!onepass<make_regex_t("^(a|ab)(c|bcd)$")>(), "");
+    static_assert(!onepass<make_regex_t("^([a-z0-9]+)([0-9]+)$")>(), "");
+
+    // Same position reached with and without group
+    static_assert(!onepass<make_regex_t("^(a?)a?b$")>(), "");
+}
+
+/* ************************************************************************ */
+
+TEST(onepass, date)
+{
+    using regex = make_regex_t("^([0-9]+)/([0-9]+)/([0-9][0-9][0-9][0-9])$");
+    regex::results_type<std::string::const_iterator> results;
+
+    const std::string str = "12/5/2015";
+
+    ASSERT_TRUE(regex_match(regex{}, str, results));
+    EXPECT_EQ(str, group(results, 0));
+    EXPECT_EQ("12", group(results, 1));
+    EXPECT_EQ("5", group(results, 2));
+    EXPECT_EQ("2015", group(results, 3));
+
+    EXPECT_FALSE(regex_match(regex{}, std::string("12/5/20155"), results));
+    EXPECT_FALSE(regex_match(regex{}, std::string("12/5/201"), results));
+    EXPECT_FALSE(regex_match(regex{}, std::string("12//2015"), results));
+}
+
+/* ************************************************************************ */
+
+TEST(onepass, prefix)
+{
+    using regex = make_regex_t("([a-z]+)(=([0-9]+))?");
+    regex::results_type<std::string::const_iterator> results;
+
+    {
+        const std::string str = "key=42;";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("key=42", group(results, 0));
+        EXPECT_EQ("key", group(results, 1));
+        EXPECT_EQ("=42", group(results, 2));
+        EXPECT_EQ("42", group(results, 3));
+    }
+
+    // Group started after the last accepting state
+    {
+        const std::string str = "key=;";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("key", group(results, 0));
+        EXPECT_EQ("key", group(results, 1));
+        EXPECT_EQ(str.end(), results[2].first);
+        EXPECT_EQ(str.end(), results[3].first);
+    }
+
+    EXPECT_FALSE(regex_match(regex{}, std::string("=42"), results));
+}
+
+/* ************************************************************************ */
+
+TEST(onepass, repeat)
+{
+    // The last iteration is stored
+    using regex = make_regex_t("^([a-z]+)(,([a-z]+))*$");
+    regex::results_type<std::string::const_iterator> results;
+
+    const std::string str = "a,bc,def";
+
+    ASSERT_TRUE(regex_match(regex{}, str, results));
+    EXPECT_EQ("a", group(results, 1));
+    EXPECT_EQ(",def", group(results, 2));
+    EXPECT_EQ("def", group(results, 3));
+}
+
+/* ************************************************************************ */
+
+TEST(onepass, empty)
+{
+    // Empty group shares the position with other boundaries
+    using regex = make_regex_t("^([-+]?)([0-9]*)(\\.[0-9]+)?$");
+    regex::results_type<std::string::const_iterator> results;
+
+    {
+        const std::string str = "12.5";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ(str.begin(), results[1].first);
+        EXPECT_EQ(str.begin(), results[1].second);
+        EXPECT_EQ("12", group(results, 2));
+        EXPECT_EQ(".5", group(results, 3));
+    }
+
+    {
+        const std::string str = "-7";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("-", group(results, 1));
+        EXPECT_EQ("7", group(results, 2));
+        EXPECT_EQ(str.end(), results[3].first);
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(onepass, fallback)
+{
+    using regex = make_regex_t("^(a|ab)(c|bcd)$");
+    regex::results_type<std::string::const_iterator> results;
+
+    const std::string str = "abcd";
+
+    ASSERT_TRUE(regex_match(regex{}, str, results));
+    EXPECT_EQ("a", group(results, 1));
+    EXPECT_EQ("bcd", group(results, 2));
+}
+
+/* ************************************************************************ */
+
+TEST(onepass, simulation)
+{
+    {
+        using regex = make_regex_t("(a*)ab");
+        regex::results_type<std::string::const_iterator> results;
+
+        const std::string str = "aabx";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("aab", group(results, 0));
+        EXPECT_EQ("a", group(results, 1));
+    }
+
+    {
+        using regex = make_regex_t("^(a|ab)c$");
+        regex::results_type<std::string::const_iterator> results;
+
+        const std::string str = "abc";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("ab", group(results, 1));
+
+        // Results of previous match are not kept
+        const std::string other = "abd";
+
+        ASSERT_FALSE(regex_match(regex{}, other, results));
+        EXPECT_TRUE(results[0].first == other.end());
+        EXPECT_TRUE(results[1].first == other.end());
+    }
+
+    {
+        using regex = make_regex_t("^(x*)(x)$");
+        regex::results_type<std::string::const_iterator> results;
+
+        const std::string str = "xxx";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("xx", group(results, 1));
+        EXPECT_EQ("x", group(results, 2));
+    }
+
+    {
+        using regex = make_regex_t("^(a?)(a)$");
+        regex::results_type<std::string::const_iterator> results;
+
+        const std::string str = "a";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("", group(results, 1));
+        EXPECT_EQ("a", group(results, 2));
+        EXPECT_TRUE(results[1].first == str.begin());
+    }
+
+    {
+        using regex = make_regex_t("^((ab|a)(bc|c))+$");
+        regex::results_type<std::string::const_iterator> results;
+
+        const std::string str = "abcabc";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("abc", group(results, 1));
+        EXPECT_EQ("ab", group(results, 2));
+        EXPECT_EQ("c", group(results, 3));
+        EXPECT_TRUE(results[1].first == str.begin() + 3);
+
+        EXPECT_FALSE(regex_match(regex{}, std::string("abcab"), results));
+    }
+
+    // Counted repetition is greedy
+    {
+        using regex = make_regex_t("^(a{0,2})(a*)$");
+        regex::results_type<std::string::const_iterator> results;
+
+        const std::string str = "aaa";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("aa", group(results, 1));
+        EXPECT_EQ("a", group(results, 2));
+    }
+
+    // Stack doesn't grow with input
+    {
+        using regex = make_regex_t("^(a|ab)*$");
+        regex::results_type<std::string::const_iterator> results;
+
+        std::string str;
+
+        for (int i = 0; i < 100000; ++i)
+            str += "ab";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("ab", group(results, 1));
+        EXPECT_TRUE(results[1].first == str.end() - 2);
+    }
+
+    // Paths are not tried one by one
+    {
+        using regex = make_regex_t("^((a|aa)*c|a*b)$");
+        regex::results_type<std::string::const_iterator> results;
+
+        const std::string str = std::string(1000, 'a') + "b";
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ(str, group(results, 1));
+        EXPECT_TRUE(results[2].first == str.end());
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(onepass, table)
+{
+    using rule = regex_anchors<make_regex_t("^([0-9]+)/([0-9]+)$")::rule>::inner;
+    using data = rules::onepass_data<rule>;
+
+    ASSERT_TRUE(data::value.onepass);
+
+    // The first digit stores beginning of the first group
+    const int digit = data::value.classes.class_of[static_cast<unsigned char>('1')];
+    EXPECT_EQ(1ull << 2, data::value.action[0][digit]);
+
+    const int state = data::value.next[0][digit];
+    ASSERT_GE(state, 0);
+    EXPECT_EQ(0ull, data::value.action[state][digit]);
+    EXPECT_FALSE(data::value.accept[state]);
+
+    // The first digit stores beginning of both empty group and second group
+    using signed_rule = regex_anchors<make_regex_t("^([-+]?)([0-9]+)$")::rule>::inner;
+    using signed_matcher = rules::onepass<signed_rule, true>;
+    EXPECT_EQ(3u, signed_matcher::stores);
+}
+
+/* ************************************************************************ */
@@ -0,0 +1,134 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// C++
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Template Regex
+#include "../parallel_lines.hpp"
+
+/* ************************************************************************ */
+
+using namespace template_regex;
+
+/* ************************************************************************ */
+
+TEST(parallel_lines, split_lines)
+{
+    const std::string data = "ab\ncd\nef\ngh\n";
+    const char* const begin = data.data();
+    const char* const end = begin + data.size();
+
+    EXPECT_EQ(std::vector<const char*>({begin, end}), split_lines(begin, end, 1));
+    EXPECT_EQ(std::vector<const char*>({begin, begin + 6, end}), split_lines(begin, end, 2));
+    EXPECT_EQ(std::vector<const char*>({begin, begin + 3, begin + 6, begin + 9, end}), split_lines(begin, end, 4));
+    EXPECT_EQ(std::vector<const char*>({begin, begin + 3, begin + 6, begin + 9, end}), split_lines(begin, end, 100));
+
+    // Single line
+    const std::string line = "abcdefgh";
+    EXPECT_EQ(std::vector<const char*>({line.data(), line.data() + line.size()}),
+        split_lines(line.data(), line.data() + line.size(), 4));
+}
+
+/* ************************************************************************ */
+
+TEST(parallel_lines, scheduler)
+{
+    work_stealing_scheduler scheduler(10, 3);
+    std::vector<int> runs(10);
+    std::size_t task;
+
+    // Own queue first, then stolen from the back of other queues
+    ASSERT_TRUE(scheduler.pop(0, task));
+    EXPECT_EQ(0u, task);
+
+    while (scheduler.pop(0, task))
+        ++runs[task];
+
+    EXPECT_FALSE(scheduler.pop(1, task));
+    EXPECT_FALSE(scheduler.pop(2, task));
+
+    for (std::size_t i = 1; i < runs.size(); ++i)
+        EXPECT_EQ(1, runs[i]) << i;
+}
+
+/* ************************************************************************ */
+
+TEST(parallel_lines, parallel_for)
+{
+    for (std::size_t threads = 1; threads <= 4; ++threads)
+    {
+        std::vector<std::atomic<int>> runs(100);
+
+        parallel_for(runs.size(), threads, [&runs](std::size_t task) {
+            ++runs[task];
+        });
+
+        for (const auto& run : runs)
+            EXPECT_EQ(1, run);
+    }
+
+    EXPECT_THROW(parallel_for(10, 3, [](std::size_t task) {
+        if (task == 5)
+            throw std::runtime_error("task");
+    }), std::runtime_error);
+}
+
+/* ************************************************************************ */
+
+TEST(parallel_lines, scan)
+{
+    auto regex = make_regex("^[0-9][0-9]?/[0-9][0-9]?/[0-9][0-9][0-9][0-9]$");
+
+    // Large enough for multiple chunks
+    std::string data;
+
+    for (int i = 0; i < 50000; ++i)
+        data += (i % 3) ? std::to_string(i % 12 + 1) + "/" + std::to_string(i % 28 + 1) + "/2015\n" : "x\n";
+
+    const char* const begin = data.data();
+    const char* const end = begin + data.size();
+
+    std::vector<const char*> expected;
+    const std::size_t count = regex_scan_lines(regex, begin, end, [&expected](const char* first, const char*) {
+        expected.push_back(first);
+    });
+
+    for (std::size_t threads = 0; threads <= 4; ++threads)
+    {
+        EXPECT_EQ(count, parallel_scan_lines(regex, begin, end, threads));
+
+        std::vector<const char*> lines;
+        EXPECT_EQ(count, parallel_scan_lines(regex, begin, end, threads, [&lines](const char* first, const char*) {
+            lines.push_back(first);
+        }));
+
+        EXPECT_EQ(expected, lines);
+    }
+
+    EXPECT_EQ(0u, parallel_scan_lines(regex, begin, begin));
+}
+
+/* ************************************************************************ */
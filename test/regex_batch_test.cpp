@@ -0,0 +1,137 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// C++
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Template Regex
+#include "../regex_batch.hpp"
+
+/* ************************************************************************ */
+
+using namespace template_regex;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Match inputs by batch with given lanes and compare with `regex_match`.
+ */
+template<std::size_t Lanes, typename Regex, typename Inputs>
+static void test_batch(const Regex& regex, const Inputs& inputs)
+{
+    std::vector<bool> expected;
+
+    for (const auto& input : inputs)
+        expected.push_back(regex_match(regex, input));
+
+    std::vector<bool> res;
+    const std::size_t count = regex_batch<Regex, Lanes>::match(inputs.begin(), inputs.end(), std::back_inserter(res));
+
+    EXPECT_EQ(expected, res);
+    EXPECT_EQ(static_cast<std::size_t>(std::count(expected.begin(), expected.end(), true)), count);
+}
+
+/* ************************************************************************ */
+
+template<typename Regex, typename Inputs>
+static void test_lanes(const Regex& regex, const Inputs& inputs)
+{
+    test_batch<1>(regex, inputs);
+    test_batch<3>(regex, inputs);
+    test_batch<4>(regex, inputs);
+    test_batch<8>(regex, inputs);
+}
+
+/* ************************************************************************ */
+
+TEST(regex_batch, anchored)
+{
+    const std::vector<std::string> inputs = {
+        "1/1/2015", "12/31/1999", "", "1/1/201", "1/1/20155", "x", "10/10/2010",
+        "1/12/2016", "99/99/9999", "1/1/2015 "
+    };
+
+    test_lanes(make_regex("^[0-9][0-9]?/[0-9][0-9]?/[0-9][0-9][0-9][0-9]$"), inputs);
+}
+
+/* ************************************************************************ */
+
+TEST(regex_batch, prefix)
+{
+    const std::vector<std::string> inputs = {
+        "abc", "abcd", "", "ab", "xabc", "aaaaaaaaaaaaaaaaaaaaaaaaaabc", "abcabc"
+    };
+
+    test_lanes(make_regex("a+bc"), inputs);
+    test_lanes(make_regex("^a*$"), inputs);
+    test_lanes(make_regex("a*"), inputs);
+}
+
+/* ************************************************************************ */
+
+TEST(regex_batch, batch)
+{
+    auto regex = make_regex("^[a-zA-Z_][a-zA-Z0-9_]*$");
+
+    const std::vector<std::string> inputs = {"abc", "9abc", "_", "a b", "x1", ""};
+
+    std::vector<char> res;
+    EXPECT_EQ(3u, regex_match_batch(regex, inputs, std::back_inserter(res)));
+    EXPECT_EQ(std::vector<char>({1, 0, 1, 0, 1, 0}), res);
+
+    EXPECT_TRUE(regex_batch<decltype(regex)>::interleaved);
+    EXPECT_TRUE((regex_batch<decltype(regex), simd::dfa_lanes>::gathered));
+    EXPECT_FALSE((regex_batch<decltype(regex), 4>::gathered));
+}
+
+/* ************************************************************************ */
+
+TEST(regex_batch, states)
+{
+    // Too many DFA states, inputs are matched separately
+    using regex = make_regex_t("^[ab]*a[ab][ab][ab][ab][ab][ab][ab][ab][ab]$");
+    const std::vector<std::string> inputs = {
+        "abbbbbbbbb", "b", "", "aaaaaaaaaaab", "abababababab", "baaaaaaaaaaa", "aabbbbbbbbbb"
+    };
+
+    EXPECT_FALSE((regex_batch<regex>::interleaved));
+
+    std::vector<bool> res;
+    EXPECT_EQ(4u, regex_match_batch(regex{}, inputs, std::back_inserter(res)));
+    EXPECT_EQ(std::vector<bool>({true, false, false, true, true, true, false}), res);
+}
+
+/* ************************************************************************ */
+
+TEST(regex_batch, wide)
+{
+    const std::vector<std::wstring> inputs = {L"abc", L"abd", L""};
+
+    std::vector<bool> res;
+    EXPECT_EQ(1u, regex_match_batch(make_regex(L"^ab(c|e)$"), inputs, std::back_inserter(res)));
+    EXPECT_EQ(std::vector<bool>({true, false, false}), res);
+}
+
+/* ************************************************************************ */
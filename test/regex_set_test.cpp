@@ -0,0 +1,123 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// C++
+#include <list>
+#include <string>
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Template Regex
+#include "../regex_set.hpp"
+
+/* ************************************************************************ */
+
+using namespace template_regex;
+
+/* ************************************************************************ */
+
+TEST(regex_set, product)
+{
+    using set = regex_set<
+        make_regex_t("GET /[a-z]+"),
+        make_regex_t("[A-Z]+"),
+        make_regex_t("^[A-Z]+ /index$"),
+        make_regex_t("a*")
+    >;
+
+    static_assert(set::size == 4, "Wrong size");
+    static_assert(set::merged, "Product automaton expected");
+
+    EXPECT_EQ(set::result_type("1111"), regex_match(set{}, std::string("GET /index")));
+    EXPECT_EQ(set::result_type("1011"), regex_match(set{}, std::string("GET /indexes")));
+    EXPECT_EQ(set::result_type("1110"), regex_match(set{}, std::string("POST /index")));
+    EXPECT_EQ(set::result_type("1000"), regex_match(set{}, std::string("post")));
+    EXPECT_EQ(set::result_type("1000"), regex_match(set{}, std::string("")));
+
+    // Same result as separate matching
+    for (const std::string str : {"GET /a", "GET /", "PUT /index", "PUT /index/", "aaa", "x"})
+    {
+        const auto res = regex_match(set{}, str);
+
+        EXPECT_EQ(regex_match(make_regex("GET /[a-z]+"), str), res[0]);
+        EXPECT_EQ(regex_match(make_regex("[A-Z]+"), str), res[1]);
+        EXPECT_EQ(regex_match(make_regex("^[A-Z]+ /index$"), str), res[2]);
+        EXPECT_EQ(regex_match(make_regex("a*"), str), res[3]);
+    }
+
+    // Not contiguous bytes
+    const std::string str = "GET /index";
+    const std::list<char> list(str.begin(), str.end());
+    EXPECT_EQ(set::result_type("1111"), regex_match(set{}, list.begin(), list.end()));
+}
+
+/* ************************************************************************ */
+
+TEST(regex_set, lockstep)
+{
+    // Product automaton counts modulo 7 * 11 * 13
+    using set = regex_set<
+        make_regex_t("^(aaaaaaa)+$"),
+        make_regex_t("^(aaaaaaaaaaa)+$"),
+        make_regex_t("^(aaaaaaaaaaaaa)+$"),
+        make_regex_t("aaa")
+    >;
+
+    static_assert(!set::merged, "Lockstep automatons expected");
+
+    EXPECT_EQ(set::result_type("1011"), regex_match(set{}, std::string(77, 'a')));
+    EXPECT_EQ(set::result_type("1101"), regex_match(set{}, std::string(91, 'a')));
+    EXPECT_EQ(set::result_type("1000"), regex_match(set{}, std::string(90, 'a')));
+    EXPECT_EQ(set::result_type("0000"), regex_match(set{}, std::string("ab")));
+    EXPECT_EQ(set::result_type("1000"), regex_match(set{}, std::string(7, 'a') + "b"));
+    EXPECT_EQ(set::result_type("1001"), regex_match(set{}, std::string(7, 'a')));
+}
+
+/* ************************************************************************ */
+
+TEST(regex_set, separate)
+{
+    using set = regex_set<
+        make_regex_t(L"[a-z]+"),
+        make_regex_t(L"^[0-9]+$")
+    >;
+
+    EXPECT_EQ(set::result_type("01"), regex_match(set{}, std::wstring(L"abc")));
+    EXPECT_EQ(set::result_type("10"), regex_match(set{}, std::wstring(L"123")));
+    EXPECT_EQ(set::result_type("00"), regex_match(set{}, std::wstring(L"123a")));
+
+    // Too many DFA states
+    using large = regex_set<
+        make_regex_t("^[ab]*a[ab][ab][ab][ab][ab][ab][ab][ab][ab]$"),
+        make_regex_t("^x+$"),
+        make_regex_t("[ab]*a[ab]{9}$")
+    >;
+
+    static_assert(!large::merged, "Separate regexes expected");
+
+    EXPECT_EQ(large::result_type("010"), regex_match(large{}, std::string("xx")));
+    EXPECT_EQ(large::result_type("000"), regex_match(large{}, std::string("ab")));
+    EXPECT_EQ(large::result_type("101"), regex_match(large{}, std::string("aaaaaaaaaaab")));
+    EXPECT_EQ(large::result_type("101"), regex_match(large{}, std::string("abababababab")));
+    EXPECT_EQ(large::result_type("101"), regex_match(large{}, std::string("baaaaaaaaaaa")));
+    EXPECT_EQ(large::result_type("000"), regex_match(large{}, std::string("aabbbbbbbbbb")));
+}
+
+/* ************************************************************************ */
@@ -17,6 +17,12 @@
 /*                                                                          */
 /* ************************************************************************ */
 
+// C++
+#include <cstring>
+#include <forward_list>
+#include <list>
+#include <string>
+
 // Google Test
 #include "gtest/gtest.h"
 
@@ -64,7 +70,7 @@ TEST(regex, rules)
 
     ::testing::StaticAssertTypeEq<
         make_regex_t("[a-z]")::rule,
-        rules::alternative<rules::range<'a', 'z'>>
+        rules::range<'a', 'z'>
     >();
 
     ::testing::StaticAssertTypeEq<
@@ -102,29 +108,86 @@ TEST(regex, rules)
         make_regex_t("[a-z_][a-z0-9_]*")::rule,
         rules::sequence<
             rules::alternative<rules::range<'a', 'z'>, rules::val<'_'>>,
-            rules::repeat_optional<rules::alternative<
+            rules::repeat_optional<rules::bitmap_of<rules::alternative<
                 rules::range<'a', 'z'>,
                 rules::range<'0', '9'>,
                 rules::val<'_'>
-            >>
+            >>::type>
+        >
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("ab|c")::rule,
+        rules::alternative<
+            rules::sequence<rules::val<'a'>, rules::val<'b'>>,
+            rules::val<'c'>
+        >
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("a(b|c)")::rule,
+        rules::sequence<rules::val<'a'>, rules::group<1, rules::range<'b', 'c'>>>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("((a)b)(c)")::rule,
+        rules::sequence<
+            rules::group<1, rules::sequence<rules::group<2, rules::val<'a'>>, rules::val<'b'>>>,
+            rules::group<3, rules::val<'c'>>
         >
     >();
 
     ::testing::StaticAssertTypeEq<
         make_regex_t("[0-9][0-9]?/[0-9][0-9]?/[0-9][0-9][0-9][0-9]")::rule,
         rules::sequence<
-            rules::alternative<rules::range<'0', '9'>>,
-            rules::optional<rules::alternative<rules::range<'0', '9'>>>,
+            rules::range<'0', '9'>,
+            rules::optional<rules::range<'0', '9'>>,
             rules::val<'/'>,
-            rules::alternative<rules::range<'0', '9'>>,
-            rules::optional<rules::alternative<rules::range<'0', '9'>>>,
+            rules::range<'0', '9'>,
+            rules::optional<rules::range<'0', '9'>>,
             rules::val<'/'>,
-            rules::alternative<rules::range<'0', '9'>>,
-            rules::alternative<rules::range<'0', '9'>>,
-            rules::alternative<rules::range<'0', '9'>>,
-            rules::alternative<rules::range<'0', '9'>>
+            rules::range<'0', '9'>,
+            rules::range<'0', '9'>,
+            rules::range<'0', '9'>,
+            rules::range<'0', '9'>
         >
     >();
+
+    // Counted repetition
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("a{3}")::rule,
+        rules::repeat_n<rules::val<'a'>, 3, 3>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("a{2,10}")::rule,
+        rules::repeat_n<rules::val<'a'>, 2, 10>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("a{2,}")::rule,
+        rules::repeat_n<rules::val<'a'>, 2, rules::repeat_unbounded>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("a{0,}")::rule,
+        rules::repeat_optional<rules::val<'a'>>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("a{1,}")::rule,
+        rules::repeat<rules::val<'a'>>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("a{0,1}")::rule,
+        rules::optional<rules::val<'a'>>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("a{1}b")::rule,
+        rules::sequence<rules::val<'a'>, rules::val<'b'>>
+    >();
 }
 
 /* ************************************************************************ */
@@ -195,3 +258,457 @@ TEST(regex, regex6)
 }
 
 /* ************************************************************************ */
+
+TEST(regex, counted)
+{
+    auto regex = make_regex("^[0-9]{1,2}/[0-9]{1,2}/[0-9]{4}$");
+
+    EXPECT_TRUE(regex_match(regex, std::string("1/2/2015")));
+    EXPECT_TRUE(regex_match(regex, std::string("10/12/2015")));
+    EXPECT_FALSE(regex_match(regex, std::string("100/12/2015")));
+    EXPECT_FALSE(regex_match(regex, std::string("10/12/201")));
+    EXPECT_FALSE(regex_match(regex, std::string("10/12/20155")));
+    EXPECT_FALSE(regex_match(regex, std::string("/12/2015")));
+
+    auto groups = make_regex("^(ab){2,3}c$");
+
+    EXPECT_FALSE(regex_match(groups, std::string("abc")));
+    EXPECT_TRUE(regex_match(groups, std::string("ababc")));
+    EXPECT_TRUE(regex_match(groups, std::string("abababc")));
+    EXPECT_FALSE(regex_match(groups, std::string("ababababc")));
+}
+
+/* ************************************************************************ */
+
+TEST(regex, length)
+{
+    using date = make_regex_t("^[0-9]{1,2}/[0-9]{1,2}/[0-9]{4}$");
+
+    static_assert(date::min_length == 8, "Fail min_length");
+    static_assert(date::max_length == 10, "Fail max_length");
+
+    auto test = [](auto regex)
+    {
+        EXPECT_FALSE(regex_match(regex, std::string("1/2/201")));
+        EXPECT_TRUE(regex_match(regex, std::string("1/2/2015")));
+        EXPECT_TRUE(regex_match(regex, std::string("10/12/2015")));
+        EXPECT_FALSE(regex_match(regex, std::string("10/12/20150")));
+    };
+
+    test(date{});
+    test(date::with_engine<engine::nested>{});
+    test(date::with_engine<engine::table>{});
+
+    // Prefix match accepts longer inputs
+    {
+        auto regex = make_regex("ab[0-9]");
+
+        EXPECT_FALSE(regex_match(regex, std::string("ab")));
+        EXPECT_TRUE(regex_match(regex, std::string("ab1")));
+        EXPECT_TRUE(regex_match(regex, std::string("ab1 and more")));
+    }
+
+    // Input length is unknown
+    {
+        auto regex = make_regex("^[0-9]{1,2}/[0-9]{1,2}/[0-9]{4}$");
+        const std::string str = "10/12/2015";
+        const std::list<char> input(str.begin(), str.end());
+
+        EXPECT_TRUE(regex_match(regex, input));
+        EXPECT_FALSE(regex_match(regex, std::list<char>(str.begin(), str.end() - 1)));
+    }
+
+    // With results
+    {
+        auto regex = make_regex("^([0-9]{1,2})/([0-9]{1,2})/([0-9]{4})$");
+        const std::string str = "10/12/20150";
+        decltype(regex)::results_type<std::string::const_iterator> results;
+
+        EXPECT_FALSE(regex_match(regex, str, results));
+        EXPECT_EQ(str.end(), results[0].first);
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(regex, search)
+{
+    // Unanchored automaton has too many states
+    {
+        using regex = make_regex_t("[ace][ab][ab][ab][ab][ab][ab][ab][ab][ab]");
+
+        static_assert(regex::states_after < 16, "Fail regex states");
+
+        const std::string str = "xxcbbbbbbbbbbx";
+        const std::list<char> list(str.begin(), str.end());
+        const std::list<char> other{'x', 'a', 'b', 'x'};
+
+        EXPECT_TRUE(regex_search(regex{}, str));
+        EXPECT_TRUE(regex_search(regex{}, list.begin(), list.end()));
+        EXPECT_FALSE(regex_search(regex{}, other.begin(), other.end()));
+    }
+
+    // Anchored
+    {
+        auto regex = make_regex("^ab");
+
+        EXPECT_TRUE(regex_search(regex, std::string("abc")));
+        EXPECT_FALSE(regex_search(regex, std::string("cab")));
+    }
+
+    // Literal prefix
+    {
+        auto regex = make_regex("GET /[a-z]+");
+
+        EXPECT_TRUE(regex_search(regex, std::string("x GET /index")));
+        EXPECT_TRUE(regex_search(regex, std::string("GET / GET /a")));
+        EXPECT_FALSE(regex_search(regex, std::string("GET / POST /a")));
+        EXPECT_FALSE(regex_search(regex, std::string("")));
+
+        const char* str = "127.0.0.1 - - \"GET /index HTTP/1.1\" 200";
+        EXPECT_TRUE(regex_search(regex, str, str + std::strlen(str)));
+    }
+
+    // Literal prefix and end
+    {
+        auto regex = make_regex("\\.log$");
+
+        EXPECT_TRUE(regex_search(regex, std::string("file.log")));
+        EXPECT_TRUE(regex_search(regex, std::string("a.log.log")));
+        EXPECT_FALSE(regex_search(regex, std::string("file.log.gz")));
+    }
+
+    // Literal prefixes
+    {
+        auto regex = make_regex("(GET|POST|DELETE) /[a-z]+");
+
+        EXPECT_TRUE(regex_search(regex, std::string("x POST /index")));
+        EXPECT_TRUE(regex_search(regex, std::string("GET / DELETE /a")));
+        EXPECT_FALSE(regex_search(regex, std::string("GET / PUT /a")));
+        EXPECT_FALSE(regex_search(regex, std::string("")));
+
+        const std::string log = std::string(100, '.') + "PUT /a POS /b DELETE /c";
+        EXPECT_TRUE(regex_search(regex, log));
+        EXPECT_FALSE(regex_search(regex, log.substr(0, log.size() - 1)));
+
+        // Not contiguous bytes
+        const std::list<char> list(log.begin(), log.end());
+        EXPECT_TRUE(regex_search(regex, list.begin(), list.end()));
+    }
+
+    // Automaton
+    {
+        auto regex = make_regex("[0-9]+/[0-9]+");
+
+        EXPECT_TRUE(regex_search(regex, std::string("date: 12/5")));
+        EXPECT_FALSE(regex_search(regex, std::string("date: 12/x")));
+    }
+
+    // Automaton and end
+    {
+        auto regex = make_regex("[0-9]+$");
+
+        EXPECT_TRUE(regex_search(regex, std::string("abc12")));
+        EXPECT_FALSE(regex_search(regex, std::string("12abc")));
+    }
+
+    // Nested rules
+    {
+        auto regex = make_regex_t("[0-9]+/[0-9]+")::with_engine<engine::nested>{};
+
+        EXPECT_TRUE(regex_search(regex, std::string("date: 12/5")));
+        EXPECT_FALSE(regex_search(regex, std::string("date: 12/x")));
+
+        const std::wstring wide = L"date: 12/5";
+        EXPECT_TRUE(regex_search(make_regex_t("[0-9]+/[0-9]+")::with_engine<engine::nested>{}, wide));
+    }
+
+    // Required literal in long input
+    {
+        auto regex = make_regex("[a-z]+ error: [0-9]+");
+        const std::string log = std::string(300, '.') + "disk error: 28";
+
+        EXPECT_TRUE(regex_search(regex, log));
+        EXPECT_FALSE(regex_search(regex, log.substr(0, log.size() - 2)));
+        EXPECT_FALSE(regex_search(regex, std::string(300, '.') + "disk errors: 28"));
+
+        auto nested = make_regex_t("[a-z]+ error: [0-9]+")::with_engine<engine::nested>{};
+
+        EXPECT_TRUE(regex_search(nested, log));
+        EXPECT_FALSE(regex_search(nested, std::string(300, '.') + "disk errors: 28"));
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(regex, reverse)
+{
+    ::testing::StaticAssertTypeEq<
+        rules::reverse_rule<make_regex_t("ab(c|de)+$")::rule>::type,
+        rules::begin<rules::sequence<
+            rules::repeat<rules::group<1, rules::alternative<
+                rules::val<'c'>,
+                rules::sequence<rules::val<'e'>, rules::val<'d'>>
+            >>>,
+            rules::val<'b'>,
+            rules::val<'a'>
+        >>
+    >();
+
+    // Matched backwards
+    {
+        auto regex = make_regex(".*\\.log$");
+
+        EXPECT_TRUE(regex_match(regex, std::string("file.log")));
+        EXPECT_TRUE(regex_match(regex, std::string(".log")));
+        EXPECT_FALSE(regex_match(regex, std::string("file.log.gz")));
+        EXPECT_FALSE(regex_match(regex, std::string("log")));
+
+        const std::string str = "dir/file.log";
+        EXPECT_TRUE(regex_match(regex, std::list<char>(str.begin(), str.end())));
+        EXPECT_TRUE(regex_match(regex, std::forward_list<char>(str.begin(), str.end())));
+    }
+
+    // Searched backwards
+    {
+        auto regex = make_regex("[0-9]+(px|em)$");
+
+        EXPECT_TRUE(regex_search(regex, std::string("width: 10px")));
+        EXPECT_FALSE(regex_search(regex, std::string("width: 10px;")));
+        EXPECT_FALSE(regex_search(regex, std::string("width: px")));
+
+        const std::string str = "width: 10em";
+        EXPECT_TRUE(regex_search(regex, std::forward_list<char>(str.begin(), str.end())));
+    }
+
+    // Match positions
+    {
+        auto regex = make_regex("[0-9]+(px|em)");
+        const std::string str = "width: 100px, height: 2em";
+        std::pair<std::string::const_iterator, std::string::const_iterator> match;
+
+        ASSERT_TRUE(regex_search(regex, str.begin(), str.end(), match));
+        EXPECT_EQ("100px", std::string(match.first, match.second));
+
+        EXPECT_FALSE(regex_search(regex, str.begin(), str.begin() + 10, match));
+    }
+
+    {
+        auto regex = make_regex("[0-9]+(px|em)$");
+        const std::string str = "width: 100px, height: 20em";
+        std::pair<std::string::const_iterator, std::string::const_iterator> match;
+
+        ASSERT_TRUE(regex_search(regex, str.begin(), str.end(), match));
+        EXPECT_EQ("20em", std::string(match.first, match.second));
+    }
+
+    {
+        auto regex = make_regex("^[a-z]+");
+        const std::string str = "width: 100px";
+        std::pair<std::string::const_iterator, std::string::const_iterator> match;
+
+        ASSERT_TRUE(regex_search(regex, str.begin(), str.end(), match));
+        EXPECT_EQ("width", std::string(match.first, match.second));
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(regex, icase)
+{
+    using url = make_regex_t("^https?://[a-z0-9.]+/$");
+
+    static_assert(!url::icase, "Fail case sensitive");
+    static_assert(url::with_icase::icase, "Fail case insensitive");
+    static_assert(url::with_icase::states_after == url::states_after, "Fail states");
+
+    auto test = [](auto regex)
+    {
+        EXPECT_TRUE(regex_match(regex, std::string("http://example.com/")));
+        EXPECT_TRUE(regex_match(regex, std::string("HTTPS://Example.COM/")));
+        EXPECT_FALSE(regex_match(regex, std::string("HTTPX://Example.COM/")));
+        EXPECT_FALSE(regex_match(regex, std::string("http://exa_mple.com/")));
+    };
+
+    test(url::with_icase{});
+    test(url::with_icase::with_engine<engine::nested>{});
+    test(url::with_icase::with_engine<engine::table>{});
+
+    EXPECT_FALSE(regex_match(url{}, std::string("HTTP://example.com/")));
+
+    // Macro and search
+    EXPECT_TRUE(regex_search(make_regex_icase("error: [0-9]+"), std::string("disk ERROR: 28")));
+    EXPECT_TRUE(regex_match(make_regex_icase("^[^a-c]+$"), std::string("xyz")));
+    EXPECT_FALSE(regex_match(make_regex_icase("^[^a-c]+$"), std::string("xBz")));
+}
+
+/* ************************************************************************ */
+
+TEST(regex, classes)
+{
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("\\d\\W")::rule,
+        rules::sequence<rules::digit, rules::char_class<rules::ctype_word, true>>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        make_regex_t("[[:alpha:]_]")::rule,
+        rules::alternative<rules::char_class<rules::ctype_alpha>, rules::val<'_'>>
+    >();
+
+    using number = make_regex_t("^\\s*[+-]?\\d+(\\.\\d+)?\\s*$");
+    using identifier = make_regex_t("^[[:alpha:]_][[:alnum:]_]*$");
+    using other = make_regex_t("^\\S+\\D[^[:space:][:punct:]]$");
+
+    auto test = [](auto number, auto identifier)
+    {
+        EXPECT_TRUE(regex_match(number, std::string(" -12.50\t")));
+        EXPECT_FALSE(regex_match(number, std::string("1 2")));
+        EXPECT_TRUE(regex_match(identifier, std::string("_value1")));
+        EXPECT_FALSE(regex_match(identifier, std::string("1value")));
+    };
+
+    test(number{}, identifier{});
+    test(number::with_engine<engine::nested>{}, identifier::with_engine<engine::nested>{});
+    test(number::with_engine<engine::table>{}, identifier::with_engine<engine::table>{});
+
+    // Automaton only, nested rules are possessive
+    EXPECT_TRUE(regex_match(other{}, std::string("a-b1cx")));
+    EXPECT_FALSE(regex_match(other{}, std::string("a-bc1x")));
+    EXPECT_FALSE(regex_match(other{}, std::string("a-b1c.")));
+    EXPECT_TRUE(regex_match(other::with_engine<engine::table>{}, std::string("a-b1cx")));
+
+    // Sets tested by bitmap
+    using number_set = make_regex_t("^[-+.eE0-9a-fA-F_]+[^-+.eE]$");
+
+    EXPECT_TRUE(regex_match(number_set::with_engine<engine::nested>{}, std::string("+1.5e-3_0x")));
+    EXPECT_FALSE(regex_match(number_set::with_engine<engine::nested>{}, std::string("+1.5e-3_0g.")));
+    EXPECT_TRUE(regex_match(number_set{}, std::string("+1.5e-3_0x")));
+
+    // Dash before ']' and after class
+    EXPECT_TRUE(regex_match(make_regex("^[\\d.-]+$"), std::string("1.2-3")));
+    EXPECT_FALSE(regex_match(make_regex("^[\\d.-]+$"), std::string("1,2")));
+    EXPECT_TRUE(regex_match(make_regex_icase("^[[:upper:]]+$"), std::string("aBc")));
+}
+
+/* ************************************************************************ */
+
+TEST(regex, prefix_trie)
+{
+    using keywords = make_regex_t("^(select|set|insert|into|index|update|union)$");
+
+    auto test = [](auto regex)
+    {
+        for (const std::string str : {"select", "set", "insert", "into", "index", "update", "union"})
+            EXPECT_TRUE(regex_match(regex, str)) << str;
+
+        for (const std::string str : {"", "se", "sets", "in", "inx", "delete"})
+            EXPECT_FALSE(regex_match(regex, str)) << str;
+    };
+
+    test(keywords{});
+    test(keywords::with_engine<engine::nested>{});
+
+    // More cases than a comparison chain
+    using many = make_regex_t("^(and|bool|case|do|else|for|goto|if|new|or|try)$");
+
+    for (const std::string str : {"and", "bool", "case", "do", "else", "for", "goto", "if", "new", "or", "try"})
+        EXPECT_TRUE(regex_match(many::with_engine<engine::nested>{}, str)) << str;
+
+    for (const std::string str : {"", "an", "xor", "trys", "\xff"})
+        EXPECT_FALSE(regex_match(many::with_engine<engine::nested>{}, str)) << str;
+
+    // Groups of factored branches
+    using regex = make_regex_t("^(in(t|k)|if)-([a-z]+)$");
+    regex::results_type<std::string::const_iterator> results;
+    const std::string str = "ink-abc";
+
+    ASSERT_TRUE(regex_match(regex::with_engine<engine::nested>{}, str, results));
+    EXPECT_EQ("ink", std::string(results[1].first, results[1].second));
+    EXPECT_EQ("k", std::string(results[2].first, results[2].second));
+    EXPECT_EQ("abc", std::string(results[3].first, results[3].second));
+}
+
+/* ************************************************************************ */
+
+TEST(regex, results)
+{
+    // Date groups
+    {
+        using regex = make_regex_t("^([0-9][0-9]?)/([0-9][0-9]?)/([0-9][0-9][0-9][0-9])$");
+        static_assert(regex::groups == 3, "Three groups");
+
+        const std::string str = "12/5/2015";
+        regex::results_type<std::string::const_iterator> results;
+
+        ASSERT_TRUE(regex_match(regex{}, str.begin(), str.end(), results));
+        EXPECT_EQ(str, std::string(results[0].first, results[0].second));
+        EXPECT_EQ("12", std::string(results[1].first, results[1].second));
+        EXPECT_EQ("5", std::string(results[2].first, results[2].second));
+        EXPECT_EQ("2015", std::string(results[3].first, results[3].second));
+
+        EXPECT_FALSE(regex_match(regex{}, std::string("12/5/15"), results));
+    }
+
+    // Nested groups
+    {
+        using regex = make_regex_t("^((a+)b)(c)?d$");
+        static_assert(regex::groups == 3, "Three groups");
+
+        const std::string str = "aabd";
+        regex::results_type<std::string::const_iterator> results;
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("aab", std::string(results[1].first, results[1].second));
+        EXPECT_EQ("aa", std::string(results[2].first, results[2].second));
+
+        // Unmatched group
+        EXPECT_EQ(str.end(), results[3].first);
+        EXPECT_EQ(str.end(), results[3].second);
+    }
+
+    // Alternative
+    {
+        using regex = make_regex_t("(GET|POST) /([a-z]+)");
+
+        const std::string str = "POST /index.html";
+        regex::results_type<std::string::const_iterator> results;
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("POST /index", std::string(results[0].first, results[0].second));
+        EXPECT_EQ("POST", std::string(results[1].first, results[1].second));
+        EXPECT_EQ("index", std::string(results[2].first, results[2].second));
+    }
+
+    // Group of abandoned branch
+    {
+        using regex = make_regex_t("^((a)b|ac)(c*)c$");
+        static_assert(regex::groups == 3, "Three groups");
+
+        const std::string str = "accc";
+        regex::results_type<std::string::const_iterator> results;
+
+        ASSERT_TRUE(regex_match(regex{}, str, results));
+        EXPECT_EQ("ac", std::string(results[1].first, results[1].second));
+        EXPECT_EQ(str.end(), results[2].first);
+        EXPECT_EQ(str.end(), results[2].second);
+        EXPECT_EQ("c", std::string(results[3].first, results[3].second));
+
+        EXPECT_FALSE(regex_match(regex{}, str.begin(), str.begin() + 2, results));
+        EXPECT_EQ(str.begin() + 2, results[1].first);
+    }
+
+    // Forward iterator
+    {
+        using regex = make_regex_t("^([a-z]+)=([0-9]+)$");
+
+        const std::list<char> list{'k', 'e', 'y', '=', '4', '2'};
+        regex::results_type<std::list<char>::const_iterator> results;
+
+        ASSERT_TRUE(regex_match(regex{}, list.begin(), list.end(), results));
+        EXPECT_EQ("key", std::string(results[1].first, results[1].second));
+        EXPECT_EQ("42", std::string(results[2].first, results[2].second));
+    }
+}
+
+/* ************************************************************************ */
@@ -18,6 +18,10 @@
 /* ************************************************************************ */
 
 // C++
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <list>
 #include <string>
 
 // Google Test
@@ -421,6 +425,57 @@ TEST(rules, repeat_optional)
 
 /* ************************************************************************ */
 
+TEST(rules, repeat_class)
+{
+    using word = rules::alternative<
+        rules::range<'a', 'z'>,
+        rules::range<'A', 'Z'>,
+        rules::range<'0', '9'>,
+        rules::val<'_'>
+    >;
+
+    using rule = rules::repeat<word>;
+
+    using rule_optional = rules::repeat_optional<
+        rules::range<'a', 'z'>
+    >;
+
+    static_assert(rules::class_scan<word, const char*>::value, "");
+    static_assert(!rules::class_scan<word, const wchar_t*>::value, "");
+
+    // Long runs are scanned by blocks
+    for (std::size_t pos : {0u, 1u, 15u, 16u, 33u, 64u, 99u})
+    {
+        std::string str(100, 'x');
+        str[pos] = '-';
+
+        const std::wstring wstr(str.begin(), str.end());
+
+        auto it = std::begin(str);
+        EXPECT_EQ(pos != 0, rule::match_ref(it, std::end(str))) << pos;
+        EXPECT_EQ(std::next(std::begin(str), pos), it) << pos;
+
+        const char* ptr = str.data();
+        EXPECT_TRUE(rule_optional::match_ref(ptr, str.data() + str.size())) << pos;
+        EXPECT_EQ(str.data() + pos, ptr) << pos;
+
+        // Generic path
+        auto wit = std::begin(wstr);
+        EXPECT_EQ(pos != 0, rule::match_ref(wit, std::end(wstr))) << pos;
+        EXPECT_EQ(std::next(std::begin(wstr), pos), wit) << pos;
+    }
+
+    // Empty input
+    {
+        const std::string str;
+
+        EXPECT_FALSE(rule::match(std::begin(str), std::end(str)));
+        EXPECT_TRUE(rule_optional::match(std::begin(str), std::end(str)));
+    }
+}
+
+/* ************************************************************************ */
+
 TEST(rules, optional)
 {
     using rule = rules::repeat_optional<
@@ -639,3 +694,439 @@ TEST(rules, identifier)
 }
 
 /* ************************************************************************ */
+
+TEST(rules, repeat_n)
+{
+    using digit = rules::range<'0', '9'>;
+
+    // [0-9]{2,4}
+    using rule = rules::repeat_n<digit, 2, 4>;
+
+    // Contiguous, random access and bidirectional iterators
+    for (const std::string str : {"1", "12", "123", "1234", "12345", "1a", ""})
+    {
+        const auto size = str.size();
+        const bool matched = size >= 2 && std::isdigit(str[1]);
+        const std::size_t length = matched ? std::min<std::size_t>(size, 4) : 0;
+
+        {
+            auto it = str.data();
+            EXPECT_EQ(matched, rule::match_ref(it, str.data() + size)) << str;
+            if (matched)
+            {
+                EXPECT_EQ(length, static_cast<std::size_t>(it - str.data())) << str;
+            }
+        }
+
+        {
+            const std::deque<char> seq(str.begin(), str.end());
+            auto it = seq.begin();
+            EXPECT_EQ(matched, rule::match_ref(it, seq.end())) << str;
+            if (matched)
+            {
+                EXPECT_EQ(length, static_cast<std::size_t>(it - seq.begin())) << str;
+            }
+        }
+
+        {
+            const std::list<char> seq(str.begin(), str.end());
+            auto it = seq.begin();
+            EXPECT_EQ(matched, rule::match_ref(it, seq.end())) << str;
+            if (matched)
+            {
+                EXPECT_EQ(length, static_cast<std::size_t>(std::distance(seq.begin(), it))) << str;
+            }
+        }
+    }
+
+    // Exact count: [0-9]{12}
+    {
+        using exact = rules::repeat_n<digit, 12>;
+
+        EXPECT_TRUE(exact::match_all(std::string("123456789012")));
+        EXPECT_FALSE(exact::match_all(std::string("12345678901")));
+        EXPECT_FALSE(exact::match_all(std::string("1234567890123")));
+    }
+
+    // Unbounded: [0-9]{3,}
+    {
+        using unbounded = rules::repeat_n<digit, 3, rules::repeat_unbounded>;
+
+        EXPECT_FALSE(unbounded::match_all(std::string("12")));
+        EXPECT_TRUE(unbounded::match_all(std::string("123")));
+        EXPECT_TRUE(unbounded::match_all(std::string(100, '7')));
+    }
+
+    // Not a class: (ab){1,2}
+    {
+        using ab = rules::repeat_n<rules::sequence<rules::val<'a'>, rules::val<'b'>>, 1, 2>;
+
+        const std::string str = "ababa";
+        auto it = std::begin(str);
+
+        EXPECT_TRUE(ab::match_ref(it, std::end(str)));
+        EXPECT_EQ(4, it - std::begin(str));
+        EXPECT_FALSE(ab::match_all(std::string("a")));
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(rules, icase)
+{
+    // Letters
+    ::testing::StaticAssertTypeEq<
+        rules::icase_rule<rules::sequence<rules::val<'A'>, rules::val<'1'>, rules::range<'a', 'f'>>>::type,
+        rules::sequence<rules::range_icase<'a', 'a'>, rules::val<'1'>, rules::range_icase<'a', 'f'>>
+    >();
+
+    // Range with other values
+    ::testing::StaticAssertTypeEq<
+        rules::icase_rule<rules::range<'0', 'Z'>>::type,
+        rules::alternative<rules::range<'0', 'Z'>, rules::range_icase<'a', 'z'>>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::icase_rule<rules::val_not<'x'>>::type,
+        rules::alternative_not<rules::range_icase<'x', 'x'>>
+    >();
+
+    using hex = rules::range_icase<'a', 'f'>;
+
+    for (unsigned c = 0; c < 256; ++c)
+    {
+        const bool expected = (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+
+        EXPECT_EQ(expected, hex::is(static_cast<char>(c))) << c;
+        EXPECT_EQ(expected, rules::class_traits<hex>::set().test(c)) << c;
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(rules, char_class)
+{
+    for (unsigned c = 0; c < 256; ++c)
+    {
+        const char value = static_cast<char>(c);
+        const bool ascii = c < 128;
+
+        EXPECT_EQ(ascii && std::isdigit(c) != 0, rules::digit::is(value)) << c;
+        EXPECT_EQ(ascii && (std::isalnum(c) || c == '_'), rules::word::is(value)) << c;
+        EXPECT_EQ(ascii && std::isspace(c) != 0, rules::whitespace::is(value)) << c;
+        EXPECT_EQ(!(ascii && std::isspace(c)), (rules::char_class<rules::ctype_space, true>::is(value))) << c;
+        EXPECT_EQ(ascii && std::ispunct(c) != 0, rules::char_class<rules::ctype_punct>::is(value)) << c;
+        EXPECT_EQ(ascii && std::isprint(c) != 0, rules::char_class<rules::ctype_print>::is(value)) << c;
+        EXPECT_EQ(ascii && std::isgraph(c) != 0, rules::char_class<rules::ctype_graph>::is(value)) << c;
+        EXPECT_EQ(ascii && std::iscntrl(c) != 0, rules::char_class<rules::ctype_cntrl>::is(value)) << c;
+        EXPECT_EQ(ascii && std::isxdigit(c) != 0, rules::char_class<rules::ctype_xdigit>::is(value)) << c;
+        EXPECT_EQ(c == ' ' || c == '\t', rules::char_class<rules::ctype_blank>::is(value)) << c;
+        EXPECT_EQ(rules::word::is(value), rules::class_traits<rules::word>::set().test(c)) << c;
+    }
+
+    ::testing::StaticAssertTypeEq<
+        rules::icase_rule<rules::char_class<rules::ctype_upper>>::type,
+        rules::char_class<rules::ctype_alpha>
+    >();
+
+    // Scanned run
+    const std::string str = "0123456789012345678901234567890123456789x";
+    auto it = str.begin();
+
+    EXPECT_TRUE(rules::repeat<rules::digit>::match_ref(it, str.end()));
+    EXPECT_EQ(str.end() - 1, it);
+}
+
+/* ************************************************************************ */
+
+TEST(rules, bitmap)
+{
+    using number = rules::alternative<
+        rules::val<'-'>, rules::val<'+'>, rules::val<'.'>, rules::val<'e'>, rules::val<'E'>,
+        rules::range<'0', '9'>, rules::range<'a', 'f'>, rules::range<'A', 'F'>, rules::val<'_'>
+    >;
+    using number_bitmap = rules::bitmap_rule<number>::type;
+    using not_number_bitmap = rules::bitmap_rule<rules::alternative_not<number>>::type;
+
+    ::testing::StaticAssertTypeEq<number_bitmap, rules::bitmap_of<number>::type>();
+
+    for (unsigned c = 0; c < 256; ++c)
+    {
+        const char value = static_cast<char>(c);
+
+        EXPECT_EQ(number::match(&value, &value + 1), number_bitmap::is(value)) << c;
+        EXPECT_NE(number_bitmap::is(value), not_number_bitmap::is(value)) << c;
+    }
+
+    // Short alternatives and rules that are not classes are kept
+    ::testing::StaticAssertTypeEq<
+        rules::bitmap_rule<rules::alternative<rules::range<'a', 'z'>, rules::val<'_'>>>::type,
+        rules::alternative<rules::range<'a', 'z'>, rules::val<'_'>>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::bitmap_rule<rules::alternative<rules::val<'a'>, rules::val<'b'>, rules::sequence<rules::val<'c'>, rules::val<'d'>>>>::type,
+        rules::alternative<rules::val<'a'>, rules::val<'b'>, rules::sequence<rules::val<'c'>, rules::val<'d'>>>
+    >();
+
+    // Inner rules
+    ::testing::StaticAssertTypeEq<
+        rules::bitmap_rule<rules::sequence<rules::val<'x'>, rules::group<1, rules::repeat<number>>>>::type,
+        rules::sequence<rules::val<'x'>, rules::group<1, rules::repeat<number_bitmap>>>
+    >();
+
+    // Case-insensitive bitmap
+    using hex = rules::icase_rule<rules::bitmap_of<rules::alternative<rules::range<'0', '9'>, rules::range<'a', 'f'>>>::type>::type;
+
+    for (unsigned c = 0; c < 256; ++c)
+        EXPECT_EQ(std::isxdigit(c) != 0, hex::is(static_cast<char>(c))) << c;
+}
+
+/* ************************************************************************ */
+
+TEST(rules, prefix_trie)
+{
+    using int_ = rules::sequence<rules::val<'i'>, rules::val<'n'>, rules::val<'t'>>;
+    using if_ = rules::sequence<rules::val<'i'>, rules::val<'f'>>;
+    using in = rules::sequence<rules::val<'i'>, rules::val<'n'>>;
+    using else_ = rules::sequence<rules::val<'e'>, rules::val<'l'>, rules::val<'s'>, rules::val<'e'>>;
+
+    // i(n(t|)|f)|else
+    using rule = rules::prefix_trie_rule<rules::alternative<int_, if_, in, else_>>::type;
+
+    ::testing::StaticAssertTypeEq<rule, rules::prefix_switch<
+        rules::prefix_case<'i', rules::prefix_switch<
+            rules::prefix_case<'n', rules::optional<rules::val<'t'>>>,
+            rules::prefix_case<'f', rules::null_rule>
+        >>,
+        rules::prefix_case<'e', rules::sequence<rules::val<'l'>, rules::val<'s'>, rules::val<'e'>>>
+    >>();
+
+    for (const std::string str : {"int", "if", "in", "else"})
+    {
+        auto it = str.begin();
+        EXPECT_TRUE(rule::match_ref(it, str.end())) << str;
+        EXPECT_EQ(str.end(), it) << str;
+    }
+
+    for (const std::string str : {"", "x", "ex"})
+    {
+        auto it = str.begin();
+        EXPECT_FALSE(rule::match_ref(it, str.end())) << str;
+    }
+
+    // The first rule wins as in alternative
+    ::testing::StaticAssertTypeEq<
+        rules::prefix_trie_rule<rules::alternative<in, int_>>::type,
+        rules::prefix_switch<rules::prefix_case<'i', rules::prefix_switch<rules::prefix_case<'n', rules::null_rule>>>>
+    >();
+
+    // Classes and rules that don't start with value are kept
+    using word = rules::alternative<rules::range<'a', 'z'>, rules::val<'_'>>;
+    using other = rules::alternative<if_, rules::sequence<word, rules::val<'x'>>>;
+
+    ::testing::StaticAssertTypeEq<rules::prefix_trie_rule<word>::type, word>();
+    ::testing::StaticAssertTypeEq<rules::prefix_trie_rule<other>::type, other>();
+
+    ::testing::StaticAssertTypeEq<
+        rules::prefix_trie_rule<rules::repeat<rules::group<1, rules::alternative<if_, else_>>>>::type,
+        rules::repeat<rules::group<1, rules::prefix_switch<
+            rules::prefix_case<'i', rules::val<'f'>>,
+            rules::prefix_case<'e', rules::sequence<rules::val<'l'>, rules::val<'s'>, rules::val<'e'>>>
+        >>>
+    >();
+}
+
+/* ************************************************************************ */
+
+/**
+ * @brief Number of rule types in rule tree.
+ */
+template<typename Rule>
+struct rule_nodes;
+
+template<typename... Rules>
+struct rule_nodes_sum : std::integral_constant<std::size_t, 0> {};
+
+template<typename Rule, typename... Rules>
+struct rule_nodes_sum<Rule, Rules...>
+    : std::integral_constant<std::size_t, rule_nodes<Rule>::value + rule_nodes_sum<Rules...>::value> {};
+
+template<typename Rule>
+struct rule_nodes : std::integral_constant<std::size_t, 1> {};
+
+template<template<typename...> class Rule, typename... Rules>
+struct rule_nodes<Rule<Rules...>>
+    : std::integral_constant<std::size_t, 1 + rule_nodes_sum<Rules...>::value> {};
+
+/* ************************************************************************ */
+
+TEST(rules, simplify)
+{
+    using a = rules::val<'a'>;
+    using b = rules::val<'b'>;
+
+    // Sequences are flattened
+    ::testing::StaticAssertTypeEq<
+        rules::simplify<rules::sequence<a, rules::sequence<b, rules::sequence<a>>, rules::sequence<b>>>::type,
+        rules::sequence<a, b, a, b>
+    >();
+
+    ::testing::StaticAssertTypeEq<rules::simplify<rules::sequence<rules::sequence<a>>>::type, a>();
+
+    // Nested quantifiers are collapsed
+    ::testing::StaticAssertTypeEq<rules::simplify<rules::repeat_optional<rules::repeat_optional<a>>>::type, rules::repeat_optional<a>>();
+    ::testing::StaticAssertTypeEq<rules::simplify<rules::optional<rules::repeat_optional<a>>>::type, rules::repeat_optional<a>>();
+    ::testing::StaticAssertTypeEq<rules::simplify<rules::optional<rules::repeat<a>>>::type, rules::repeat_optional<a>>();
+    ::testing::StaticAssertTypeEq<rules::simplify<rules::repeat<rules::repeat<a>>>::type, rules::repeat<a>>();
+    ::testing::StaticAssertTypeEq<rules::simplify<rules::optional<rules::optional<a>>>::type, rules::optional<a>>();
+    ::testing::StaticAssertTypeEq<
+        rules::simplify<rules::repeat<rules::optional<rules::sequence<rules::repeat<a>>>>>::type,
+        rules::repeat_optional<a>
+    >();
+
+    // Groups keep the inner rule
+    ::testing::StaticAssertTypeEq<
+        rules::simplify<rules::repeat<rules::group<1, rules::repeat<a>>>>::type,
+        rules::repeat<rules::group<1, rules::repeat<a>>>
+    >();
+
+    // Ranges are merged in place of the first one
+    ::testing::StaticAssertTypeEq<
+        rules::simplify<rules::alternative<rules::range<'a', 'c'>, rules::val<'x'>, rules::range<'b', 'f'>, rules::val<'g'>>>::type,
+        rules::alternative<rules::range<'a', 'g'>, rules::val<'x'>>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::simplify<rules::alternative<rules::val<'a'>, rules::val<'c'>, rules::val<'b'>>>::type,
+        rules::range<'a', 'c'>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::simplify<rules::alternative_not<rules::val<'a'>, rules::range<'b', 'z'>>>::type,
+        rules::alternative_not<rules::range<'a', 'z'>>
+    >();
+
+    ::testing::StaticAssertTypeEq<
+        rules::simplify<rules::alternative<rules::range<'0', '9'>>>::type,
+        rules::range<'0', '9'>
+    >();
+
+    // Alternatives are flattened and duplicates removed
+    using ab = rules::sequence<a, b>;
+
+    ::testing::StaticAssertTypeEq<
+        rules::simplify<rules::alternative<ab, rules::alternative<rules::sequence<ab>, rules::digit>, rules::digit>>::type,
+        rules::alternative<ab, rules::digit>
+    >();
+
+    // Fewer rule types
+    using parsed = rules::sequence<
+        rules::alternative<rules::range<'a', 'z'>>,
+        rules::optional<rules::repeat_optional<rules::sequence<rules::alternative<a, a, b>>>>,
+        rules::sequence<rules::val<'c'>>
+    >;
+
+    using simple = rules::simplify<parsed>::type;
+
+    ::testing::StaticAssertTypeEq<simple, rules::sequence<
+        rules::range<'a', 'z'>,
+        rules::repeat_optional<rules::range<'a', 'b'>>,
+        rules::val<'c'>
+    >>();
+
+    static_assert(rule_nodes<parsed>::value == 12, "Fail parsed nodes");
+    static_assert(rule_nodes<simple>::value == 5, "Fail simple nodes");
+
+    for (const std::string str : {"x", "xc", "xababc", "xabd"})
+    {
+        auto it1 = str.begin();
+        auto it2 = str.begin();
+        EXPECT_EQ(parsed::match_ref(it1, str.end()), simple::match_ref(it2, str.end())) << str;
+        EXPECT_EQ(it1, it2) << str;
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(rules, list)
+{
+    enum class keyword { none, for_, foreach, format, if_ };
+
+    using for_ = rules::sequence<rules::val<'f'>, rules::val<'o'>, rules::val<'r'>>;
+
+    // Literals
+    using literals = rules::list<
+        rules::item<for_, static_cast<int>(keyword::for_)>,
+        rules::item<rules::sequence<
+            rules::val<'f'>, rules::val<'o'>, rules::val<'r'>,
+            rules::val<'e'>, rules::val<'a'>, rules::val<'c'>, rules::val<'h'>
+        >, static_cast<int>(keyword::foreach)>,
+        rules::item<rules::sequence<rules::val<'i'>, rules::val<'f'>>, static_cast<int>(keyword::if_)>,
+        rules::item<rules::sequence<rules::val<'i'>, rules::val<'f'>>, static_cast<int>(keyword::format)>
+    >;
+
+    static_assert(rules::list_trie<
+        rules::item<for_, 0>,
+        rules::item<rules::val<'x'>, 1>
+    >::supported, "");
+
+    static_assert(!rules::list_trie<
+        rules::item<for_, 0>,
+        rules::item<rules::repeat<rules::val<'x'>>, 1>
+    >::supported, "");
+
+    // Longest match
+    for (const std::string str : {"foreach", "foreach(x)", "for", "for(x)", "forea", "if", "iff", "fo", "x", ""})
+    {
+        auto it = std::begin(str);
+        const keyword res = literals::match(it, std::end(str), keyword::none);
+
+        const keyword expected =
+            str.compare(0, 7, "foreach") == 0 ? keyword::foreach :
+            str.compare(0, 3, "for") == 0 ? keyword::for_ :
+            str.compare(0, 2, "if") == 0 ? keyword::if_ :
+            keyword::none
+        ;
+
+        EXPECT_EQ(expected, res) << str;
+        EXPECT_EQ(std::begin(str), it) << str;
+    }
+
+    // Not byte values
+    {
+        const std::wstring str = L"forĀ";
+        auto it = std::begin(str);
+
+        EXPECT_EQ(keyword::for_, literals::match(it, std::end(str), keyword::none));
+    }
+
+    // Rules are matched in order
+    using mixed = rules::list<
+        rules::item<for_, static_cast<int>(keyword::for_)>,
+        rules::item<rules::repeat<rules::range<'a', 'z'>>, static_cast<int>(keyword::format)>
+    >;
+
+    {
+        const std::string str = "foreach";
+        auto it = std::begin(str);
+
+        EXPECT_EQ(keyword::for_, mixed::match(it, std::end(str), keyword::none));
+    }
+
+    {
+        const std::string str = "format";
+        auto it = std::begin(str);
+
+        EXPECT_EQ(keyword::for_, mixed::match(it, std::end(str), keyword::none));
+    }
+
+    {
+        const std::string str = "if";
+        auto it = std::begin(str);
+
+        EXPECT_EQ(keyword::format, mixed::match(it, std::end(str), keyword::none));
+    }
+}
+
+/* ************************************************************************ */
@@ -0,0 +1,355 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// C++
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Template Regex
+#include "../simd.hpp"
+
+/* ************************************************************************ */
+
+using namespace template_regex;
+
+/* ************************************************************************ */
+
+TEST(simd, find_byte)
+{
+    const std::string str = "hello world";
+    const char* first = str.data();
+    const char* last = first + str.size();
+
+    EXPECT_EQ(first + 4, simd::find_byte(first, last, 'o'));
+    EXPECT_EQ(last, simd::find_byte(first, last, 'x'));
+    EXPECT_EQ(first, simd::find_byte(first, first, 'h'));
+}
+
+/* ************************************************************************ */
+
+TEST(simd, find_literal)
+{
+    // Long input covers vectorized blocks and the tail
+    std::string str(200, 'a');
+
+    for (std::size_t pos : {0u, 1u, 15u, 16u, 31u, 32u, 63u, 100u, 195u})
+    {
+        std::string input = str;
+        input.replace(pos, 5, "GET /");
+
+        const char* first = input.data();
+        const char* last = first + input.size();
+
+        EXPECT_EQ(first + pos, simd::find_literal(first, last, "GET /", 5)) << pos;
+        EXPECT_EQ(first + pos, simd::find_literal_scalar(first, last, "GET /", 5)) << pos;
+        EXPECT_EQ(first + pos, simd::find_literal(first, last, "GE", 2)) << pos;
+        EXPECT_EQ(first + pos, simd::find_literal(first, last, "G", 1)) << pos;
+        EXPECT_EQ(last, simd::find_literal(first, last, "GET !", 5)) << pos;
+    }
+
+    // Partial literal at the end
+    {
+        const std::string input = std::string(40, 'x') + "GE";
+        const char* first = input.data();
+        const char* last = first + input.size();
+
+        EXPECT_EQ(last, simd::find_literal(first, last, "GET", 3));
+    }
+
+    // Literal longer than input
+    {
+        const std::string input = "GE";
+        const char* first = input.data();
+
+        EXPECT_EQ(first + 2, simd::find_literal(first, first + 2, "GET", 3));
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(simd, span_class)
+{
+    // [a-zA-Z0-9_]
+    static constexpr simd::byte_class word{
+        0x03FF000000000000ull, 0x07FFFFFE87FFFFFEull, 0, 0
+    };
+
+    EXPECT_EQ(4u, word.range_count);
+    EXPECT_TRUE(word.test('a'));
+    EXPECT_TRUE(word.test('_'));
+    EXPECT_FALSE(word.test('-'));
+
+    std::string str(200, 'x');
+
+    for (std::size_t pos : {0u, 1u, 15u, 16u, 31u, 32u, 63u, 100u, 199u})
+    {
+        std::string input = str;
+        input[pos] = '-';
+
+        const char* first = input.data();
+        const char* last = first + input.size();
+
+        EXPECT_EQ(first + pos, simd::span_class(first, last, word)) << pos;
+        EXPECT_EQ(first + pos, simd::span_class_scalar(first, last, word)) << pos;
+#ifdef TEMPLATE_REGEX_SIMD_X86
+        EXPECT_EQ(first + pos, simd::span_class_sse2(first, last, word)) << pos;
+
+        if (simd::has_avx2())
+        {
+            EXPECT_EQ(first + pos, simd::span_class_avx2(first, last, word)) << pos;
+        }
+#endif
+    }
+
+    {
+        const char* first = str.data();
+        const char* last = first + str.size();
+
+        EXPECT_EQ(last, simd::span_class(first, last, word));
+        EXPECT_EQ(first, simd::span_class(first, first, word));
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(simd, span_class_bytes)
+{
+    // Every byte tested in class with many ranges (odd bytes) and its
+    // complement (even bytes)
+    static constexpr simd::byte_class odd{
+        0xAAAAAAAAAAAAAAAAull, 0xAAAAAAAAAAAAAAAAull,
+        0xAAAAAAAAAAAAAAAAull, 0xAAAAAAAAAAAAAAAAull
+    };
+
+    EXPECT_EQ(128u, odd.range_count);
+
+    for (unsigned c = 0; c < 256; ++c)
+    {
+        std::string input(64, '\x01');
+        input[40] = static_cast<char>(c);
+
+        const char* first = input.data();
+        const char* last = first + input.size();
+        const char* expected = (c & 1) ? last : first + 40;
+
+        EXPECT_EQ(expected, simd::span_class(first, last, odd)) << c;
+        EXPECT_EQ(expected, simd::span_class_scalar(first, last, odd)) << c;
+#ifdef TEMPLATE_REGEX_SIMD_X86
+        if (simd::has_avx2())
+        {
+            EXPECT_EQ(expected, simd::span_class_avx2(first, last, odd)) << c;
+        }
+#endif
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(simd, span_class_fold)
+{
+    // [a-zA-Z]: single range after OR 0x20
+    static constexpr simd::byte_class alpha{
+        0, 0x07FFFFFE07FFFFFEull, 0, 0
+    };
+
+    EXPECT_EQ(1u, alpha.range_count);
+    EXPECT_EQ(0x20u, alpha.range_fold);
+
+    // [a-zA-Z0-9_] cannot be folded ('_' is not with DEL)
+    static constexpr simd::byte_class word{
+        0x03FF000000000000ull, 0x07FFFFFE87FFFFFEull, 0, 0
+    };
+
+    EXPECT_EQ(0u, word.range_fold);
+
+    for (unsigned c = 0; c < 256; ++c)
+    {
+        std::string input(64, 'q');
+        input[40] = static_cast<char>(c);
+
+        const char* first = input.data();
+        const char* last = first + input.size();
+        const char* expected = alpha.test(c) ? last : first + 40;
+
+        EXPECT_EQ(expected, simd::span_class(first, last, alpha)) << c;
+#ifdef TEMPLATE_REGEX_SIMD_X86
+        EXPECT_EQ(expected, simd::span_class_sse2(first, last, alpha)) << c;
+#endif
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(simd, span_class_ranges)
+{
+    // [0-9] and [\t-\r ]: compared by ranges instead of lookup
+    static constexpr simd::byte_class digits{0x03FF000000000000ull, 0, 0, 0};
+    static constexpr simd::byte_class spaces{0x0000000100003E00ull, 0, 0, 0};
+
+    EXPECT_EQ(1u, digits.range_count);
+    EXPECT_EQ(2u, spaces.range_count);
+
+    for (const simd::byte_class* cls : {&digits, &spaces})
+    {
+        for (unsigned c = 0; c < 256; ++c)
+        {
+            std::string input(64, cls == &digits ? '7' : ' ');
+            input[40] = static_cast<char>(c);
+
+            const char* first = input.data();
+            const char* last = first + input.size();
+            const char* expected = cls->test(c) ? last : first + 40;
+
+            EXPECT_EQ(expected, simd::span_class(first, last, *cls)) << c;
+#ifdef TEMPLATE_REGEX_SIMD_X86
+            if (simd::has_avx2())
+            {
+                EXPECT_EQ(expected, simd::span_class_avx2_ranges(first, last, *cls)) << c;
+            }
+#endif
+        }
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(simd, contiguous)
+{
+    EXPECT_TRUE(simd::contiguous<const char*>::value);
+    EXPECT_TRUE(simd::contiguous<unsigned char*>::value);
+    EXPECT_TRUE(simd::contiguous<std::string::const_iterator>::value);
+    EXPECT_FALSE(simd::contiguous<const wchar_t*>::value);
+    EXPECT_FALSE(simd::contiguous<std::wstring::const_iterator>::value);
+}
+
+/* ************************************************************************ */
+
+TEST(simd, find_literals)
+{
+    simd::literal_filter filter;
+    filter.add("GET", 3, 0);
+    filter.add("POST", 4, 1);
+    filter.add("PUT", 3, 2);
+
+    EXPECT_EQ(3u, filter.bytes);
+
+    std::string str(200, 'x');
+
+    for (std::size_t pos : {0u, 1u, 15u, 16u, 31u, 32u, 63u, 100u, 197u})
+    {
+        for (const char* lit : {"GET", "PUT"})
+        {
+            std::string input = str;
+            input.replace(pos, 3, lit);
+
+            const char* first = input.data();
+            const char* last = first + input.size();
+
+            EXPECT_EQ(first + pos, simd::find_literals(first, last, filter)) << pos;
+            EXPECT_EQ(first + pos, simd::find_literals_scalar(first, last, filter)) << pos;
+#ifdef TEMPLATE_REGEX_SIMD_X86
+            if (simd::has_ssse3())
+            {
+                EXPECT_EQ(first + pos, simd::find_literals_ssse3(first, last, filter)) << pos;
+            }
+
+            if (simd::has_avx2())
+            {
+                EXPECT_EQ(first + pos, simd::find_literals_avx2(first, last, filter)) << pos;
+            }
+#endif
+        }
+    }
+
+    // No candidates
+    {
+        const std::string input = std::string(100, 'x') + "GE";
+        const char* first = input.data();
+        const char* last = first + input.size();
+
+        EXPECT_EQ(last, simd::find_literals(first, last, filter));
+    }
+
+    // Literals in same bucket give also false candidates
+    {
+        simd::literal_filter shared;
+        shared.add("GET", 3, 0);
+        shared.add("ABC", 3, simd::literal_filter::buckets);
+
+        const std::string input = std::string(50, 'x') + "GBC";
+        const char* first = input.data();
+        const char* last = first + input.size();
+
+        EXPECT_EQ(last, simd::find_literals(first, last, filter));
+        EXPECT_EQ(first + 50, simd::find_literals(first, last, shared));
+    }
+}
+
+/* ************************************************************************ */
+
+TEST(simd, run_dfa_lanes)
+{
+    // Parity of 'a' bytes, any other byte goes to the sink
+    std::vector<int> table(3 * 256, 2 * 256);
+    table['a'] = 1 * 256;
+    table[256 + 'a'] = 0;
+
+    for (int c = 0; c < 256; ++c)
+        table[2 * 256 + c] = 2 * 256;
+
+    const std::string inputs[simd::dfa_lanes] = {"", "a", "aa", "aaa", "aax", "xaa", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "aaaaab"};
+    const int expected[simd::dfa_lanes] = {0, 256, 0, 256, 512, 512, 256, 512};
+
+    const unsigned char* data[simd::dfa_lanes];
+    int size[simd::dfa_lanes];
+
+    for (std::size_t lane = 0; lane < simd::dfa_lanes; ++lane)
+    {
+        data[lane] = reinterpret_cast<const unsigned char*>(inputs[lane].c_str());
+        size[lane] = static_cast<int>(inputs[lane].size());
+    }
+
+    {
+        int state[simd::dfa_lanes] = {};
+        simd::run_dfa_lanes(table.data(), 2 * 256, data, size, state);
+        EXPECT_TRUE(std::equal(std::begin(expected), std::end(expected), std::begin(state)));
+    }
+
+    {
+        int state[simd::dfa_lanes] = {};
+        simd::run_dfa_lanes_scalar(table.data(), 2 * 256, data, size, state);
+        EXPECT_TRUE(std::equal(std::begin(expected), std::end(expected), std::begin(state)));
+    }
+
+#ifdef TEMPLATE_REGEX_SIMD_X86
+    if (simd::has_avx2())
+    {
+        int state[simd::dfa_lanes] = {};
+        simd::run_dfa_lanes_avx2(table.data(), 2 * 256, data, size, state);
+        EXPECT_TRUE(std::equal(std::begin(expected), std::end(expected), std::begin(state)));
+    }
+#endif
+}
+
+/* ************************************************************************ */
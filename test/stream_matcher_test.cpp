@@ -0,0 +1,115 @@
+/* ************************************************************************ */
+/*                                                                          */
+/* Copyright (C) 2015 Jiří Fatka <ntsfka@gmail.com>                         */
+/*                                                                          */
+/* This program is free software: you can redistribute it and/or modify     */
+/* it under the terms of the GNU Lesser General Public License as published */
+/* by the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                      */
+/*                                                                          */
+/* This program is distributed in the hope that it will be useful,          */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of           */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the             */
+/* GNU General Public License for more details.                             */
+/*                                                                          */
+/* You should have received a copy of the GNU Lesser General Public License */
+/* along with this program. If not, see <http://www.gnu.org/licenses/>.     */
+/*                                                                          */
+/* ************************************************************************ */
+
+// C++
+#include <string>
+#include <vector>
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Template Regex
+#include "../stream_matcher.hpp"
+
+/* ************************************************************************ */
+
+using namespace template_regex;
+
+/* ************************************************************************ */
+
+/**
+ * @brief Feed input by chunks of given size and collect match ends.
+ */
+template<typename Regex>
+static std::vector<std::size_t> feed(const std::string& input, std::size_t chunk)
+{
+    stream_matcher<Regex> matcher;
+    std::vector<std::size_t> res;
+
+    const auto store = [&res](std::size_t offset) { res.push_back(offset); };
+
+    for (std::size_t pos = 0; pos < input.size(); pos += chunk)
+        matcher.feed(input.data() + pos, std::min(chunk, input.size() - pos), store);
+
+    matcher.finish(store);
+
+    return res;
+}
+
+/* ************************************************************************ */
+
+TEST(stream_matcher, search)
+{
+    using regex = make_regex_t("GET /[a-z]+");
+
+    const std::string input = "xx GET /ab GET / GET /c";
+
+    for (std::size_t chunk : {1, 2, 3, 7, 64})
+    {
+        EXPECT_EQ(std::vector<std::size_t>({9, 10, 23}), feed<regex>(input, chunk)) << chunk;
+    }
+
+    // Counting
+    stream_matcher<regex> matcher;
+    EXPECT_EQ(0u, matcher.feed("GE", 2));
+    EXPECT_EQ(2u, matcher.feed("T /ab", 5));
+    EXPECT_EQ(7u, matcher.offset());
+    EXPECT_TRUE(matcher.finish());
+    EXPECT_EQ(0u, matcher.offset());
+    EXPECT_FALSE(matcher.finish());
+}
+
+/* ************************************************************************ */
+
+TEST(stream_matcher, anchors)
+{
+    // Beginning
+    {
+        using regex = make_regex_t("^[0-9]+");
+
+        EXPECT_EQ(std::vector<std::size_t>({1, 2}), feed<regex>("12a3", 1));
+        EXPECT_EQ(std::vector<std::size_t>(), feed<regex>("a12", 2));
+    }
+
+    // End
+    {
+        using regex = make_regex_t("[0-9]+$");
+
+        EXPECT_EQ(std::vector<std::size_t>({4}), feed<regex>("a1b2", 3));
+        EXPECT_EQ(std::vector<std::size_t>(), feed<regex>("12a", 1));
+    }
+
+    // Whole stream
+    {
+        using regex = make_regex_t("^a*$");
+
+        EXPECT_EQ(std::vector<std::size_t>({3}), feed<regex>("aaa", 2));
+        EXPECT_EQ(std::vector<std::size_t>({0}), feed<regex>("", 2));
+        EXPECT_EQ(std::vector<std::size_t>(), feed<regex>("aab", 2));
+    }
+
+    // Empty match
+    {
+        using regex = make_regex_t("a*");
+
+        EXPECT_EQ(std::vector<std::size_t>({0, 1, 2}), feed<regex>("ab", 1));
+    }
+}
+
+/* ************************************************************************ */